@@ -134,6 +134,20 @@ GRPCAPI grpc_event grpc_completion_queue_next(grpc_completion_queue* cq,
                                               gpr_timespec deadline,
                                               void* reserved);
 
+/** Like grpc_completion_queue_next, but once an event is available also takes
+    the events that are already queued behind it, without polling again.
+
+    Stores between 1 and \a max_events events in \a events and returns how
+    many were stored. A GRPC_QUEUE_TIMEOUT or GRPC_QUEUE_SHUTDOWN event is
+    always returned on its own. \a max_events must be positive.
+
+    The same restrictions as for grpc_completion_queue_next apply. */
+GRPCAPI int grpc_completion_queue_next_batch(grpc_completion_queue* cq,
+                                             grpc_event* events,
+                                             int max_events,
+                                             gpr_timespec deadline,
+                                             void* reserved);
+
 /** Blocks until an event with tag 'tag' is available, the completion queue is
     being shutdown or deadline is reached.
 
@@ -590,6 +604,12 @@ GRPCAPI char* grpc_channelz_get_subchannel(intptr_t subchannel_id);
    is allocated and must be freed by the application. */
 GRPCAPI char* grpc_channelz_get_socket(intptr_t socket_id);
 
+/* EXPERIMENTAL. Returns per-method call metrics (status codes, latency,
+   message sizes and retries) for client channels created with
+   GRPC_ARG_ENABLE_CALL_METRICS. The returned string is allocated and must be
+   freed by the application. */
+GRPCAPI char* grpc_channelz_get_call_metrics(void);
+
 /**
  * EXPERIMENTAL - Subject to change.
  * Fetch a vtable for grpc_channel_arg that points to
@@ -196,6 +196,14 @@ typedef struct {
 /** How much memory to use for hpack encoding. Int valued, bytes. */
 #define GRPC_ARG_HTTP2_HPACK_TABLE_SIZE_ENCODER \
   "grpc.http2.hpack_table_size.encoder"
+/** Comma-separated list of user metadata keys whose repeated values may be
+    added to the hpack dynamic table, when the hpack_adaptive_indexing
+    experiment is enabled. All other user metadata is sent as literals and
+    never indexed, so that values of secret-bearing headers can't be probed
+    through the compression ratio. Only list keys whose values are not
+    secret. String valued, empty by default. */
+#define GRPC_ARG_HTTP2_HPACK_INDEXED_METADATA_KEYS \
+  "grpc.http2.hpack_indexed_metadata_keys"
 /** How big a frame are we willing to receive via HTTP2.
     Min 16384, max 16777215. Larger values give lower CPU usage for large
     messages, but more head of line blocking for small messages. */
@@ -232,6 +240,16 @@ typedef struct {
 /** How much data are we willing to queue up per stream if
     GRPC_WRITE_BUFFER_HINT is set? This is an upper bound */
 #define GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE "grpc.http2.write_buffer_size"
+/** EXPERIMENTAL. If positive, an HTTP2 transport with other streams active
+    holds a write started for stream data (headers, messages, trailers) for up
+    to this many microseconds, so that frames from other streams can join it
+    in a single endpoint write. The delay is rounded up to the timer
+    resolution of one millisecond. Int valued, defaults to 0 (disabled). */
+#define GRPC_ARG_HTTP2_WRITE_COALESCE_US "grpc.http2.write_coalesce_us"
+/** EXPERIMENTAL. When write coalescing is enabled, a held write is flushed
+    early once this many message bytes are waiting. Int valued, defaults to
+    65536. */
+#define GRPC_ARG_HTTP2_WRITE_COALESCE_BYTES "grpc.http2.write_coalesce_bytes"
 /** Should we allow receipt of true-binary data on http2 connections?
     Defaults to on (1) */
 #define GRPC_ARG_HTTP2_ENABLE_TRUE_BINARY "grpc.http2.true_binary"
@@ -321,6 +339,12 @@ typedef struct {
  * level. Disabling channelz naturally disables channel tracing. The default
  * is for channelz to be enabled. */
 #define GRPC_ARG_ENABLE_CHANNELZ "grpc.enable_channelz"
+/** EXPERIMENTAL. If non-zero, calls on a client channel are recorded in the
+ * process-wide per-method metrics (status codes, latency, message sizes and
+ * retries) returned by grpc_channelz_get_call_metrics(). Calls that already
+ * carry an application-provided call tracer are not recorded. Defaults to
+ * off. */
+#define GRPC_ARG_ENABLE_CALL_METRICS "grpc.enable_call_metrics"
 /** If non-zero, Cronet transport will coalesce packets to fewer frames
  * when possible. */
 #define GRPC_ARG_USE_CRONET_PACKET_COALESCING \
@@ -461,6 +485,29 @@ typedef struct {
  * channel arg. Int valued, milliseconds. Defaults to 10 minutes.*/
 #define GRPC_ARG_SERVER_CONFIG_CHANGE_DRAIN_GRACE_TIME_MS \
   "grpc.experimental.server_config_change_drain_grace_time_ms"
+/** EXPERIMENTAL. Maximum number of incoming calls a server will hold per
+ * method while they wait for the application to request them. Calls arriving
+ * when the queue is full fail with RESOURCE_EXHAUSTED. Int valued. Zero or
+ * negative (the default) leaves the queue unbounded. */
+#define GRPC_ARG_SERVER_MAX_PENDING_CALLS \
+  "grpc.experimental.server_max_pending_calls"
+/** EXPERIMENTAL. If non-zero, a server fails incoming calls whose deadline has
+ * already passed by the time they would be handed to the application with
+ * DEADLINE_EXCEEDED instead of publishing them. Disabled by default. */
+#define GRPC_ARG_SERVER_FAIL_EXPIRED_CALLS \
+  "grpc.experimental.server_fail_expired_calls"
+/** EXPERIMENTAL. Target queueing delay for calls waiting to be requested by
+ * the application. If the minimum delay seen over an interval exceeds this
+ * target, calls that waited more than twice the target are failed with
+ * RESOURCE_EXHAUSTED until the queue drains (CoDel-style shedding). Int
+ * valued, milliseconds. Zero (the default) disables delay-based shedding. */
+#define GRPC_ARG_SERVER_PENDING_CALL_TARGET_DELAY_MS \
+  "grpc.experimental.server_pending_call_target_delay_ms"
+/** EXPERIMENTAL. Interval over which the minimum queueing delay is measured
+ * for GRPC_ARG_SERVER_PENDING_CALL_TARGET_DELAY_MS. Int valued, milliseconds.
+ * Defaults to 100. */
+#define GRPC_ARG_SERVER_PENDING_CALL_INTERVAL_MS \
+  "grpc.experimental.server_pending_call_interval_ms"
 /** \} */
 
 /** Result of a grpc call. If the caller satisfies the prerequisites of a
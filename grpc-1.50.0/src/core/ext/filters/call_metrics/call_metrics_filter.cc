@@ -0,0 +1,195 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <grpc/support/port_platform.h>
+
+#include <stdint.h>
+
+#include "absl/status/status.h"
+
+#include <grpc/impl/codegen/gpr_types.h>
+#include <grpc/impl/codegen/grpc_types.h>
+#include <grpc/status.h>
+#include <grpc/support/atm.h>
+#include <grpc/support/time.h>
+
+#include "src/core/lib/channel/call_metrics.h"
+#include "src/core/lib/channel/call_tracer.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/channel/channel_stack.h"
+#include "src/core/lib/channel/channel_stack_builder.h"
+#include "src/core/lib/channel/context.h"
+#include "src/core/lib/config/core_configuration.h"
+#include "src/core/lib/gpr/time_precise.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/resource_quota/arena.h"
+#include "src/core/lib/slice/slice.h"
+#include "src/core/lib/slice/slice_buffer.h"
+#include "src/core/lib/slice/slice_internal.h"
+#include "src/core/lib/surface/channel_init.h"
+#include "src/core/lib/surface/channel_stack_type.h"
+#include "src/core/lib/transport/metadata_batch.h"
+#include "src/core/lib/transport/transport.h"
+
+namespace grpc_core {
+
+namespace {
+
+// Built-in CallTracer that aggregates each call into CallMetrics when the
+// call's arena is destroyed, after every attempt has ended.
+class CallMetricsTracer : public CallTracer {
+ public:
+  class AttemptTracer : public CallAttemptTracer {
+   public:
+    explicit AttemptTracer(CallMetricsTracer* call) : call_(call) {}
+
+    void RecordSendInitialMetadata(grpc_metadata_batch*) override {}
+    void RecordOnDoneSendInitialMetadata(gpr_atm*) override {}
+    void RecordSendTrailingMetadata(grpc_metadata_batch*) override {}
+    void RecordSendMessage(const SliceBuffer& send_message) override {
+      request_bytes_ += send_message.Length();
+    }
+    void RecordReceivedInitialMetadata(grpc_metadata_batch*,
+                                       uint32_t) override {}
+    void RecordReceivedMessage(const SliceBuffer& recv_message) override {
+      response_bytes_ += recv_message.Length();
+    }
+    void RecordReceivedTrailingMetadata(
+        absl::Status status, grpc_metadata_batch*,
+        const grpc_transport_stream_stats*) override {
+      call_->RecordStatus(static_cast<grpc_status_code>(status.code()));
+    }
+    void RecordCancel(grpc_error_handle cancel_error) override {
+      GRPC_ERROR_UNREF(cancel_error);
+      if (!call_->have_status_) call_->RecordStatus(GRPC_STATUS_CANCELLED);
+    }
+    void RecordEnd(const gpr_timespec&) override {}
+
+    uint64_t request_bytes() const { return request_bytes_; }
+    uint64_t response_bytes() const { return response_bytes_; }
+
+   private:
+    CallMetricsTracer* const call_;
+    uint64_t request_bytes_ = 0;
+    uint64_t response_bytes_ = 0;
+  };
+
+  CallMetricsTracer(const grpc_slice& path, gpr_cycle_counter start_time,
+                    Arena* arena)
+      : path_(grpc_slice_ref_internal(path)),
+        start_time_(start_time),
+        arena_(arena) {}
+
+  ~CallMetricsTracer() override {
+    if (!have_status_) RecordStatus(GRPC_STATUS_CANCELLED);
+    CallMetrics::CallRecord record;
+    record.method = path_.as_string_view();
+    record.status = status_;
+    gpr_timespec latency = gpr_cycle_counter_sub(end_time_, start_time_);
+    record.latency_us = static_cast<uint64_t>(latency.tv_sec) * GPR_US_PER_SEC +
+                        latency.tv_nsec / GPR_NS_PER_US;
+    if (last_attempt_ != nullptr) {
+      record.request_bytes = last_attempt_->request_bytes();
+      record.response_bytes = last_attempt_->response_bytes();
+    }
+    record.retries = attempts_ > 0 ? attempts_ - 1 : 0;
+    record.transparent_retries = transparent_retries_;
+    CallMetrics::Get()->Record(record);
+  }
+
+  CallAttemptTracer* StartNewAttempt(bool is_transparent_retry) override {
+    if (is_transparent_retry) {
+      ++transparent_retries_;
+    } else {
+      ++attempts_;
+    }
+    last_attempt_ = arena_->New<AttemptTracer>(this);
+    return last_attempt_;
+  }
+
+ private:
+  // The status of the latest attempt to finish is the call's status.
+  void RecordStatus(grpc_status_code status) {
+    status_ = status;
+    have_status_ = true;
+    end_time_ = gpr_get_cycle_counter();
+  }
+
+  const Slice path_;
+  const gpr_cycle_counter start_time_;
+  Arena* const arena_;
+  AttemptTracer* last_attempt_ = nullptr;
+  uint32_t attempts_ = 0;
+  uint32_t transparent_retries_ = 0;
+  bool have_status_ = false;
+  grpc_status_code status_ = GRPC_STATUS_OK;
+  gpr_cycle_counter end_time_ = 0;
+};
+
+grpc_error_handle CallMetricsInitCallElem(grpc_call_element* /*elem*/,
+                                          const grpc_call_element_args* args) {
+  // An application-provided tracer (e.g. census) takes precedence.
+  if (args->context[GRPC_CONTEXT_CALL_TRACER].value == nullptr) {
+    args->context[GRPC_CONTEXT_CALL_TRACER].value =
+        args->arena->ManagedNew<CallMetricsTracer>(args->path, args->start_time,
+                                                   args->arena);
+  }
+  return GRPC_ERROR_NONE;
+}
+
+void CallMetricsDestroyCallElem(grpc_call_element* /*elem*/,
+                                const grpc_call_final_info* /*final_info*/,
+                                grpc_closure* /*then_schedule_closure*/) {}
+
+grpc_error_handle CallMetricsInitChannelElem(
+    grpc_channel_element* /*elem*/, grpc_channel_element_args* /*args*/) {
+  return GRPC_ERROR_NONE;
+}
+
+void CallMetricsDestroyChannelElem(grpc_channel_element* /*elem*/) {}
+
+const grpc_channel_filter kCallMetricsFilter = {
+    grpc_call_next_op,
+    nullptr,
+    grpc_channel_next_op,
+    0,  // sizeof(call_data)
+    CallMetricsInitCallElem,
+    grpc_call_stack_ignore_set_pollset_or_pollset_set,
+    CallMetricsDestroyCallElem,
+    0,  // sizeof(channel_data)
+    CallMetricsInitChannelElem,
+    grpc_channel_stack_no_post_init,
+    CallMetricsDestroyChannelElem,
+    grpc_channel_next_get_info,
+    "call_metrics"};
+
+}  // namespace
+
+void RegisterCallMetricsFilter(CoreConfiguration::Builder* builder) {
+  builder->channel_init()->RegisterStage(
+      GRPC_CLIENT_CHANNEL, GRPC_CHANNEL_INIT_BUILTIN_PRIORITY,
+      [](ChannelStackBuilder* builder) {
+        auto channel_args = builder->channel_args();
+        if (!channel_args.WantMinimalStack() &&
+            channel_args.GetBool(GRPC_ARG_ENABLE_CALL_METRICS)
+                .value_or(false)) {
+          builder->PrependFilter(&kCallMetricsFilter);
+        }
+        return true;
+      });
+}
+
+}  // namespace grpc_core
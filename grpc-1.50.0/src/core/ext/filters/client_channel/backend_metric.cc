@@ -68,6 +68,10 @@ const BackendMetricData* ParseBackendMetricData(
       xds_data_orca_v3_OrcaLoadReport_cpu_utilization(msg);
   backend_metric_data->mem_utilization =
       xds_data_orca_v3_OrcaLoadReport_mem_utilization(msg);
+  if (xds_data_orca_v3_OrcaLoadReport_rps(msg) > 0) {
+    backend_metric_data->qps =
+        static_cast<double>(xds_data_orca_v3_OrcaLoadReport_rps(msg));
+  }
   backend_metric_data->request_cost =
       ParseMap<xds_data_orca_v3_OrcaLoadReport_RequestCostEntry>(
           msg, xds_data_orca_v3_OrcaLoadReport_request_cost_next,
@@ -0,0 +1,987 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <grpc/support/port_platform.h>
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+#include <grpc/impl/codegen/connectivity_state.h>
+#include <grpc/support/log.h>
+
+#include "src/core/ext/filters/client_channel/lb_policy/backend_metric_data.h"
+#include "src/core/ext/filters/client_channel/lb_policy/oob_backend_metric.h"
+#include "src/core/ext/filters/client_channel/lb_policy/subchannel_list.h"
+#include "src/core/lib/address_utils/sockaddr_utils.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/config/core_configuration.h"
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/orphanable.h"
+#include "src/core/lib/gprpp/ref_counted.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/gprpp/time.h"
+#include "src/core/lib/gprpp/validation_errors.h"
+#include "src/core/lib/gprpp/work_serializer.h"
+#include "src/core/lib/iomgr/closure.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/timer.h"
+#include "src/core/lib/json/json.h"
+#include "src/core/lib/json/json_args.h"
+#include "src/core/lib/json/json_object_loader.h"
+#include "src/core/lib/load_balancing/lb_policy.h"
+#include "src/core/lib/load_balancing/lb_policy_factory.h"
+#include "src/core/lib/load_balancing/lb_policy_registry.h"
+#include "src/core/lib/load_balancing/subchannel_interface.h"
+#include "src/core/lib/resolver/server_address.h"
+#include "src/core/lib/transport/connectivity_state.h"
+
+namespace grpc_core {
+
+TraceFlag grpc_lb_wrr_trace(false, "weighted_round_robin_lb");
+
+namespace {
+
+constexpr absl::string_view kWeightedRoundRobin = "weighted_round_robin";
+
+// Config for WRR policy.
+class WeightedRoundRobinConfig : public LoadBalancingPolicy::Config {
+ public:
+  WeightedRoundRobinConfig() = default;
+
+  WeightedRoundRobinConfig(const WeightedRoundRobinConfig&) = delete;
+  WeightedRoundRobinConfig& operator=(const WeightedRoundRobinConfig&) =
+      delete;
+
+  WeightedRoundRobinConfig(WeightedRoundRobinConfig&&) = delete;
+  WeightedRoundRobinConfig& operator=(WeightedRoundRobinConfig&&) = delete;
+
+  absl::string_view name() const override { return kWeightedRoundRobin; }
+
+  bool enable_oob_load_report() const { return enable_oob_load_report_; }
+  Duration oob_reporting_period() const { return oob_reporting_period_; }
+  Duration blackout_period() const { return blackout_period_; }
+  Duration weight_update_period() const { return weight_update_period_; }
+  Duration weight_expiration_period() const {
+    return weight_expiration_period_;
+  }
+
+  static const JsonLoaderInterface* JsonLoader(const JsonArgs&) {
+    static const auto* loader =
+        JsonObjectLoader<WeightedRoundRobinConfig>()
+            .OptionalField("enableOobLoadReport",
+                           &WeightedRoundRobinConfig::enable_oob_load_report_)
+            .OptionalField("oobReportingPeriod",
+                           &WeightedRoundRobinConfig::oob_reporting_period_)
+            .OptionalField("blackoutPeriod",
+                           &WeightedRoundRobinConfig::blackout_period_)
+            .OptionalField("weightUpdatePeriod",
+                           &WeightedRoundRobinConfig::weight_update_period_)
+            .OptionalField("weightExpirationPeriod",
+                           &WeightedRoundRobinConfig::weight_expiration_period_)
+            .Finish();
+    return loader;
+  }
+
+  void JsonPostLoad(const Json&, const JsonArgs&, ValidationErrors*) {
+    // Updating the weights more often than this would rebuild the
+    // schedule faster than it can meaningfully change.
+    weight_update_period_ =
+        std::max(weight_update_period_, Duration::Milliseconds(100));
+  }
+
+ private:
+  bool enable_oob_load_report_ = false;
+  Duration oob_reporting_period_ = Duration::Seconds(10);
+  Duration blackout_period_ = Duration::Seconds(10);
+  Duration weight_update_period_ = Duration::Seconds(1);
+  Duration weight_expiration_period_ = Duration::Minutes(3);
+};
+
+// WRR LB policy.
+//
+// Each backend is weighted by qps / cpu_utilization, as reported either
+// in per-call ORCA trailers or on an out-of-band ORCA stream.  Weights
+// are recomputed periodically in the control plane, which builds an
+// earliest-deadline-first (EDF) schedule and hands it to a new picker.
+// Picks only read the immutable schedule through an atomic sequence
+// number, so the data plane never takes a lock.
+class WeightedRoundRobin : public LoadBalancingPolicy {
+ public:
+  explicit WeightedRoundRobin(Args args);
+
+  absl::string_view name() const override { return kWeightedRoundRobin; }
+
+  absl::Status UpdateLocked(UpdateArgs args) override;
+  void ResetBackoffLocked() override;
+
+ private:
+  // Represents the weight for a given address.
+  //
+  // Instances are shared between subchannel lists and pickers, keyed by
+  // address in the policy's address_weight_map_, so that a re-resolution
+  // that returns the same addresses does not reset their weights.
+  class AddressWeight : public RefCounted<AddressWeight> {
+   public:
+    AddressWeight(RefCountedPtr<WeightedRoundRobin> wrr, std::string key)
+        : wrr_(std::move(wrr)), key_(std::move(key)) {}
+    ~AddressWeight() override;
+
+    void MaybeUpdateWeight(double qps, double cpu_utilization);
+
+    // Returns the current weight, or 0 if the weight is still within
+    // the blackout period or has expired.
+    double GetWeight(Timestamp now, Duration weight_expiration_period,
+                     Duration blackout_period);
+
+    void ResetNonEmptySince();
+
+   private:
+    RefCountedPtr<WeightedRoundRobin> wrr_;
+    const std::string key_;
+
+    Mutex mu_;
+    double weight_ ABSL_GUARDED_BY(&mu_) = 0;
+    Timestamp non_empty_since_ ABSL_GUARDED_BY(&mu_) = Timestamp::InfFuture();
+    Timestamp last_update_time_ ABSL_GUARDED_BY(&mu_) = Timestamp::InfPast();
+  };
+
+  // Forward declaration.
+  class WeightedRoundRobinSubchannelList;
+
+  // Data for a particular subchannel in a subchannel list.
+  // This subclass adds the following functionality:
+  // - Tracks the previous connectivity state of the subchannel, so that
+  //   we know how many subchannels are in each state.
+  // - Holds a ref to the weight of the subchannel's address.
+  class WeightedRoundRobinSubchannelData
+      : public SubchannelData<WeightedRoundRobinSubchannelList,
+                              WeightedRoundRobinSubchannelData> {
+   public:
+    WeightedRoundRobinSubchannelData(
+        SubchannelList<WeightedRoundRobinSubchannelList,
+                       WeightedRoundRobinSubchannelData>* subchannel_list,
+        const ServerAddress& address, RefCountedPtr<SubchannelInterface> sc);
+
+    absl::optional<grpc_connectivity_state> connectivity_state() const {
+      return logical_connectivity_state_;
+    }
+
+    RefCountedPtr<AddressWeight> weight() const { return weight_; }
+
+   private:
+    class OobWatcher : public OobBackendMetricWatcher {
+     public:
+      explicit OobWatcher(RefCountedPtr<AddressWeight> weight)
+          : weight_(std::move(weight)) {}
+
+      void OnBackendMetricReport(
+          const BackendMetricData& backend_metric_data) override {
+        weight_->MaybeUpdateWeight(backend_metric_data.qps,
+                                   backend_metric_data.cpu_utilization);
+      }
+
+     private:
+      RefCountedPtr<AddressWeight> weight_;
+    };
+
+    // Performs connectivity state updates that need to be done only
+    // after we have started watching.
+    void ProcessConnectivityChangeLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state) override;
+
+    // Updates the logical connectivity state.
+    void UpdateLogicalConnectivityStateLocked(
+        grpc_connectivity_state connectivity_state);
+
+    // The logical connectivity state of the subchannel.
+    // Note that the logical connectivity state may differ from the
+    // actual reported state in some cases (e.g., after we see
+    // TRANSIENT_FAILURE, we ignore any subsequent state changes until
+    // we see READY).
+    absl::optional<grpc_connectivity_state> logical_connectivity_state_;
+
+    RefCountedPtr<AddressWeight> weight_;
+  };
+
+  // A list of subchannels.
+  class WeightedRoundRobinSubchannelList
+      : public SubchannelList<WeightedRoundRobinSubchannelList,
+                              WeightedRoundRobinSubchannelData> {
+   public:
+    WeightedRoundRobinSubchannelList(WeightedRoundRobin* policy,
+                                     ServerAddressList addresses,
+                                     const ChannelArgs& args)
+        : SubchannelList(policy,
+                         (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)
+                              ? "WeightedRoundRobinSubchannelList"
+                              : nullptr),
+                         std::move(addresses), policy->channel_control_helper(),
+                         args) {
+      // Need to maintain a ref to the LB policy as long as we maintain
+      // any references to subchannels, since the subchannels'
+      // pollset_sets will include the LB policy's pollset_set.
+      policy->Ref(DEBUG_LOCATION, "subchannel_list").release();
+    }
+
+    ~WeightedRoundRobinSubchannelList() override {
+      WeightedRoundRobin* p = static_cast<WeightedRoundRobin*>(policy());
+      p->Unref(DEBUG_LOCATION, "subchannel_list");
+    }
+
+    // Updates the counters of subchannels in each state when a
+    // subchannel transitions from old_state to new_state.
+    void UpdateStateCountersLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state);
+
+    // Ensures that the right subchannel list is used and then updates
+    // the WRR policy's connectivity state based on the subchannel list's
+    // state counters.
+    void MaybeUpdateConnectivityStateLocked(absl::Status status_for_tf);
+
+    size_t num_ready() const { return num_ready_; }
+
+   private:
+    std::string CountersString() const {
+      return absl::StrCat("num_subchannels=", num_subchannels(),
+                          " num_ready=", num_ready_,
+                          " num_connecting=", num_connecting_,
+                          " num_transient_failure=", num_transient_failure_);
+    }
+
+    size_t num_ready_ = 0;
+    size_t num_connecting_ = 0;
+    size_t num_transient_failure_ = 0;
+
+    absl::Status last_failure_;
+  };
+
+  // A precomputed earliest-deadline-first schedule over a set of
+  // weighted subchannels.
+  //
+  // Weights are quantized to small integers and each subchannel i is
+  // given a virtual deadline that advances by 1/weight_i every time it is
+  // selected.  Running that EDF loop for one full period (the sum of the
+  // quantized weights) produces a sequence in which every subchannel
+  // appears in proportion to its weight and picks are spread evenly, not
+  // clumped.  Building costs O(L log n) for a schedule of length L; a
+  // pick is an O(1) array lookup.
+  class EdfSchedule {
+   public:
+    // Returns null if fewer than two subchannels have a usable weight,
+    // in which case the caller should fall back to plain round robin.
+    static std::unique_ptr<EdfSchedule> Make(
+        const std::vector<double>& weights, absl::BitGen* bit_gen);
+
+    size_t Pick(uint64_t sequence) const {
+      return schedule_[sequence % schedule_.size()];
+    }
+
+   private:
+    explicit EdfSchedule(std::vector<uint32_t> schedule)
+        : schedule_(std::move(schedule)) {}
+
+    const std::vector<uint32_t> schedule_;
+  };
+
+  class Picker : public SubchannelPicker {
+   public:
+    Picker(WeightedRoundRobin* wrr,
+           WeightedRoundRobinSubchannelList* subchannel_list);
+
+    PickResult Pick(PickArgs args) override;
+
+   private:
+    // A call tracker that collects per-call endpoint utilization reports.
+    class SubchannelCallTracker : public SubchannelCallTrackerInterface {
+     public:
+      explicit SubchannelCallTracker(RefCountedPtr<AddressWeight> weight)
+          : weight_(std::move(weight)) {}
+
+      void Start() override {}
+
+      void Finish(FinishArgs args) override;
+
+     private:
+      RefCountedPtr<AddressWeight> weight_;
+    };
+
+    // Info stored about each subchannel.
+    struct SubchannelInfo {
+      SubchannelInfo(RefCountedPtr<SubchannelInterface> subchannel,
+                     RefCountedPtr<AddressWeight> weight)
+          : subchannel(std::move(subchannel)), weight(std::move(weight)) {}
+
+      RefCountedPtr<SubchannelInterface> subchannel;
+      RefCountedPtr<AddressWeight> weight;
+    };
+
+    // Using pointer value only, no ref held -- do not dereference!
+    WeightedRoundRobin* wrr_;
+    const bool enable_oob_load_report_;
+    std::vector<SubchannelInfo> subchannels_;
+    std::unique_ptr<EdfSchedule> schedule_;
+    std::atomic<uint64_t> sequence_;
+  };
+
+  ~WeightedRoundRobin() override;
+
+  void ShutdownLocked() override;
+
+  RefCountedPtr<AddressWeight> GetOrCreateWeight(
+      const grpc_resolved_address& address);
+
+  // Reports READY with a fresh picker built from the current weights.
+  void UpdatePickerLocked();
+
+  void StartWeightUpdateTimerLocked();
+  static void OnWeightUpdateTimer(void* arg, grpc_error_handle error);
+  void OnWeightUpdateTimerLocked(grpc_error_handle error);
+
+  // Current config from the resolver.
+  RefCountedPtr<WeightedRoundRobinConfig> config_;
+
+  // List of subchannels.
+  RefCountedPtr<WeightedRoundRobinSubchannelList> subchannel_list_;
+  // Latest pending subchannel list.
+  // When we get an updated address list, we create a new subchannel list
+  // for it here, and we wait to swap it into subchannel_list_ until the new
+  // list becomes READY.
+  RefCountedPtr<WeightedRoundRobinSubchannelList>
+      latest_pending_subchannel_list_;
+
+  Mutex address_weight_map_mu_;
+  std::map<std::string, AddressWeight*> address_weight_map_
+      ABSL_GUARDED_BY(&address_weight_map_mu_);
+
+  // Periodically rebuilds the picker so that it reflects new weights.
+  grpc_timer weight_update_timer_;
+  grpc_closure on_weight_update_timer_;
+  bool weight_update_timer_pending_ = false;
+
+  absl::BitGen bit_gen_;
+
+  bool shutdown_ = false;
+};
+
+//
+// WeightedRoundRobin::AddressWeight
+//
+
+WeightedRoundRobin::AddressWeight::~AddressWeight() {
+  MutexLock lock(&wrr_->address_weight_map_mu_);
+  auto it = wrr_->address_weight_map_.find(key_);
+  if (it != wrr_->address_weight_map_.end() && it->second == this) {
+    wrr_->address_weight_map_.erase(it);
+  }
+}
+
+void WeightedRoundRobin::AddressWeight::MaybeUpdateWeight(
+    double qps, double cpu_utilization) {
+  // Ignore reports that cannot yield a meaningful weight.
+  if (qps <= 0 || cpu_utilization <= 0) return;
+  const double weight = qps / cpu_utilization;
+  MutexLock lock(&mu_);
+  Timestamp now = Timestamp::Now();
+  if (non_empty_since_ == Timestamp::InfFuture()) non_empty_since_ = now;
+  last_update_time_ = now;
+  weight_ = weight;
+}
+
+double WeightedRoundRobin::AddressWeight::GetWeight(
+    Timestamp now, Duration weight_expiration_period,
+    Duration blackout_period) {
+  MutexLock lock(&mu_);
+  // If the most recent update was longer ago than the expiration
+  // period, reset non_empty_since_ so that we apply the blackout period
+  // again if we start getting data again in the future, and return 0.
+  if (now - last_update_time_ >= weight_expiration_period) {
+    non_empty_since_ = Timestamp::InfFuture();
+    return 0;
+  }
+  // If we don't have at least blackout_period worth of data, return 0.
+  if (blackout_period > Duration::Zero() &&
+      now - non_empty_since_ < blackout_period) {
+    return 0;
+  }
+  return weight_;
+}
+
+void WeightedRoundRobin::AddressWeight::ResetNonEmptySince() {
+  MutexLock lock(&mu_);
+  non_empty_since_ = Timestamp::InfFuture();
+}
+
+//
+// WeightedRoundRobin::EdfSchedule
+//
+
+std::unique_ptr<WeightedRoundRobin::EdfSchedule>
+WeightedRoundRobin::EdfSchedule::Make(const std::vector<double>& weights,
+                                      absl::BitGen* bit_gen) {
+  // Largest quantized weight.  Ratios finer than 1:kMaxQuantizedWeight
+  // are not preserved.
+  constexpr uint32_t kMaxQuantizedWeight = 100;
+  // Upper bound on the schedule length, so that very large subchannel
+  // lists trade weight precision for a bounded memory footprint.
+  constexpr size_t kMaxScheduleLength = 1 << 16;
+  size_t num_nonzero = 0;
+  double sum = 0;
+  double max = 0;
+  for (double weight : weights) {
+    if (weight > 0) {
+      ++num_nonzero;
+      sum += weight;
+      max = std::max(max, weight);
+    }
+  }
+  if (num_nonzero < 2) return nullptr;
+  // Subchannels without a usable weight yet get the mean weight, so that
+  // new or blacked-out backends still receive a fair share of traffic.
+  const double mean = sum / num_nonzero;
+  const uint32_t scale = static_cast<uint32_t>(std::max<size_t>(
+      1, std::min<size_t>(kMaxQuantizedWeight,
+                          kMaxScheduleLength / weights.size())));
+  std::vector<uint32_t> quantized(weights.size());
+  size_t total = 0;
+  for (size_t i = 0; i < weights.size(); ++i) {
+    const double weight = weights[i] > 0 ? weights[i] : mean;
+    quantized[i] = std::max<uint32_t>(
+        1, static_cast<uint32_t>(std::lround(weight / max * scale)));
+    total += quantized[i];
+  }
+  // Run EDF over one full period.  Each entry starts at a random offset
+  // within its first interval so that clients sharing the same backends
+  // do not all pick them in lockstep.
+  struct Entry {
+    double deadline;
+    uint32_t index;
+    bool operator>(const Entry& other) const {
+      if (deadline != other.deadline) return deadline > other.deadline;
+      return index > other.index;
+    }
+  };
+  std::vector<Entry> initial;
+  initial.reserve(weights.size());
+  for (uint32_t i = 0; i < weights.size(); ++i) {
+    initial.push_back(
+        {absl::Uniform(*bit_gen, 0.0, 1.0) / quantized[i], i});
+  }
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue(
+      std::greater<Entry>(), std::move(initial));
+  std::vector<uint32_t> schedule;
+  schedule.reserve(total);
+  while (schedule.size() < total) {
+    Entry entry = queue.top();
+    queue.pop();
+    schedule.push_back(entry.index);
+    entry.deadline += 1.0 / quantized[entry.index];
+    queue.push(entry);
+  }
+  return absl::WrapUnique(new EdfSchedule(std::move(schedule)));
+}
+
+//
+// WeightedRoundRobin::Picker::SubchannelCallTracker
+//
+
+void WeightedRoundRobin::Picker::SubchannelCallTracker::Finish(
+    FinishArgs args) {
+  auto* backend_metric_data =
+      args.backend_metric_accessor->GetBackendMetricData();
+  if (backend_metric_data != nullptr) {
+    weight_->MaybeUpdateWeight(backend_metric_data->qps,
+                               backend_metric_data->cpu_utilization);
+  }
+}
+
+//
+// WeightedRoundRobin::Picker
+//
+
+WeightedRoundRobin::Picker::Picker(
+    WeightedRoundRobin* wrr, WeightedRoundRobinSubchannelList* subchannel_list)
+    : wrr_(wrr),
+      enable_oob_load_report_(wrr->config_->enable_oob_load_report()) {
+  for (size_t i = 0; i < subchannel_list->num_subchannels(); ++i) {
+    WeightedRoundRobinSubchannelData* sd = subchannel_list->subchannel(i);
+    if (sd->connectivity_state().value_or(GRPC_CHANNEL_IDLE) ==
+        GRPC_CHANNEL_READY) {
+      subchannels_.emplace_back(sd->subchannel()->Ref(), sd->weight());
+    }
+  }
+  const Timestamp now = ExecCtx::Get()->Now();
+  std::vector<double> weights;
+  weights.reserve(subchannels_.size());
+  for (const SubchannelInfo& info : subchannels_) {
+    weights.push_back(
+        info.weight->GetWeight(now, wrr->config_->weight_expiration_period(),
+                               wrr->config_->blackout_period()));
+  }
+  schedule_ = EdfSchedule::Make(weights, &wrr->bit_gen_);
+  // Start at a random position for the same reason as round_robin; see
+  // https://github.com/grpc/grpc-go/issues/2580.
+  sequence_.store(absl::Uniform<uint64_t>(wrr->bit_gen_),
+                  std::memory_order_relaxed);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(GPR_INFO,
+            "[WRR %p picker %p] created picker from subchannel_list=%p "
+            "with %" PRIuPTR " READY subchannels; %s",
+            wrr_, this, subchannel_list, subchannels_.size(),
+            schedule_ == nullptr ? "not enough weights, using round robin"
+                                 : "using EDF schedule");
+  }
+}
+
+WeightedRoundRobin::PickResult WeightedRoundRobin::Picker::Pick(
+    PickArgs /*args*/) {
+  const uint64_t sequence =
+      sequence_.fetch_add(1, std::memory_order_relaxed);
+  const size_t index = schedule_ == nullptr
+                           ? sequence % subchannels_.size()
+                           : schedule_->Pick(sequence);
+  GPR_ASSERT(index < subchannels_.size());
+  const SubchannelInfo& info = subchannels_[index];
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(GPR_INFO,
+            "[WRR %p picker %p] returning index %" PRIuPTR ", subchannel=%p",
+            wrr_, this, index, info.subchannel.get());
+  }
+  // Collect per-call utilization data if needed.
+  std::unique_ptr<SubchannelCallTrackerInterface> subchannel_call_tracker;
+  if (!enable_oob_load_report_) {
+    subchannel_call_tracker =
+        absl::make_unique<SubchannelCallTracker>(info.weight);
+  }
+  return PickResult::Complete(info.subchannel,
+                              std::move(subchannel_call_tracker));
+}
+
+//
+// WeightedRoundRobin
+//
+
+WeightedRoundRobin::WeightedRoundRobin(Args args)
+    : LoadBalancingPolicy(std::move(args)) {
+  GRPC_CLOSURE_INIT(&on_weight_update_timer_, OnWeightUpdateTimer, this,
+                    nullptr);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] Created", this);
+  }
+}
+
+WeightedRoundRobin::~WeightedRoundRobin() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] Destroying Weighted Round Robin policy", this);
+  }
+  GPR_ASSERT(subchannel_list_ == nullptr);
+  GPR_ASSERT(latest_pending_subchannel_list_ == nullptr);
+}
+
+void WeightedRoundRobin::ShutdownLocked() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] Shutting down", this);
+  }
+  shutdown_ = true;
+  if (weight_update_timer_pending_) grpc_timer_cancel(&weight_update_timer_);
+  subchannel_list_.reset();
+  latest_pending_subchannel_list_.reset();
+}
+
+void WeightedRoundRobin::ResetBackoffLocked() {
+  subchannel_list_->ResetBackoffLocked();
+  if (latest_pending_subchannel_list_ != nullptr) {
+    latest_pending_subchannel_list_->ResetBackoffLocked();
+  }
+}
+
+RefCountedPtr<WeightedRoundRobin::AddressWeight>
+WeightedRoundRobin::GetOrCreateWeight(const grpc_resolved_address& address) {
+  auto key = grpc_sockaddr_to_uri(&address);
+  if (!key.ok()) return nullptr;
+  MutexLock lock(&address_weight_map_mu_);
+  auto it = address_weight_map_.find(*key);
+  if (it != address_weight_map_.end()) {
+    auto weight = it->second->RefIfNonZero();
+    if (weight != nullptr) return weight;
+  }
+  auto weight = MakeRefCounted<AddressWeight>(
+      Ref(DEBUG_LOCATION, "AddressWeight"), *key);
+  address_weight_map_[*key] = weight.get();
+  return weight;
+}
+
+absl::Status WeightedRoundRobin::UpdateLocked(UpdateArgs args) {
+  config_ = std::move(args.config);
+  ServerAddressList addresses;
+  if (args.addresses.ok()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] received update with %" PRIuPTR " addresses",
+              this, args.addresses->size());
+    }
+    addresses = std::move(*args.addresses);
+  } else {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] received update with address error: %s",
+              this, args.addresses.status().ToString().c_str());
+    }
+    // If we already have a subchannel list, then keep using the existing
+    // list, but still report back that the update was not accepted.
+    if (subchannel_list_ != nullptr) return args.addresses.status();
+  }
+  // Create new subchannel list, replacing the previous pending list, if any.
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace) &&
+      latest_pending_subchannel_list_ != nullptr) {
+    gpr_log(GPR_INFO, "[WRR %p] replacing previous pending subchannel list %p",
+            this, latest_pending_subchannel_list_.get());
+  }
+  latest_pending_subchannel_list_ =
+      MakeRefCounted<WeightedRoundRobinSubchannelList>(
+          this, std::move(addresses), args.args);
+  latest_pending_subchannel_list_->StartWatchingLocked();
+  // If the new list is empty, immediately promote it to
+  // subchannel_list_ and report TRANSIENT_FAILURE.
+  if (latest_pending_subchannel_list_->num_subchannels() == 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace) &&
+        subchannel_list_ != nullptr) {
+      gpr_log(GPR_INFO, "[WRR %p] replacing previous subchannel list %p", this,
+              subchannel_list_.get());
+    }
+    subchannel_list_ = std::move(latest_pending_subchannel_list_);
+    absl::Status status =
+        args.addresses.ok() ? absl::UnavailableError(absl::StrCat(
+                                  "empty address list: ", args.resolution_note))
+                            : args.addresses.status();
+    channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_TRANSIENT_FAILURE, status,
+        absl::make_unique<TransientFailurePicker>(status));
+    return status;
+  }
+  // Otherwise, if this is the initial update, immediately promote it to
+  // subchannel_list_ and report CONNECTING.
+  if (subchannel_list_.get() == nullptr) {
+    subchannel_list_ = std::move(latest_pending_subchannel_list_);
+    channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_CONNECTING, absl::Status(),
+        absl::make_unique<QueuePicker>(Ref(DEBUG_LOCATION, "QueuePicker")));
+  }
+  return absl::OkStatus();
+}
+
+void WeightedRoundRobin::UpdatePickerLocked() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] reporting READY with subchannel list %p",
+            this, subchannel_list_.get());
+  }
+  channel_control_helper()->UpdateState(
+      GRPC_CHANNEL_READY, absl::Status(),
+      absl::make_unique<Picker>(this, subchannel_list_.get()));
+  StartWeightUpdateTimerLocked();
+}
+
+void WeightedRoundRobin::StartWeightUpdateTimerLocked() {
+  if (weight_update_timer_pending_) return;
+  weight_update_timer_pending_ = true;
+  Ref(DEBUG_LOCATION, "WeightUpdateTimer").release();
+  grpc_timer_init(&weight_update_timer_,
+                  ExecCtx::Get()->Now() + config_->weight_update_period(),
+                  &on_weight_update_timer_);
+}
+
+void WeightedRoundRobin::OnWeightUpdateTimer(void* arg,
+                                             grpc_error_handle error) {
+  auto* self = static_cast<WeightedRoundRobin*>(arg);
+  (void)GRPC_ERROR_REF(error);  // ref owned by lambda
+  self->work_serializer()->Run(
+      [self, error]() { self->OnWeightUpdateTimerLocked(error); },
+      DEBUG_LOCATION);
+}
+
+void WeightedRoundRobin::OnWeightUpdateTimerLocked(grpc_error_handle error) {
+  weight_update_timer_pending_ = false;
+  // Only swap in a new picker while we are reporting READY; otherwise
+  // the timer is restarted the next time the list becomes READY.
+  if (GRPC_ERROR_IS_NONE(error) && !shutdown_ && subchannel_list_ != nullptr &&
+      subchannel_list_->num_ready() > 0) {
+    UpdatePickerLocked();
+  }
+  Unref(DEBUG_LOCATION, "WeightUpdateTimer");
+  GRPC_ERROR_UNREF(error);
+}
+
+//
+// WeightedRoundRobinSubchannelList
+//
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelList::
+    UpdateStateCountersLocked(absl::optional<grpc_connectivity_state> old_state,
+                              grpc_connectivity_state new_state) {
+  if (old_state.has_value()) {
+    GPR_ASSERT(*old_state != GRPC_CHANNEL_SHUTDOWN);
+    if (*old_state == GRPC_CHANNEL_READY) {
+      GPR_ASSERT(num_ready_ > 0);
+      --num_ready_;
+    } else if (*old_state == GRPC_CHANNEL_CONNECTING) {
+      GPR_ASSERT(num_connecting_ > 0);
+      --num_connecting_;
+    } else if (*old_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+      GPR_ASSERT(num_transient_failure_ > 0);
+      --num_transient_failure_;
+    }
+  }
+  GPR_ASSERT(new_state != GRPC_CHANNEL_SHUTDOWN);
+  if (new_state == GRPC_CHANNEL_READY) {
+    ++num_ready_;
+  } else if (new_state == GRPC_CHANNEL_CONNECTING) {
+    ++num_connecting_;
+  } else if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    ++num_transient_failure_;
+  }
+}
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelList::
+    MaybeUpdateConnectivityStateLocked(absl::Status status_for_tf) {
+  WeightedRoundRobin* p = static_cast<WeightedRoundRobin*>(policy());
+  // If this is latest_pending_subchannel_list_, then swap it into
+  // subchannel_list_ in the following cases:
+  // - subchannel_list_ has no READY subchannels.
+  // - This list has at least one READY subchannel.
+  // - All of the subchannels in this list are in TRANSIENT_FAILURE.
+  //   (This may cause the channel to go from READY to TRANSIENT_FAILURE,
+  //   but we're doing what the control plane told us to do.)
+  if (p->latest_pending_subchannel_list_.get() == this &&
+      (p->subchannel_list_->num_ready_ == 0 || num_ready_ > 0 ||
+       num_transient_failure_ == num_subchannels())) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      const std::string old_counters_string =
+          p->subchannel_list_ != nullptr ? p->subchannel_list_->CountersString()
+                                         : "";
+      gpr_log(
+          GPR_INFO,
+          "[WRR %p] swapping out subchannel list %p (%s) in favor of %p (%s)",
+          p, p->subchannel_list_.get(), old_counters_string.c_str(), this,
+          CountersString().c_str());
+    }
+    p->subchannel_list_ = std::move(p->latest_pending_subchannel_list_);
+  }
+  // Only set connectivity state if this is the current subchannel list.
+  if (p->subchannel_list_.get() != this) return;
+  // First matching rule wins:
+  // 1) ANY subchannel is READY => policy is READY.
+  // 2) ANY subchannel is CONNECTING => policy is CONNECTING.
+  // 3) ALL subchannels are TRANSIENT_FAILURE => policy is TRANSIENT_FAILURE.
+  if (num_ready_ > 0) {
+    p->UpdatePickerLocked();
+  } else if (num_connecting_ > 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] reporting CONNECTING with subchannel list %p",
+              p, this);
+    }
+    p->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_CONNECTING, absl::Status(),
+        absl::make_unique<QueuePicker>(p->Ref(DEBUG_LOCATION, "QueuePicker")));
+  } else if (num_transient_failure_ == num_subchannels()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] reporting TRANSIENT_FAILURE with subchannel list %p: %s",
+              p, this, status_for_tf.ToString().c_str());
+    }
+    if (!status_for_tf.ok()) {
+      last_failure_ = absl::UnavailableError(
+          absl::StrCat("connections to all backends failing; last error: ",
+                       status_for_tf.ToString()));
+    }
+    p->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_TRANSIENT_FAILURE, last_failure_,
+        absl::make_unique<TransientFailurePicker>(last_failure_));
+  }
+}
+
+//
+// WeightedRoundRobinSubchannelData
+//
+
+WeightedRoundRobin::WeightedRoundRobinSubchannelData::
+    WeightedRoundRobinSubchannelData(
+        SubchannelList<WeightedRoundRobinSubchannelList,
+                       WeightedRoundRobinSubchannelData>* subchannel_list,
+        const ServerAddress& address, RefCountedPtr<SubchannelInterface> sc)
+    : SubchannelData(subchannel_list, address, std::move(sc)) {
+  WeightedRoundRobin* p =
+      static_cast<WeightedRoundRobin*>(subchannel_list->policy());
+  weight_ = p->GetOrCreateWeight(address.address());
+  if (weight_ == nullptr) {
+    // Should never happen for a resolved address, but fall back to an
+    // unshared weight rather than crashing.
+    weight_ = MakeRefCounted<AddressWeight>(
+        p->Ref(DEBUG_LOCATION, "AddressWeight"), "");
+  }
+  // Start OOB watch if configured.
+  if (p->config_->enable_oob_load_report()) {
+    subchannel()->AddDataWatcher(MakeOobBackendMetricWatcher(
+        p->config_->oob_reporting_period(),
+        absl::make_unique<OobWatcher>(weight_)));
+  }
+}
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelData::
+    ProcessConnectivityChangeLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state) {
+  WeightedRoundRobin* p =
+      static_cast<WeightedRoundRobin*>(subchannel_list()->policy());
+  GPR_ASSERT(subchannel() != nullptr);
+  // If this is not the initial state notification and the new state is
+  // TRANSIENT_FAILURE or IDLE, re-resolve.
+  // Note that we don't want to do this on the initial state notification,
+  // because that would result in an endless loop of re-resolution.
+  if (old_state.has_value() && (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
+                                new_state == GRPC_CHANNEL_IDLE)) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] Subchannel %p reported %s; requesting re-resolution", p,
+              subchannel(), ConnectivityStateName(new_state));
+    }
+    p->channel_control_helper()->RequestReresolution();
+  }
+  if (new_state == GRPC_CHANNEL_IDLE) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] Subchannel %p reported IDLE; requesting connection", p,
+              subchannel());
+    }
+    subchannel()->RequestConnection();
+  } else if (new_state == GRPC_CHANNEL_READY) {
+    // If we transition back to READY state, restart the blackout period.
+    // Note that we cannot guarantee that we will never receive
+    // lingering callbacks for backend metric reports from the previous
+    // connection after the new connection has been established, but they
+    // should be masked by new backend metric reports from the new
+    // connection by the time the blackout period ends.
+    weight_->ResetNonEmptySince();
+  }
+  // Update logical connectivity state.
+  UpdateLogicalConnectivityStateLocked(new_state);
+  // Update the policy state.
+  subchannel_list()->MaybeUpdateConnectivityStateLocked(connectivity_status());
+}
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelData::
+    UpdateLogicalConnectivityStateLocked(
+        grpc_connectivity_state connectivity_state) {
+  WeightedRoundRobin* p =
+      static_cast<WeightedRoundRobin*>(subchannel_list()->policy());
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+    gpr_log(
+        GPR_INFO,
+        "[WRR %p] connectivity changed for subchannel %p, subchannel_list %p "
+        "(index %" PRIuPTR " of %" PRIuPTR "): prev_state=%s new_state=%s",
+        p, subchannel(), subchannel_list(), Index(),
+        subchannel_list()->num_subchannels(),
+        (logical_connectivity_state_.has_value()
+             ? ConnectivityStateName(*logical_connectivity_state_)
+             : "N/A"),
+        ConnectivityStateName(connectivity_state));
+  }
+  // Decide what state to report for aggregation purposes.
+  // If the last logical state was TRANSIENT_FAILURE, then ignore the
+  // state change unless the new state is READY.
+  if (logical_connectivity_state_.has_value() &&
+      *logical_connectivity_state_ == GRPC_CHANNEL_TRANSIENT_FAILURE &&
+      connectivity_state != GRPC_CHANNEL_READY) {
+    return;
+  }
+  // If the new state is IDLE, treat it as CONNECTING, since it will
+  // immediately transition into CONNECTING anyway.
+  if (connectivity_state == GRPC_CHANNEL_IDLE) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_wrr_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] subchannel %p, subchannel_list %p (index %" PRIuPTR
+              " of %" PRIuPTR "): treating IDLE as CONNECTING",
+              p, subchannel(), subchannel_list(), Index(),
+              subchannel_list()->num_subchannels());
+    }
+    connectivity_state = GRPC_CHANNEL_CONNECTING;
+  }
+  // If no change, return false.
+  if (logical_connectivity_state_.has_value() &&
+      *logical_connectivity_state_ == connectivity_state) {
+    return;
+  }
+  // Otherwise, update counters and logical state.
+  subchannel_list()->UpdateStateCountersLocked(logical_connectivity_state_,
+                                               connectivity_state);
+  logical_connectivity_state_ = connectivity_state;
+}
+
+//
+// factory
+//
+
+class WeightedRoundRobinFactory : public LoadBalancingPolicyFactory {
+ public:
+  OrphanablePtr<LoadBalancingPolicy> CreateLoadBalancingPolicy(
+      LoadBalancingPolicy::Args args) const override {
+    return MakeOrphanable<WeightedRoundRobin>(std::move(args));
+  }
+
+  absl::string_view name() const override { return kWeightedRoundRobin; }
+
+  absl::StatusOr<RefCountedPtr<LoadBalancingPolicy::Config>>
+  ParseLoadBalancingConfig(const Json& json) const override {
+    if (json.type() == Json::Type::JSON_NULL) {
+      // This policy was configured in the deprecated loadBalancingPolicy
+      // field or in the client API; use the defaults.
+      return MakeRefCounted<WeightedRoundRobinConfig>();
+    }
+    return LoadRefCountedFromJson<WeightedRoundRobinConfig>(
+        json, JsonArgs(),
+        "errors validating weighted_round_robin LB policy config");
+  }
+};
+
+}  // namespace
+
+void RegisterWeightedRoundRobinLbPolicy(CoreConfiguration::Builder* builder) {
+  builder->lb_policy_registry()->RegisterLoadBalancingPolicyFactory(
+      absl::make_unique<WeightedRoundRobinFactory>());
+}
+
+}  // namespace grpc_core
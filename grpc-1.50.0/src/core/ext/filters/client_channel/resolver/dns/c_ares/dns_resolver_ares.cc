@@ -72,6 +72,7 @@
 #include "src/core/ext/filters/client_channel/lb_policy/grpclb/grpclb_balancer_addresses.h"
 #include "src/core/ext/filters/client_channel/resolver/dns/c_ares/grpc_ares_wrapper.h"
 #include "src/core/ext/filters/client_channel/resolver/dns/dns_resolver_selection.h"
+#include "src/core/ext/filters/client_channel/resolver/dns/dns_result_cache.h"
 #include "src/core/ext/filters/client_channel/resolver/polling_resolver.h"
 #include "src/core/lib/backoff/backoff.h"
 #include "src/core/lib/channel/channel_args.h"
@@ -110,16 +111,35 @@ class AresClientChannelDNSResolver : public PollingResolver {
       // TODO(hork): replace this callback bookkeeping with promises.
       // Locking to prevent completion before all records are queried
       MutexLock lock(&on_resolved_mu_);
-      Ref(DEBUG_LOCATION, "OnHostnameResolved").release();
-      GRPC_CLOSURE_INIT(&on_hostname_resolved_, OnHostnameResolved, this,
-                        nullptr);
-      hostname_request_.reset(grpc_dns_lookup_hostname_ares(
-          resolver_->authority().c_str(), resolver_->name_to_resolve().c_str(),
-          kDefaultSecurePort, resolver_->interested_parties(),
-          &on_hostname_resolved_, &addresses_, resolver_->query_timeout_ms_));
-      GRPC_CARES_TRACE_LOG(
-          "resolver:%p Started resolving hostnames. hostname_request_:%p",
-          resolver_.get(), hostname_request_.get());
+      if (DnsResultCache::Enabled()) {
+        // Hostnames go through the process-wide cache, which resolves them
+        // with the same c-ares query via GetDNSResolver(). SRV and TXT
+        // records below are not cached.
+        Ref(DEBUG_LOCATION, "OnCachedHostnameResolved").release();
+        cached_hostname_request_ = DnsResultCache::Get()->LookupHostname(
+            [this](absl::StatusOr<std::vector<grpc_resolved_address>>
+                       addresses) {
+              OnCachedHostnameResolved(std::move(addresses));
+            },
+            resolver_->name_to_resolve(), kDefaultSecurePort,
+            Duration::Milliseconds(resolver_->query_timeout_ms_),
+            resolver_->interested_parties(), resolver_->authority());
+        GRPC_CARES_TRACE_LOG(
+            "resolver:%p Started resolving hostnames via cache. request:%p",
+            resolver_.get(), cached_hostname_request_.get());
+      } else {
+        Ref(DEBUG_LOCATION, "OnHostnameResolved").release();
+        GRPC_CLOSURE_INIT(&on_hostname_resolved_, OnHostnameResolved, this,
+                          nullptr);
+        hostname_request_.reset(grpc_dns_lookup_hostname_ares(
+            resolver_->authority().c_str(),
+            resolver_->name_to_resolve().c_str(), kDefaultSecurePort,
+            resolver_->interested_parties(), &on_hostname_resolved_,
+            &addresses_, resolver_->query_timeout_ms_));
+        GRPC_CARES_TRACE_LOG(
+            "resolver:%p Started resolving hostnames. hostname_request_:%p",
+            resolver_.get(), hostname_request_.get());
+      }
       if (resolver_->enable_srv_queries_) {
         Ref(DEBUG_LOCATION, "OnSRVResolved").release();
         GRPC_CLOSURE_INIT(&on_srv_resolved_, OnSRVResolved, this, nullptr);
@@ -160,6 +180,8 @@ class AresClientChannelDNSResolver : public PollingResolver {
         if (hostname_request_ != nullptr) {
           grpc_cancel_ares_request(hostname_request_.get());
         }
+        // Delivers CANCELLED to OnCachedHostnameResolved() if still pending.
+        cached_hostname_request_.reset();
         if (srv_request_ != nullptr) {
           grpc_cancel_ares_request(srv_request_.get());
         }
@@ -172,6 +194,8 @@ class AresClientChannelDNSResolver : public PollingResolver {
 
    private:
     static void OnHostnameResolved(void* arg, grpc_error_handle error);
+    void OnCachedHostnameResolved(
+        absl::StatusOr<std::vector<grpc_resolved_address>> addresses);
     static void OnSRVResolved(void* arg, grpc_error_handle error);
     static void OnTXTResolved(void* arg, grpc_error_handle error);
     absl::optional<Result> OnResolvedLocked(grpc_error_handle error)
@@ -182,6 +206,8 @@ class AresClientChannelDNSResolver : public PollingResolver {
     grpc_closure on_hostname_resolved_;
     std::unique_ptr<grpc_ares_request> hostname_request_
         ABSL_GUARDED_BY(on_resolved_mu_);
+    OrphanablePtr<Orphanable> cached_hostname_request_
+        ABSL_GUARDED_BY(on_resolved_mu_);
     grpc_closure on_srv_resolved_;
     std::unique_ptr<grpc_ares_request> srv_request_
         ABSL_GUARDED_BY(on_resolved_mu_);
@@ -348,6 +374,30 @@ void AresClientChannelDNSResolver::AresRequestWrapper::OnHostnameResolved(
   self->Unref(DEBUG_LOCATION, "OnHostnameResolved");
 }
 
+void AresClientChannelDNSResolver::AresRequestWrapper::
+    OnCachedHostnameResolved(
+        absl::StatusOr<std::vector<grpc_resolved_address>> addresses) {
+  absl::optional<Result> result;
+  {
+    MutexLock lock(&on_resolved_mu_);
+    cached_hostname_request_.reset();
+    grpc_error_handle error = GRPC_ERROR_NONE;
+    if (addresses.ok()) {
+      addresses_ = absl::make_unique<ServerAddressList>();
+      for (const auto& addr : *addresses) {
+        addresses_->emplace_back(addr, ChannelArgs());
+      }
+    } else {
+      error = absl_status_to_grpc_error(addresses.status());
+    }
+    result = OnResolvedLocked(error);
+  }
+  if (result.has_value()) {
+    resolver_->OnRequestComplete(std::move(*result));
+  }
+  Unref(DEBUG_LOCATION, "OnCachedHostnameResolved");
+}
+
 void AresClientChannelDNSResolver::AresRequestWrapper::OnSRVResolved(
     void* arg, grpc_error_handle error) {
   auto* self = static_cast<AresRequestWrapper*>(arg);
@@ -385,12 +435,15 @@ void AresClientChannelDNSResolver::AresRequestWrapper::OnTXTResolved(
 absl::optional<AresClientChannelDNSResolver::Result>
 AresClientChannelDNSResolver::AresRequestWrapper::OnResolvedLocked(
     grpc_error_handle error) ABSL_EXCLUSIVE_LOCKS_REQUIRED(on_resolved_mu_) {
-  if (hostname_request_ != nullptr || srv_request_ != nullptr ||
-      txt_request_ != nullptr) {
+  if (hostname_request_ != nullptr || cached_hostname_request_ != nullptr ||
+      srv_request_ != nullptr || txt_request_ != nullptr) {
     GRPC_CARES_TRACE_LOG(
         "resolver:%p OnResolved() waiting for results (hostname: %s, srv: %s, "
         "txt: %s)",
-        this, hostname_request_ != nullptr ? "waiting" : "done",
+        this,
+        hostname_request_ != nullptr || cached_hostname_request_ != nullptr
+            ? "waiting"
+            : "done",
         srv_request_ != nullptr ? "waiting" : "done",
         txt_request_ != nullptr ? "waiting" : "done");
     return absl::nullopt;
@@ -0,0 +1,285 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/filters/client_channel/resolver/dns/dns_result_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+#include <grpc/support/log.h>
+
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/global_config.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/pollset_set.h"
+#include "src/core/lib/iomgr/resolve_address.h"
+#include "src/core/lib/iomgr/resolve_address_impl.h"
+
+GPR_GLOBAL_CONFIG_DEFINE_INT32(
+    grpc_dns_cache_ttl_ms, 0,
+    "If positive, hostname lookups made by dns resolvers are cached "
+    "process-wide for this many milliseconds and shared across channels.");
+GPR_GLOBAL_CONFIG_DEFINE_INT32(
+    grpc_dns_cache_stale_ms, 0,
+    "How long after GRPC_DNS_CACHE_TTL_MS an expired entry may still answer "
+    "lookups while it is refreshed in the background, in milliseconds.");
+GPR_GLOBAL_CONFIG_DEFINE_INT32(
+    grpc_dns_cache_negative_ttl_ms, 1000,
+    "How long failed hostname lookups are cached, in milliseconds.");
+
+namespace grpc_core {
+
+namespace {
+
+TraceFlag grpc_trace_dns_cache(false, "dns_cache");
+
+// Bounds the number of names kept. Expired entries are purged first when
+// the cache grows past this; if none are, the one expiring soonest goes.
+constexpr size_t kMaxEntries = 1024;
+
+Duration ConfigMillis(int32_t value) {
+  return Duration::Milliseconds(std::max<int32_t>(0, value));
+}
+
+}  // namespace
+
+//
+// DnsResultCache::Flight
+//
+
+// A lookup in progress on the underlying resolver. Owns the pollset_set
+// handed to that resolver, so that callers can come and go while it runs.
+struct DnsResultCache::Flight {
+  Flight() : pollset_set(grpc_pollset_set_create()) {}
+  ~Flight();
+
+  grpc_pollset_set* const pollset_set;
+  std::vector<RefCountedPtr<Waiter>> waiters;
+};
+
+//
+// DnsResultCache::Waiter
+//
+
+// One caller waiting on a flight. Held by the caller (as an Orphanable) and
+// by the flight until the result is delivered.
+class DnsResultCache::Waiter : public InternallyRefCounted<Waiter> {
+ public:
+  Waiter(DnsResultCache* cache, std::string key,
+         std::function<void(Addresses)> on_resolved,
+         grpc_pollset_set* interested_parties)
+      : cache_(cache),
+        key_(std::move(key)),
+        on_resolved_(std::move(on_resolved)),
+        interested_parties_(interested_parties) {}
+
+  void Orphan() override {
+    {
+      MutexLock lock(&cache_->mu_);
+      auto it = cache_->flights_.find(key_);
+      if (it != cache_->flights_.end()) {
+        Flight* flight = it->second.get();
+        auto w = std::find_if(
+            flight->waiters.begin(), flight->waiters.end(),
+            [this](const RefCountedPtr<Waiter>& w) { return w.get() == this; });
+        if (w != flight->waiters.end()) {
+          if (interested_parties_ != nullptr) {
+            grpc_pollset_set_del_pollset_set(flight->pollset_set,
+                                             interested_parties_);
+          }
+          flight->waiters.erase(w);
+        }
+      }
+    }
+    Deliver(absl::CancelledError("DNS lookup cancelled"));
+    Unref();
+  }
+
+  // Invokes on_resolved_ unless it has already been invoked.
+  void Deliver(Addresses addresses) {
+    if (delivered_.exchange(true, std::memory_order_acq_rel)) return;
+    new DNSCallbackExecCtxScheduler(std::move(on_resolved_),
+                                    std::move(addresses));
+  }
+
+  RefCountedPtr<Waiter> RefForFlight() { return Ref(); }
+
+  grpc_pollset_set* interested_parties() const { return interested_parties_; }
+
+ private:
+  DnsResultCache* const cache_;
+  const std::string key_;
+  std::function<void(Addresses)> on_resolved_;
+  grpc_pollset_set* const interested_parties_;
+  std::atomic<bool> delivered_{false};
+};
+
+DnsResultCache::Flight::~Flight() { grpc_pollset_set_destroy(pollset_set); }
+
+//
+// DnsResultCache
+//
+
+bool DnsResultCache::Enabled() {
+  static const bool enabled = GPR_GLOBAL_CONFIG_GET(grpc_dns_cache_ttl_ms) > 0;
+  return enabled;
+}
+
+DnsResultCache* DnsResultCache::Get() {
+  static DnsResultCache* cache = new DnsResultCache();
+  return cache;
+}
+
+DnsResultCache::DnsResultCache()
+    : ttl_(ConfigMillis(GPR_GLOBAL_CONFIG_GET(grpc_dns_cache_ttl_ms))),
+      stale_(ConfigMillis(GPR_GLOBAL_CONFIG_GET(grpc_dns_cache_stale_ms))),
+      negative_ttl_(ConfigMillis(
+          GPR_GLOBAL_CONFIG_GET(grpc_dns_cache_negative_ttl_ms))) {}
+
+OrphanablePtr<Orphanable> DnsResultCache::LookupHostname(
+    std::function<void(Addresses)> on_resolved, absl::string_view name,
+    absl::string_view default_port, Duration timeout,
+    grpc_pollset_set* interested_parties, absl::string_view name_server) {
+  std::string key = absl::StrCat(name_server, "/", name, ":", default_port);
+  auto waiter = MakeOrphanable<Waiter>(this, key, std::move(on_resolved),
+                                       interested_parties);
+  Flight* new_flight = nullptr;
+  {
+    MutexLock lock(&mu_);
+    Timestamp now = ExecCtx::Get()->Now();
+    auto entry = entries_.find(key);
+    if (entry != entries_.end() && now < entry->second.stale_until) {
+      bool fresh = now < entry->second.fresh_until;
+      if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_dns_cache)) {
+        gpr_log(GPR_DEBUG, "[dns_cache] %s hit for %s",
+                fresh ? "fresh" : "stale", key.c_str());
+      }
+      waiter->Deliver(entry->second.addresses);
+      if (fresh || flights_.count(key) != 0) return waiter;
+      // Revalidate in the background; nobody waits on this flight.
+      new_flight = new Flight();
+      flights_.emplace(key, absl::WrapUnique(new_flight));
+    } else {
+      auto it = flights_.find(key);
+      if (it != flights_.end()) {
+        if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_dns_cache)) {
+          gpr_log(GPR_DEBUG, "[dns_cache] joining lookup in flight for %s",
+                  key.c_str());
+        }
+      } else {
+        new_flight = new Flight();
+        it = flights_.emplace(key, absl::WrapUnique(new_flight)).first;
+      }
+      Flight* flight = it->second.get();
+      if (interested_parties != nullptr) {
+        grpc_pollset_set_add_pollset_set(flight->pollset_set,
+                                         interested_parties);
+      }
+      flight->waiters.push_back(waiter->RefForFlight());
+    }
+  }
+  if (new_flight != nullptr) {
+    StartFlight(key, new_flight, name, default_port, timeout, name_server);
+  }
+  return waiter;
+}
+
+void DnsResultCache::StartFlight(const std::string& key, Flight* flight,
+                                 absl::string_view name,
+                                 absl::string_view default_port,
+                                 Duration timeout,
+                                 absl::string_view name_server) {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_dns_cache)) {
+    gpr_log(GPR_DEBUG, "[dns_cache] resolving %s", key.c_str());
+  }
+  // The flight stays in flights_ until OnFlightDone removes it, so its
+  // pollset_set outlives the request. A background refresh has no callers'
+  // pollsets attached; the native resolver does not need them, and c-ares
+  // falls back to its one-second backup poll alarm.
+  GetDNSResolver()->LookupHostname(
+      [this, key](Addresses addresses) {
+        OnFlightDone(key, std::move(addresses));
+      },
+      name, default_port, timeout, flight->pollset_set, name_server);
+}
+
+void DnsResultCache::OnFlightDone(const std::string& key,
+                                  Addresses addresses) {
+  std::unique_ptr<Flight> flight;
+  {
+    MutexLock lock(&mu_);
+    auto it = flights_.find(key);
+    GPR_ASSERT(it != flights_.end());
+    flight = std::move(it->second);
+    flights_.erase(it);
+    // Detach the callers' pollsets while holding the lock, so that a caller
+    // orphaning its handle concurrently cannot see its pollset_set in use
+    // after Orphan() returns.
+    for (const auto& waiter : flight->waiters) {
+      if (waiter->interested_parties() != nullptr) {
+        grpc_pollset_set_del_pollset_set(flight->pollset_set,
+                                         waiter->interested_parties());
+      }
+    }
+    Timestamp now = ExecCtx::Get()->Now();
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_dns_cache)) {
+      gpr_log(GPR_DEBUG, "[dns_cache] lookup for %s done: %s", key.c_str(),
+              addresses.status().ToString().c_str());
+    }
+    if (addresses.ok()) {
+      InsertLocked(key, Entry{addresses, now + ttl_, now + ttl_ + stale_});
+    } else if (addresses.status().code() != absl::StatusCode::kCancelled) {
+      auto entry = entries_.find(key);
+      bool keep_stale = entry != entries_.end() &&
+                        entry->second.addresses.ok() &&
+                        now < entry->second.stale_until;
+      if (!keep_stale) {
+        InsertLocked(key, Entry{addresses, now + negative_ttl_,
+                                now + negative_ttl_});
+      }
+    }
+  }
+  for (const auto& waiter : flight->waiters) {
+    waiter->Deliver(addresses);
+  }
+}
+
+void DnsResultCache::InsertLocked(const std::string& key, Entry entry) {
+  entries_[key] = std::move(entry);
+  if (entries_.size() <= kMaxEntries) return;
+  Timestamp now = ExecCtx::Get()->Now();
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (it->second.stale_until <= now) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (entries_.size() <= kMaxEntries) return;
+  entries_.erase(std::min_element(
+      entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+        return a.second.stale_until < b.second.stale_until;
+      }));
+}
+
+}  // namespace grpc_core
@@ -0,0 +1,114 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef GRPC_CORE_EXT_FILTERS_CLIENT_CHANNEL_RESOLVER_DNS_DNS_RESULT_CACHE_H
+#define GRPC_CORE_EXT_FILTERS_CLIENT_CHANNEL_RESOLVER_DNS_DNS_RESULT_CACHE_H
+
+#include <grpc/support/port_platform.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+#include "src/core/lib/gprpp/global_config_generic.h"
+#include "src/core/lib/gprpp/orphanable.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/gprpp/time.h"
+#include "src/core/lib/iomgr/iomgr_fwd.h"
+#include "src/core/lib/iomgr/resolved_address.h"
+
+GPR_GLOBAL_CONFIG_DECLARE_INT32(grpc_dns_cache_ttl_ms);
+GPR_GLOBAL_CONFIG_DECLARE_INT32(grpc_dns_cache_stale_ms);
+GPR_GLOBAL_CONFIG_DECLARE_INT32(grpc_dns_cache_negative_ttl_ms);
+
+namespace grpc_core {
+
+// A process-wide cache of hostname lookups shared by all channels' dns
+// resolvers, so that a process creating many channels to the same hosts
+// resolves each name once per TTL. Disabled unless GRPC_DNS_CACHE_TTL_MS is
+// set to a positive value.
+//
+// - Concurrent lookups for the same name, port and name server share a single
+//   request to the underlying DNSResolver.
+// - Successful results are fresh for GRPC_DNS_CACHE_TTL_MS. Neither
+//   getaddrinfo() nor the c-ares hostname query exposes record TTLs to us, so
+//   this is a configured upper bound rather than the records' own TTL.
+// - For GRPC_DNS_CACHE_STALE_MS after that, a lookup is answered from the
+//   expired entry immediately while a refresh runs in the background. A
+//   failed refresh leaves the stale entry in place.
+// - Failures (other than cancellation) are cached for
+//   GRPC_DNS_CACHE_NEGATIVE_TTL_MS.
+class DnsResultCache {
+ public:
+  using Addresses = absl::StatusOr<std::vector<grpc_resolved_address>>;
+
+  // Returns true if the cache is enabled for this process.
+  static bool Enabled();
+
+  static DnsResultCache* Get();
+
+  // Resolves \a name via GetDNSResolver(), answering from the cache when
+  // possible. \a on_resolved is invoked exactly once, never inline. If the
+  // returned handle is orphaned first, it is invoked promptly with a
+  // CANCELLED status; the shared lookup itself keeps running and still
+  // populates the cache.
+  OrphanablePtr<Orphanable> LookupHostname(
+      std::function<void(Addresses)> on_resolved, absl::string_view name,
+      absl::string_view default_port, Duration timeout,
+      grpc_pollset_set* interested_parties, absl::string_view name_server);
+
+ private:
+  class Waiter;
+  struct Flight;
+
+  struct Entry {
+    Addresses addresses;
+    // The entry answers lookups on its own until fresh_until, and answers
+    // while triggering a refresh until stale_until.
+    Timestamp fresh_until;
+    Timestamp stale_until;
+  };
+
+  DnsResultCache();
+
+  // Starts a lookup for key on the underlying resolver. The flight must
+  // already be in flights_.
+  void StartFlight(const std::string& key, Flight* flight,
+                   absl::string_view name, absl::string_view default_port,
+                   Duration timeout, absl::string_view name_server);
+  void OnFlightDone(const std::string& key, Addresses addresses);
+  void InsertLocked(const std::string& key, Entry entry)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Duration ttl_;
+  const Duration stale_;
+  const Duration negative_ttl_;
+
+  Mutex mu_;
+  std::map<std::string, Entry> entries_ ABSL_GUARDED_BY(mu_);
+  std::map<std::string, std::unique_ptr<Flight>> flights_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_EXT_FILTERS_CLIENT_CHANNEL_RESOLVER_DNS_DNS_RESULT_CACHE_H
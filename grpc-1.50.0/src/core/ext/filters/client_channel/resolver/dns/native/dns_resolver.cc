@@ -35,6 +35,7 @@
 #include <grpc/support/log.h>
 
 #include "src/core/ext/filters/client_channel/resolver/dns/dns_resolver_selection.h"
+#include "src/core/ext/filters/client_channel/resolver/dns/dns_result_cache.h"
 #include "src/core/ext/filters/client_channel/resolver/polling_resolver.h"
 #include "src/core/lib/backoff/backoff.h"
 #include "src/core/lib/channel/channel_args.h"
@@ -119,6 +120,19 @@ NativeClientChannelDNSResolver::~NativeClientChannelDNSResolver() {
 
 OrphanablePtr<Orphanable> NativeClientChannelDNSResolver::StartRequest() {
   Ref(DEBUG_LOCATION, "dns_request").release();
+  if (DnsResultCache::Enabled()) {
+    // Orphaning the cache's handle delivers a CANCELLED result, which
+    // PollingResolver ignores once it has been shut down.
+    auto request = DnsResultCache::Get()->LookupHostname(
+        absl::bind_front(&NativeClientChannelDNSResolver::OnResolved, this),
+        name_to_resolve(), kDefaultSecurePort, kDefaultDNSRequestTimeout,
+        interested_parties(), /*name_server=*/"");
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_dns_resolver)) {
+      gpr_log(GPR_DEBUG, "[dns_resolver=%p] starting cached request=%p", this,
+              request.get());
+    }
+    return request;
+  }
   auto dns_request_handle = GetDNSResolver()->LookupHostname(
       absl::bind_front(&NativeClientChannelDNSResolver::OnResolved, this),
       name_to_resolve(), kDefaultSecurePort, kDefaultDNSRequestTimeout,
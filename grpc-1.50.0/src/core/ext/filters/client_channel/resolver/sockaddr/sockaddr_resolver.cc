@@ -29,10 +29,12 @@
 
 #include <grpc/support/log.h>
 
+#include "src/core/ext/transport/shm/shm_handshaker.h"
 #include "src/core/lib/address_utils/parse_address.h"
 #include "src/core/lib/channel/channel_args.h"
 #include "src/core/lib/config/core_configuration.h"
 #include "src/core/lib/gprpp/orphanable.h"
+#include "src/core/lib/iomgr/error.h"
 #include "src/core/lib/iomgr/port.h"
 #include "src/core/lib/iomgr/resolved_address.h"
 #include "src/core/lib/resolver/resolver.h"
@@ -78,7 +80,8 @@ void SockaddrResolver::StartLocked() {
 
 bool ParseUri(const URI& uri,
               bool parse(const URI& uri, grpc_resolved_address* dst),
-              ServerAddressList* addresses) {
+              ServerAddressList* addresses,
+              const ChannelArgs& address_args = ChannelArgs()) {
   if (!uri.authority().empty()) {
     gpr_log(GPR_ERROR, "authority-based URIs not supported by the %s scheme",
             uri.scheme().c_str());
@@ -98,16 +101,17 @@ bool ParseUri(const URI& uri,
       break;
     }
     if (addresses != nullptr) {
-      addresses->emplace_back(addr, ChannelArgs());
+      addresses->emplace_back(addr, address_args);
     }
   }
   return !errors_found;
 }
 
 OrphanablePtr<Resolver> CreateSockaddrResolver(
-    ResolverArgs args, bool parse(const URI& uri, grpc_resolved_address* dst)) {
+    ResolverArgs args, bool parse(const URI& uri, grpc_resolved_address* dst),
+    const ChannelArgs& address_args = ChannelArgs()) {
   ServerAddressList addresses;
-  if (!ParseUri(args.uri, parse, &addresses)) return nullptr;
+  if (!ParseUri(args.uri, parse, &addresses, address_args)) return nullptr;
   // Instantiate resolver.
   return MakeOrphanable<SockaddrResolver>(std::move(addresses),
                                           std::move(args));
@@ -175,6 +179,40 @@ class UnixAbstractResolverFactory : public ResolverFactory {
 };
 #endif  // GRPC_HAVE_UNIX_SOCKET
 
+#ifdef GRPC_POSIX_SHM
+// Connects to a Unix socket like "unix:", then moves the connection onto
+// shared memory rings.
+bool ParseUnixShm(const URI& uri, grpc_resolved_address* resolved_addr) {
+  if (uri.scheme() != "unix-shm") return false;
+  grpc_error_handle error = UnixSockaddrPopulate(uri.path(), resolved_addr);
+  if (!GRPC_ERROR_IS_NONE(error)) {
+    gpr_log(GPR_ERROR, "%s", grpc_error_std_string(error).c_str());
+    GRPC_ERROR_UNREF(error);
+    return false;
+  }
+  return true;
+}
+
+class UnixShmResolverFactory : public ResolverFactory {
+ public:
+  absl::string_view scheme() const override { return "unix-shm"; }
+
+  bool IsValidUri(const URI& uri) const override {
+    return ParseUri(uri, ParseUnixShm, nullptr);
+  }
+
+  OrphanablePtr<Resolver> CreateResolver(ResolverArgs args) const override {
+    return CreateSockaddrResolver(
+        std::move(args), ParseUnixShm,
+        ChannelArgs().Set(GRPC_ARG_SHM_TRANSPORT, true));
+  }
+
+  std::string GetDefaultAuthority(const URI& /*uri*/) const override {
+    return "localhost";
+  }
+};
+#endif  // GRPC_POSIX_SHM
+
 }  // namespace
 
 void RegisterSockaddrResolver(CoreConfiguration::Builder* builder) {
@@ -188,6 +226,10 @@ void RegisterSockaddrResolver(CoreConfiguration::Builder* builder) {
   builder->resolver_registry()->RegisterResolverFactory(
       absl::make_unique<UnixAbstractResolverFactory>());
 #endif
+#ifdef GRPC_POSIX_SHM
+  builder->resolver_registry()->RegisterResolverFactory(
+      absl::make_unique<UnixShmResolverFactory>());
+#endif
 }
 
 }  // namespace grpc_core
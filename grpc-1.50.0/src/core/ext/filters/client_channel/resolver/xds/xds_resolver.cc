@@ -350,6 +350,7 @@ class XdsResolver : public Resolver {
 
     RefCountedPtr<XdsResolver> resolver_;
     RouteTable route_table_;
+    std::unique_ptr<XdsRouting::RegexPathMatcherSet> regex_path_matchers_;
     std::map<absl::string_view, RefCountedPtr<ClusterState>> clusters_;
     std::vector<const grpc_channel_filter*> filters_;
   };
@@ -524,6 +525,8 @@ XdsResolver::XdsConfigSelector::XdsConfigSelector(
       if (!status->ok()) return;
     }
   }
+  regex_path_matchers_ = XdsRouting::RegexPathMatcherSet::Create(
+      RouteListIterator(&route_table_));
   // Populate filter list.
   for (const auto& http_filter :
        resolver_->current_listener_.http_connection_manager.http_filters) {
@@ -673,7 +676,7 @@ ConfigSelector::CallConfig XdsResolver::XdsConfigSelector::GetCallConfig(
     GetCallConfigArgs args) {
   auto route_index = XdsRouting::GetRouteForRequest(
       RouteListIterator(&route_table_), StringViewFromSlice(*args.path),
-      args.initial_metadata);
+      args.initial_metadata, regex_path_matchers_.get());
   if (!route_index.has_value()) {
     return CallConfig();
   }
@@ -91,7 +91,8 @@ class ChannelData {
 class CallData {
  public:
   CallData(grpc_call_element* elem, const grpc_call_element_args& args)
-      : call_combiner_(args.call_combiner) {
+      : call_combiner_(args.call_combiner),
+        compression_state_(args.arena->memory_allocator()) {
     ChannelData* channeld = static_cast<ChannelData*>(elem->channel_data);
     // The call's message compression algorithm is set to channel's default
     // setting. It can be overridden later by initial metadata.
@@ -122,6 +123,8 @@ class CallData {
 
   grpc_core::CallCombiner* call_combiner_;
   grpc_compression_algorithm compression_algorithm_ = GRPC_COMPRESS_NONE;
+  // Reused for the messages sent on this call after the first.
+  grpc_core::MessageCompressionState compression_state_;
   grpc_error_handle cancel_error_ = GRPC_ERROR_NONE;
   grpc_transport_stream_op_batch* send_message_batch_ = nullptr;
   bool seen_initial_metadata_ = false;
@@ -171,9 +174,9 @@ void CallData::FinishSendMessage(grpc_call_element* elem) {
     uint32_t& send_flags = send_message_batch_->payload->send_message.flags;
     grpc_core::SliceBuffer* payload =
         send_message_batch_->payload->send_message.send_message;
-    bool did_compress =
-        grpc_msg_compress(compression_algorithm_, payload->c_slice_buffer(),
-                          tmp.c_slice_buffer());
+    bool did_compress = compression_state_.Compress(
+        compression_algorithm_, payload->c_slice_buffer(),
+        tmp.c_slice_buffer());
     if (did_compress) {
       if (GRPC_TRACE_FLAG_ENABLED(grpc_compression_trace)) {
         const char* algo_name;
@@ -24,7 +24,9 @@
 #include <string.h>
 
 #include <new>
+#include <string>
 
+#include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/optional.h"
@@ -69,7 +71,8 @@ class CallData {
  public:
   CallData(const grpc_call_element_args& args, const ChannelData* chand)
       : call_combiner_(args.call_combiner),
-        max_recv_message_length_(chand->max_recv_size()) {
+        max_recv_message_length_(chand->max_recv_size()),
+        compression_state_(args.arena->memory_allocator()) {
     // Initialize state for recv_initial_metadata_ready callback
     GRPC_CLOSURE_INIT(&on_recv_initial_metadata_ready_,
                       OnRecvInitialMetadataReady, this,
@@ -117,6 +120,8 @@ class CallData {
   bool seen_recv_message_ready_ = false;
   int max_recv_message_length_;
   grpc_compression_algorithm algorithm_ = GRPC_COMPRESS_NONE;
+  // Reused for the messages received on this call after the first.
+  MessageCompressionState compression_state_;
   absl::optional<SliceBuffer>* recv_message_ = nullptr;
   uint32_t* recv_message_flags_ = nullptr;
   grpc_closure on_recv_message_ready_;
@@ -183,14 +188,24 @@ void CallData::OnRecvMessageReady(void* arg, grpc_error_handle error) {
             GRPC_ERROR_REF(calld->error_));
       }
       SliceBuffer decompressed_slices;
-      if (grpc_msg_decompress(calld->algorithm_,
-                              (*calld->recv_message_)->c_slice_buffer(),
-                              decompressed_slices.c_slice_buffer()) == 0) {
+      absl::Status status = calld->compression_state_.Decompress(
+          calld->algorithm_, (*calld->recv_message_)->c_slice_buffer(),
+          decompressed_slices.c_slice_buffer(),
+          calld->max_recv_message_length_ < 0
+              ? SIZE_MAX
+              : static_cast<size_t>(calld->max_recv_message_length_));
+      if (status.code() == absl::StatusCode::kResourceExhausted) {
         GPR_DEBUG_ASSERT(GRPC_ERROR_IS_NONE(calld->error_));
-        calld->error_ = GRPC_ERROR_CREATE_FROM_CPP_STRING(absl::StrCat(
-            "Unexpected error decompressing data for algorithm with "
-            "enum value ",
-            calld->algorithm_));
+        calld->error_ = grpc_error_set_int(
+            GRPC_ERROR_CREATE_FROM_CPP_STRING(absl::StrFormat(
+                "Received message larger than max after decompression "
+                "(more than %d bytes)",
+                calld->max_recv_message_length_)),
+            GRPC_ERROR_INT_GRPC_STATUS, GRPC_STATUS_RESOURCE_EXHAUSTED);
+      } else if (!status.ok()) {
+        GPR_DEBUG_ASSERT(GRPC_ERROR_IS_NONE(calld->error_));
+        calld->error_ = GRPC_ERROR_CREATE_FROM_CPP_STRING(
+            std::string(status.message()));
       } else {
         *calld->recv_message_flags_ =
             (*calld->recv_message_flags_ & (~GRPC_WRITE_INTERNAL_COMPRESS)) |
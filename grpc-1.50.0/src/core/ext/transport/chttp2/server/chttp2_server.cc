@@ -49,6 +49,7 @@
 #include "src/core/ext/transport/chttp2/transport/chttp2_transport.h"
 #include "src/core/ext/transport/chttp2/transport/frame.h"
 #include "src/core/ext/transport/chttp2/transport/internal.h"
+#include "src/core/ext/transport/shm/shm_handshaker.h"
 #include "src/core/lib/address_utils/sockaddr_utils.h"
 #include "src/core/lib/channel/channel_args.h"
 #include "src/core/lib/channel/channelz.h"
@@ -96,6 +97,9 @@ namespace {
 
 const char kUnixUriPrefix[] = "unix:";
 const char kUnixAbstractUriPrefix[] = "unix-abstract:";
+#ifdef GRPC_POSIX_SHM
+const char kUnixShmUriPrefix[] = "unix-shm:";
+#endif
 
 class Chttp2ServerListener : public Server::ListenerInterface {
  public:
@@ -924,6 +928,7 @@ grpc_error_handle Chttp2ServerAddPort(Server* server, const char* addr,
   std::vector<grpc_error_handle> error_list;
   std::string parsed_addr = URI::PercentDecode(addr);
   absl::string_view parsed_addr_unprefixed{parsed_addr};
+  ChannelArgs listener_args = args;
   // Using lambda to avoid use of goto.
   grpc_error_handle error = [&]() {
     grpc_error_handle error = GRPC_ERROR_NONE;
@@ -933,6 +938,14 @@ grpc_error_handle Chttp2ServerAddPort(Server* server, const char* addr,
                                    kUnixAbstractUriPrefix)) {
       resolved_or =
           grpc_resolve_unix_abstract_domain_address(parsed_addr_unprefixed);
+#ifdef GRPC_POSIX_SHM
+    } else if (absl::ConsumePrefix(&parsed_addr_unprefixed,
+                                   kUnixShmUriPrefix)) {
+      // A Unix socket whose connections the shm handshaker moves onto shared
+      // memory; clients that do not ask for it are served over the socket.
+      resolved_or = grpc_resolve_unix_domain_address(parsed_addr_unprefixed);
+      listener_args = args.Set(GRPC_ARG_SHM_TRANSPORT, true);
+#endif
     } else {
       resolved_or =
           GetDNSResolver()->LookupHostnameBlocking(parsed_addr, "https");
@@ -948,8 +961,8 @@ grpc_error_handle Chttp2ServerAddPort(Server* server, const char* addr,
         grpc_sockaddr_set_port(&addr, *port_num);
       }
       int port_temp = -1;
-      error = Chttp2ServerListener::Create(server, &addr, args, args_modifier,
-                                           &port_temp);
+      error = Chttp2ServerListener::Create(server, &addr, listener_args,
+                                           args_modifier, &port_temp);
       if (!GRPC_ERROR_IS_NONE(error)) {
         error_list.push_back(error);
       } else {
@@ -0,0 +1,317 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/transport/chttp2/transport/base64_simd.h"
+
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GRPC_BASE64_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define GRPC_BASE64_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace grpc_core {
+
+namespace {
+
+using EncodeFn = size_t (*)(const uint8_t* in, size_t len, char* out);
+using DecodeFn = size_t (*)(const uint8_t* in, size_t len, uint8_t* out);
+
+#ifndef GRPC_BASE64_SIMD_NEON
+size_t EncodeNone(const uint8_t*, size_t, char*) { return 0; }
+size_t DecodeNone(const uint8_t*, size_t, uint8_t*) { return 0; }
+#endif
+
+#ifdef GRPC_BASE64_SIMD_X86
+
+// The x86 kernels follow the well known pshufb based scheme: reshuffle each
+// 3 byte group into a 32 bit lane, move the four 6 bit fields into separate
+// bytes with 16 bit multiplies, then translate indices to characters by
+// adding a per-range offset (and the reverse for decoding).
+
+#define GRPC_BASE64_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define GRPC_BASE64_TARGET_AVX2 __attribute__((target("avx2")))
+
+GRPC_BASE64_TARGET_SSSE3 inline __m128i EncodeReshuffle128(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+  const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+  const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+  const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+GRPC_BASE64_TARGET_SSSE3 inline __m128i EncodeTranslate128(__m128i in) {
+  // 0..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12; then 0..25 -> 13.
+  __m128i index = _mm_subs_epu8(in, _mm_set1_epi8(51));
+  const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), in);
+  index = _mm_or_si128(index, _mm_and_si128(less, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(in, _mm_shuffle_epi8(offsets, index));
+}
+
+GRPC_BASE64_TARGET_SSSE3 size_t EncodeSsse3(const uint8_t* in, size_t len,
+                                            char* out) {
+  size_t i = 0;
+  // Each step reads 16 bytes but consumes only 12.
+  for (; len - i >= 16; i += 12, out += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    v = EncodeTranslate128(EncodeReshuffle128(v));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+  }
+  return i;
+}
+
+GRPC_BASE64_TARGET_AVX2 size_t EncodeAvx2(const uint8_t* in, size_t len,
+                                          char* out) {
+  size_t i = 0;
+  // Each step reads 28 bytes but consumes only 24.
+  for (; len - i >= 28; i += 24, out += 32) {
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m128i hi =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12));
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    v = _mm256_shuffle_epi8(
+        v, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,
+                            1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+    const __m256i t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    v = _mm256_or_si256(t1, t3);
+    __m256i index = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+    const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), v);
+    index = _mm256_or_si256(index, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+    const __m256i offsets = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    v = _mm256_add_epi8(v, _mm256_shuffle_epi8(offsets, index));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+  }
+  return i + EncodeSsse3(in + i, len - i, out);
+}
+
+// Classifies characters by nibble: a character is in the alphabet iff the
+// low and high nibble lookups share no bits. The roll table then maps each
+// range onto its 6 bit value ('/' is special cased as it shares a high
+// nibble with '+').
+#define GRPC_BASE64_DECODE_LUT_LO                                           \
+  0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, \
+      0x1B, 0x1B, 0x1B, 0x1A
+#define GRPC_BASE64_DECODE_LUT_HI                                           \
+  0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, \
+      0x10, 0x10, 0x10, 0x10
+#define GRPC_BASE64_DECODE_LUT_ROLL \
+  0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0
+#define GRPC_BASE64_DECODE_PACK \
+  2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1
+
+GRPC_BASE64_TARGET_SSSE3 size_t DecodeSsse3(const uint8_t* in, size_t len,
+                                            uint8_t* out) {
+  const __m128i lut_lo = _mm_setr_epi8(GRPC_BASE64_DECODE_LUT_LO);
+  const __m128i lut_hi = _mm_setr_epi8(GRPC_BASE64_DECODE_LUT_HI);
+  const __m128i lut_roll = _mm_setr_epi8(GRPC_BASE64_DECODE_LUT_ROLL);
+  const __m128i mask_2f = _mm_set1_epi8(0x2f);
+  size_t i = 0;
+  for (; len - i >= 16; i += 16, out += 12) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    const __m128i hi_nibbles =
+        _mm_and_si128(_mm_srli_epi32(v, 4), mask_2f);
+    const __m128i lo_nibbles = _mm_and_si128(v, mask_2f);
+    const __m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m128i lo = _mm_shuffle_epi8(lut_lo, lo_nibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi),
+                                         _mm_setzero_si128())) != 0) {
+      break;
+    }
+    const __m128i eq_2f = _mm_cmpeq_epi8(v, mask_2f);
+    const __m128i roll =
+        _mm_shuffle_epi8(lut_roll, _mm_add_epi8(eq_2f, hi_nibbles));
+    v = _mm_add_epi8(v, roll);
+    v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+    v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+    v = _mm_shuffle_epi8(v, _mm_setr_epi8(GRPC_BASE64_DECODE_PACK));
+    // Store exactly 12 bytes.
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), v);
+    const uint32_t last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+    memcpy(out + 8, &last, 4);
+  }
+  return i;
+}
+
+GRPC_BASE64_TARGET_AVX2 size_t DecodeAvx2(const uint8_t* in, size_t len,
+                                          uint8_t* out) {
+  const __m256i lut_lo = _mm256_setr_epi8(GRPC_BASE64_DECODE_LUT_LO,
+                                          GRPC_BASE64_DECODE_LUT_LO);
+  const __m256i lut_hi = _mm256_setr_epi8(GRPC_BASE64_DECODE_LUT_HI,
+                                          GRPC_BASE64_DECODE_LUT_HI);
+  const __m256i lut_roll = _mm256_setr_epi8(GRPC_BASE64_DECODE_LUT_ROLL,
+                                            GRPC_BASE64_DECODE_LUT_ROLL);
+  const __m256i mask_2f = _mm256_set1_epi8(0x2f);
+  size_t i = 0;
+  for (; len - i >= 32; i += 32, out += 24) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    const __m256i hi_nibbles =
+        _mm256_and_si256(_mm256_srli_epi32(v, 4), mask_2f);
+    const __m256i lo_nibbles = _mm256_and_si256(v, mask_2f);
+    const __m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+    const __m256i lo = _mm256_shuffle_epi8(lut_lo, lo_nibbles);
+    if (!_mm256_testz_si256(lo, hi)) break;
+    const __m256i eq_2f = _mm256_cmpeq_epi8(v, mask_2f);
+    const __m256i roll =
+        _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq_2f, hi_nibbles));
+    v = _mm256_add_epi8(v, roll);
+    v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+    v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+    v = _mm256_shuffle_epi8(v, _mm256_setr_epi8(GRPC_BASE64_DECODE_PACK,
+                                                GRPC_BASE64_DECODE_PACK));
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 0, 0));
+    // Store exactly 24 bytes.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm256_castsi256_si128(v));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + 16),
+                     _mm256_extracti128_si256(v, 1));
+  }
+  return i + DecodeSsse3(in + i, len - i, out);
+}
+
+EncodeFn ChooseEncoder() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return EncodeAvx2;
+  if (__builtin_cpu_supports("ssse3")) return EncodeSsse3;
+  return EncodeNone;
+}
+
+DecodeFn ChooseDecoder() {
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return DecodeAvx2;
+  if (__builtin_cpu_supports("ssse3")) return DecodeSsse3;
+  return DecodeNone;
+}
+
+#elif defined(GRPC_BASE64_SIMD_NEON)
+
+constexpr uint8_t kAlphabet[64] = {
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M',
+    'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z',
+    'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm',
+    'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'};
+
+// Inverse alphabet for the 7 bit ascii range; 0xff marks invalid characters.
+constexpr uint8_t kInverseAlphabet[128] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff,
+};
+
+uint8x16x4_t Load64(const uint8_t* p) {
+  uint8x16x4_t t;
+  t.val[0] = vld1q_u8(p);
+  t.val[1] = vld1q_u8(p + 16);
+  t.val[2] = vld1q_u8(p + 32);
+  t.val[3] = vld1q_u8(p + 48);
+  return t;
+}
+
+size_t EncodeNeon(const uint8_t* in, size_t len, char* out) {
+  const uint8x16x4_t alphabet = Load64(kAlphabet);
+  const uint8x16_t mask = vdupq_n_u8(0x3f);
+  size_t i = 0;
+  for (; len - i >= 48; i += 48, out += 64) {
+    const uint8x16x3_t v = vld3q_u8(in + i);
+    uint8x16x4_t r;
+    r.val[0] = vshrq_n_u8(v.val[0], 2);
+    r.val[1] = vandq_u8(
+        vorrq_u8(vshrq_n_u8(v.val[1], 4), vshlq_n_u8(v.val[0], 4)), mask);
+    r.val[2] = vandq_u8(
+        vorrq_u8(vshrq_n_u8(v.val[2], 6), vshlq_n_u8(v.val[1], 2)), mask);
+    r.val[3] = vandq_u8(v.val[2], mask);
+    r.val[0] = vqtbl4q_u8(alphabet, r.val[0]);
+    r.val[1] = vqtbl4q_u8(alphabet, r.val[1]);
+    r.val[2] = vqtbl4q_u8(alphabet, r.val[2]);
+    r.val[3] = vqtbl4q_u8(alphabet, r.val[3]);
+    vst4q_u8(reinterpret_cast<uint8_t*>(out), r);
+  }
+  return i;
+}
+
+size_t DecodeNeon(const uint8_t* in, size_t len, uint8_t* out) {
+  const uint8x16x4_t inverse_lo = Load64(kInverseAlphabet);
+  const uint8x16x4_t inverse_hi = Load64(kInverseAlphabet + 64);
+  const uint8x16_t invalid = vdupq_n_u8(0xff);
+  const uint8x16_t sixty_four = vdupq_n_u8(64);
+  size_t i = 0;
+  for (; len - i >= 64; i += 64, out += 48) {
+    uint8x16x4_t v = vld4q_u8(in + i);
+    // Out of range lookups leave the previous value in place, so anything
+    // outside 0..127 stays marked invalid.
+    for (int k = 0; k < 4; k++) {
+      const uint8x16_t lo = vqtbx4q_u8(invalid, inverse_lo, v.val[k]);
+      v.val[k] = vqtbx4q_u8(lo, inverse_hi, vsubq_u8(v.val[k], sixty_four));
+    }
+    const uint8x16_t any = vorrq_u8(vorrq_u8(v.val[0], v.val[1]),
+                                    vorrq_u8(v.val[2], v.val[3]));
+    if (vmaxvq_u8(any) > 63) break;
+    uint8x16x3_t r;
+    r.val[0] = vorrq_u8(vshlq_n_u8(v.val[0], 2), vshrq_n_u8(v.val[1], 4));
+    r.val[1] = vorrq_u8(vshlq_n_u8(v.val[1], 4), vshrq_n_u8(v.val[2], 2));
+    r.val[2] = vorrq_u8(vshlq_n_u8(v.val[2], 6), v.val[3]);
+    vst3q_u8(out, r);
+  }
+  return i;
+}
+
+// Advanced SIMD is mandatory on aarch64, so there is nothing to probe.
+EncodeFn ChooseEncoder() { return EncodeNeon; }
+DecodeFn ChooseDecoder() { return DecodeNeon; }
+
+#else
+
+EncodeFn ChooseEncoder() { return EncodeNone; }
+DecodeFn ChooseDecoder() { return DecodeNone; }
+
+#endif
+
+}  // namespace
+
+size_t Base64EncodeBulk(const uint8_t* in, size_t len, char* out) {
+  static const EncodeFn encode = ChooseEncoder();
+  return encode(in, len - len % 3, out);
+}
+
+size_t Base64DecodeBulk(const uint8_t* in, size_t len, uint8_t* out) {
+  static const DecodeFn decode = ChooseDecoder();
+  return decode(in, len - len % 4, out);
+}
+
+}  // namespace grpc_core
@@ -0,0 +1,48 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_BASE64_SIMD_H
+#define GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_BASE64_SIMD_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace grpc_core {
+
+// Vectorized bulk kernels for the standard (RFC 4648, '+' and '/') base64
+// alphabet used by -bin metadata. The implementation is chosen once at
+// runtime from the CPU features available (AVX2, SSSE3, NEON); on other
+// targets they do nothing.
+//
+// Both kernels only handle the bulk of the input and leave the remainder
+// (tails, padding, and anything that fails validation) for the scalar code
+// in bin_encoder.cc, bin_decoder.cc and hpack_parser.cc, so error handling
+// and output are unchanged.
+
+// Encodes a prefix of the len bytes at in, which must be a whole number of
+// 3 byte groups, writing 4 characters per group to out.
+// Returns the number of input bytes consumed (a multiple of 3).
+size_t Base64EncodeBulk(const uint8_t* in, size_t len, char* out);
+
+// Decodes a prefix of the len characters at in, which must be a whole number
+// of 4 character groups, writing 3 bytes per group to out. Stops at the
+// first block containing a character outside the alphabet (including '=').
+// Returns the number of input characters consumed (a multiple of 4).
+size_t Base64DecodeBulk(const uint8_t* in, size_t len, uint8_t* out);
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_BASE64_SIMD_H
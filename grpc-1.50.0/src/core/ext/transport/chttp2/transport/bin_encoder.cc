@@ -25,6 +25,7 @@
 
 #include <grpc/support/log.h>
 
+#include "src/core/ext/transport/chttp2/transport/base64_simd.h"
 #include "src/core/ext/transport/chttp2/transport/huffsyms.h"
 
 static const char alphabet[] =
@@ -59,7 +60,13 @@ grpc_slice grpc_chttp2_base64_encode(const grpc_slice& input) {
   char* out = reinterpret_cast<char*> GRPC_SLICE_START_PTR(output);
   size_t i;
 
-  /* encode full triplets */
+  /* encode the bulk of the full triplets with the vector kernels */
+  size_t consumed = grpc_core::Base64EncodeBulk(in, input_triplets * 3, out);
+  in += consumed;
+  out += consumed / 3 * 4;
+  input_triplets -= consumed / 3;
+
+  /* encode remaining full triplets */
   for (i = 0; i < input_triplets; i++) {
     out[0] = alphabet[in[0] >> 2];
     out[1] = alphabet[((in[0] & 0x3) << 4) | (in[1] >> 4)];
@@ -138,10 +138,15 @@ static void write_action_begin_locked(void* t, grpc_error_handle error);
 static void write_action(void* t, grpc_error_handle error);
 static void write_action_end(void* t, grpc_error_handle error);
 static void write_action_end_locked(void* t, grpc_error_handle error);
+static void write_coalesce_timer_expired(void* tp, grpc_error_handle error);
+static void write_coalesce_timer_expired_locked(void* tp,
+                                                grpc_error_handle error);
 
 static void read_action(void* t, grpc_error_handle error);
 static void read_action_locked(void* t, grpc_error_handle error);
 static void continue_read_action_locked(grpc_chttp2_transport* t);
+static void maybe_resize_hpack_table_for_memory_pressure(
+    grpc_chttp2_transport* t);
 
 // Set a transport level setting, and push it to our peer
 static void queue_setting_update(grpc_chttp2_transport* t,
@@ -297,6 +302,9 @@ static void read_channel_args(grpc_chttp2_transport* t,
   if (max_hpack_table_size >= 0) {
     t->hpack_compressor.SetMaxUsableSize(max_hpack_table_size);
   }
+  t->hpack_compressor.SetIndexedMetadataKeys(
+      channel_args.GetString(GRPC_ARG_HTTP2_HPACK_INDEXED_METADATA_KEYS)
+          .value_or(""));
 
   t->ping_policy.max_pings_without_data =
       std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_MAX_PINGS_WITHOUT_DATA)
@@ -314,6 +322,17 @@ static void read_channel_args(grpc_chttp2_transport* t,
   t->write_buffer_size =
       std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE)
                       .value_or(grpc_core::chttp2::kDefaultWindow));
+  const int write_coalesce_us =
+      channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_COALESCE_US).value_or(0);
+  if (write_coalesce_us > 0) {
+    // Timers have millisecond resolution; round up so that small budgets
+    // still hold writes.
+    t->write_coalesce_delay =
+        grpc_core::Duration::Milliseconds((write_coalesce_us + 999) / 1000);
+  }
+  t->write_coalesce_bytes = static_cast<size_t>(
+      std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_COALESCE_BYTES)
+                      .value_or(64 * 1024)));
   t->keepalive_time =
       std::max(grpc_core::Duration::Milliseconds(1),
                channel_args.GetDurationFromIntMillis(GRPC_ARG_KEEPALIVE_TIME_MS)
@@ -516,6 +535,8 @@ grpc_chttp2_transport::grpc_chttp2_transport(
   init_transport_keepalive_settings(this);
 
   read_channel_args(this, channel_args, is_client);
+  hpack_decoder_table_size =
+      settings[GRPC_LOCAL_SETTINGS][GRPC_CHTTP2_SETTINGS_HEADER_TABLE_SIZE];
 
   // No pings allowed before receiving a header or data frame.
   ping_state.pings_before_data_required = 0;
@@ -587,6 +608,9 @@ static void close_transport_locked(grpc_chttp2_transport* t,
     if (t->have_next_bdp_ping_timer) {
       grpc_timer_cancel(&t->next_bdp_ping_timer);
     }
+    if (t->have_write_coalesce_timer) {
+      grpc_timer_cancel(&t->write_coalesce_timer);
+    }
     switch (t->keepalive_state) {
       case GRPC_CHTTP2_KEEPALIVE_STATE_WAITING:
         grpc_timer_cancel(&t->keepalive_ping_timer);
@@ -783,10 +807,70 @@ static void set_write_state(grpc_chttp2_transport* t,
   }
 }
 
+// Returns true if a write that would start now for \a reason should instead
+// be held so that frames from other streams can join it. Only writes carrying
+// stream data are held, and only while other streams are active; the write
+// starts when the coalescing timer fires, when enough message bytes are
+// waiting, or when anything else initiates a write.
+static bool hold_write_for_coalescing(
+    grpc_chttp2_transport* t, grpc_chttp2_initiate_write_reason reason) {
+  if (t->write_coalesce_delay == grpc_core::Duration::Zero()) return false;
+  switch (reason) {
+    case GRPC_CHTTP2_INITIATE_WRITE_START_NEW_STREAM:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_MESSAGE:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_INITIAL_METADATA:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_TRAILING_METADATA:
+      break;
+    default:
+      return false;
+  }
+  if (!GRPC_ERROR_IS_NONE(t->closed_with_error) ||
+      grpc_chttp2_stream_map_size(&t->stream_map) < 2 ||
+      t->write_coalesce_pending_bytes >= t->write_coalesce_bytes) {
+    return false;
+  }
+  t->write_coalesce_held = true;
+  // A timer armed for an earlier hold may still be pending; it fires no
+  // later than one started now would, so reuse it.
+  if (!t->have_write_coalesce_timer) {
+    t->have_write_coalesce_timer = true;
+    GRPC_CHTTP2_REF_TRANSPORT(t, "write_coalesce");
+    GRPC_CLOSURE_INIT(&t->write_coalesce_timer_expired_locked,
+                      write_coalesce_timer_expired, t,
+                      grpc_schedule_on_exec_ctx);
+    grpc_timer_init(&t->write_coalesce_timer,
+                    grpc_core::ExecCtx::Get()->Now() + t->write_coalesce_delay,
+                    &t->write_coalesce_timer_expired_locked);
+  }
+  return true;
+}
+
+static void write_coalesce_timer_expired(void* tp, grpc_error_handle error) {
+  grpc_chttp2_transport* t = static_cast<grpc_chttp2_transport*>(tp);
+  t->combiner->Run(
+      GRPC_CLOSURE_INIT(&t->write_coalesce_timer_expired_locked,
+                        write_coalesce_timer_expired_locked, t, nullptr),
+      GRPC_ERROR_REF(error));
+}
+
+static void write_coalesce_timer_expired_locked(void* tp,
+                                                grpc_error_handle error) {
+  grpc_chttp2_transport* t = static_cast<grpc_chttp2_transport*>(tp);
+  GPR_ASSERT(t->have_write_coalesce_timer);
+  t->have_write_coalesce_timer = false;
+  if (GRPC_ERROR_IS_NONE(error) && t->write_coalesce_held) {
+    grpc_chttp2_initiate_write(t, GRPC_CHTTP2_INITIATE_WRITE_COALESCE_DEADLINE);
+  }
+  GRPC_CHTTP2_UNREF_TRANSPORT(t, "write_coalesce");
+}
+
 void grpc_chttp2_initiate_write(grpc_chttp2_transport* t,
                                 grpc_chttp2_initiate_write_reason reason) {
   switch (t->write_state) {
     case GRPC_CHTTP2_WRITE_STATE_IDLE:
+      if (hold_write_for_coalescing(t, reason)) break;
+      t->write_coalesce_held = false;
+      t->write_coalesce_pending_bytes = 0;
       set_write_state(t, GRPC_CHTTP2_WRITE_STATE_WRITING,
                       grpc_chttp2_initiate_write_reason_string(reason));
       GRPC_CHTTP2_REF_TRANSPORT(t, "writing");
@@ -1362,6 +1446,8 @@ static void perform_stream_op_locked(void* stream_op,
         *list = cb;
       }
 
+      t->write_coalesce_pending_bytes +=
+          op_payload->send_message.send_message->Length();
       if (s->id != 0 &&
           (!s->write_buffering ||
            s->flow_controlled_buffer.length > t->write_buffer_size)) {
@@ -2432,6 +2518,7 @@ static void read_action_locked(void* tp, grpc_error_handle error) {
     if (t->keepalive_state == GRPC_CHTTP2_KEEPALIVE_STATE_WAITING) {
       grpc_timer_cancel(&t->keepalive_ping_timer);
     }
+    maybe_resize_hpack_table_for_memory_pressure(t);
   }
   grpc_slice_buffer_reset_and_unref_internal(&t->read_buffer);
 
@@ -2453,6 +2540,21 @@ static void read_action_locked(void* tp, grpc_error_handle error) {
   GRPC_ERROR_UNREF(error);
 }
 
+// Scales the HPACK decoder table we advertise to the peer with memory
+// pressure, in the same steps as the endpoint's read buffers and the flow
+// control window target. The table shrinks once the peer acks the setting.
+static void maybe_resize_hpack_table_for_memory_pressure(
+    grpc_chttp2_transport* t) {
+  if (!t->memory_owner.is_valid()) return;
+  const int shift =
+      t->memory_owner.BufferShrinkShift(t->hpack_decoder_table_shrink_shift);
+  if (shift == t->hpack_decoder_table_shrink_shift) return;
+  t->hpack_decoder_table_shrink_shift = shift;
+  queue_setting_update(t, GRPC_CHTTP2_SETTINGS_HEADER_TABLE_SIZE,
+                       t->hpack_decoder_table_size >> shift);
+  grpc_chttp2_initiate_write(t, GRPC_CHTTP2_INITIATE_WRITE_SEND_SETTINGS);
+}
+
 static void continue_read_action_locked(grpc_chttp2_transport* t) {
   const bool urgent = !GRPC_ERROR_IS_NONE(t->goaway_error);
   GRPC_CLOSURE_INIT(&t->read_action_locked, read_action, t,
@@ -2949,6 +3051,8 @@ const char* grpc_chttp2_initiate_write_reason_string(
       return "PING_RESPONSE";
     case GRPC_CHTTP2_INITIATE_WRITE_FORCE_RST_STREAM:
       return "FORCE_RST_STREAM";
+    case GRPC_CHTTP2_INITIATE_WRITE_COALESCE_DEADLINE:
+      return "COALESCE_DEADLINE";
   }
   GPR_UNREACHABLE_CODE(return "unknown");
 }
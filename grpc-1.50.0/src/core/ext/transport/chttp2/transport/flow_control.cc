@@ -180,21 +180,23 @@ FlowControlAction TransportFlowControl::UpdateAction(FlowControlAction action) {
   return action;
 }
 
-// Take in a target and modifies it based on the memory pressure of the system
+// Take in a (log2) target and modifies it based on the memory pressure of the
+// system
 static double AdjustForMemoryPressure(double memory_pressure, double target) {
   // do not increase window under heavy memory pressure.
   static const double kLowMemPressure = 0.1;
   static const double kZeroTarget = 22;
-  static const double kHighMemPressure = 0.8;
   static const double kMaxMemPressure = 0.9;
   if (memory_pressure < kLowMemPressure && target < kZeroTarget) {
     target = (target - kZeroTarget) * memory_pressure / kLowMemPressure +
              kZeroTarget;
-  } else if (memory_pressure > kHighMemPressure) {
-    target *= 1 - std::min(1.0, (memory_pressure - kHighMemPressure) /
-                                    (kMaxMemPressure - kHighMemPressure));
+  } else if (memory_pressure >= kMaxMemPressure) {
+    return 0;
   }
-  return target;
+  // In between, halve the window in the same steps as the endpoint's read
+  // buffers and the HPACK table.
+  return std::max(0.0, target - BufferShrinkShiftForMemoryPressure(
+                                    memory_pressure, 0));
 }
 
 double TransportFlowControl::TargetLogBdp() {
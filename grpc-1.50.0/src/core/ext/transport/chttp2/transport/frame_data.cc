@@ -55,12 +55,13 @@ void grpc_chttp2_encode_data(uint32_t id, grpc_slice_buffer* inbuf,
                              uint32_t write_bytes, int is_eof,
                              grpc_transport_one_way_stats* stats,
                              grpc_slice_buffer* outbuf) {
-  grpc_slice hdr;
   uint8_t* p;
   static const size_t header_size = 9;
 
-  hdr = GRPC_SLICE_MALLOC(header_size);
-  p = GRPC_SLICE_START_PTR(hdr);
+  // Frame headers are written inline into outbuf, sharing the previous slice
+  // when it has room (for example the tail of a HEADERS frame), so a write of
+  // many small frames hands fewer iovecs to the endpoint.
+  p = grpc_slice_buffer_tiny_add(outbuf, header_size);
   GPR_ASSERT(write_bytes < (1 << 24));
   *p++ = static_cast<uint8_t>(write_bytes >> 16);
   *p++ = static_cast<uint8_t>(write_bytes >> 8);
@@ -71,7 +72,6 @@ void grpc_chttp2_encode_data(uint32_t id, grpc_slice_buffer* inbuf,
   *p++ = static_cast<uint8_t>(id >> 16);
   *p++ = static_cast<uint8_t>(id >> 8);
   *p++ = static_cast<uint8_t>(id);
-  grpc_slice_buffer_add(outbuf, hdr);
 
   grpc_slice_buffer_move_first_no_ref(inbuf, write_bytes, outbuf);
 
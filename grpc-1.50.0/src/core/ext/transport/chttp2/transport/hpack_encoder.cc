@@ -23,6 +23,12 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
 
 #include <grpc/slice.h>
 #include <grpc/slice_buffer.h>
@@ -33,6 +39,7 @@
 #include "src/core/ext/transport/chttp2/transport/hpack_constants.h"
 #include "src/core/ext/transport/chttp2/transport/hpack_encoder_table.h"
 #include "src/core/ext/transport/chttp2/transport/varint.h"
+#include "src/core/lib/experiments/experiments.h"
 #include "src/core/lib/surface/validate_metadata.h"
 #include "src/core/lib/transport/timeout_encoding.h"
 
@@ -309,6 +316,16 @@ void HPackCompressor::Framer::EmitLitHdrWithNonBinaryStringKeyNotIdx(
   Add(emit.data());
 }
 
+void HPackCompressor::Framer::EmitLitHdrWithNonBinaryStringKeyNotIdx(
+    uint32_t key_index, Slice value_slice) {
+  NonBinaryStringValue emit(std::move(value_slice));
+  VarintWriter<4> key(key_index);
+  uint8_t* data = AddTiny(key.length() + emit.prefix_length());
+  key.Write(0x00, data);
+  emit.WritePrefix(data + key.length());
+  Add(emit.data());
+}
+
 void HPackCompressor::Framer::AdvertiseTableSizeChange() {
   VarintWriter<3> w(compressor_->table_.max_size());
   w.Write(0x20, AddTiny(w.length()));
@@ -360,9 +377,79 @@ void HPackCompressor::SliceIndex::EmitTo(absl::string_view key,
   values_.emplace_back(value.Ref(), index);
 }
 
+void HPackCompressor::UserMetadataIndex::SetIndexedKeys(
+    absl::string_view keys) {
+  indexed_keys_.clear();
+  for (absl::string_view key :
+       absl::StrSplit(keys, ',', absl::SkipWhitespace())) {
+    indexed_keys_.emplace_back(
+        absl::AsciiStrToLower(absl::StripAsciiWhitespace(key)));
+  }
+}
+
+void HPackCompressor::UserMetadataIndex::EmitTo(const Slice& key,
+                                                const Slice& value,
+                                                Framer* framer) {
+  auto& table = framer->compressor_->table_;
+  const absl::string_view key_view = key.as_string_view();
+  const size_t transport_length =
+      hpack_constants::SizeForEntry(key.length(), value.length());
+  // Only keys that opted in are indexed: an indexed value can be probed
+  // through the compression ratio, so secrets must stay literals (RFC 7541
+  // section 7.1.3), and credentials are never indexed even if listed. Keep
+  // user metadata to a quarter of the table so it can't flush the entries the
+  // dedicated encoders rely on.
+  if (std::find(indexed_keys_.begin(), indexed_keys_.end(), key_view) ==
+          indexed_keys_.end() ||
+      transport_length > table.max_size() / 4 ||
+      transport_length > HPackEncoderTable::MaxEntrySize() ||
+      key_view == "authorization" || key_view == "proxy-authorization" ||
+      key_view == "cookie") {
+    framer->EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    return;
+  }
+  Key& k = keys_[absl::Hash<absl::string_view>()(key_view) % kNumKeys];
+  Pair& p = pairs_[absl::Hash<std::pair<absl::string_view, absl::string_view>>()(
+                       {key_view, value.as_string_view()}) %
+                   kNumPairs];
+  if (p.key == key && p.value == value) {
+    if (table.ConvertableToDynamicIndex(p.index)) {
+      framer->EmitIndexed(table.DynamicIndex(p.index));
+    } else {
+      // Seen before on this connection: it's worth a table entry.
+      p.index = table.AllocateIndex(transport_length);
+      framer->EmitLitHdrWithNonBinaryStringKeyIncIdx(key.Ref(), value.Ref());
+      if (p.index != 0) {
+        k.key = key.Ref();
+        k.index = p.index;
+      }
+    }
+    if (p.hits < kMaxHits) ++p.hits;
+    return;
+  }
+  // A new pair only takes over the slot once the incumbent's count has been
+  // worn down.
+  if (p.hits > 0) {
+    --p.hits;
+  } else {
+    p.key = key.Ref();
+    p.value = value.Ref();
+    p.index = 0;
+    p.hits = 1;
+  }
+  if (k.key == key && table.ConvertableToDynamicIndex(k.index)) {
+    framer->EmitLitHdrWithNonBinaryStringKeyNotIdx(table.DynamicIndex(k.index),
+                                                   value.Ref());
+  } else {
+    framer->EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+  }
+}
+
 void HPackCompressor::Framer::Encode(const Slice& key, const Slice& value) {
   if (absl::EndsWith(key.as_string_view(), "-bin")) {
     EmitLitHdrWithBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+  } else if (IsHpackAdaptiveIndexingEnabled()) {
+    compressor_->user_metadata_index_.EmitTo(key, value, this);
   } else {
     EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
   }
@@ -24,6 +24,7 @@
 #include <stddef.h>
 
 #include <cstdint>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -50,6 +51,7 @@ namespace grpc_core {
 
 class HPackCompressor {
   class SliceIndex;
+  class UserMetadataIndex;
 
  public:
   HPackCompressor() = default;
@@ -60,6 +62,12 @@ class HPackCompressor {
 
   void SetMaxTableSize(uint32_t max_table_size);
   void SetMaxUsableSize(uint32_t max_table_size);
+  // Sets the user metadata keys that may be indexed when the
+  // hpack_adaptive_indexing experiment is enabled, from a comma-separated list
+  // (see GRPC_ARG_HTTP2_HPACK_INDEXED_METADATA_KEYS).
+  void SetIndexedMetadataKeys(absl::string_view keys) {
+    user_metadata_index_.SetIndexedKeys(keys);
+  }
 
   uint32_t test_only_table_size() const {
     return table_.test_only_table_size();
@@ -123,6 +131,7 @@ class HPackCompressor {
 
    private:
     friend class SliceIndex;
+    friend class UserMetadataIndex;
 
     struct FramePrefix {
       // index (in output_) of the header for the frame
@@ -148,6 +157,8 @@ class HPackCompressor {
                                              Slice value_slice);
     void EmitLitHdrWithNonBinaryStringKeyNotIdx(Slice key_slice,
                                                 Slice value_slice);
+    void EmitLitHdrWithNonBinaryStringKeyNotIdx(uint32_t key_index,
+                                                Slice value_slice);
 
     void EncodeAlwaysIndexed(uint32_t* index, absl::string_view key,
                              Slice value, uint32_t transport_length);
@@ -201,6 +212,39 @@ class HPackCompressor {
     std::vector<ValueIndex> values_;
   };
 
+  // Adaptive indexing for user metadata that has no dedicated encoder.
+  // Pairs are tracked in a small direct mapped table with a frequency count;
+  // a pair that keeps coming back on this connection is added to the HPACK
+  // table and subsequently sent as a single index. A colliding pair must
+  // outlast the incumbent's count before it takes over the slot, so one-off
+  // values can't evict hot ones. Pairs that have not (yet) earned an index
+  // still reuse an indexed copy of their key name when one is live.
+  class UserMetadataIndex {
+   public:
+    void SetIndexedKeys(absl::string_view keys);
+    void EmitTo(const Slice& key, const Slice& value, Framer* framer);
+
+   private:
+    static constexpr size_t kNumPairs = 64;
+    static constexpr size_t kNumKeys = 32;
+    static constexpr uint8_t kMaxHits = 8;
+
+    struct Pair {
+      Slice key;
+      Slice value;
+      uint32_t index = 0;
+      uint8_t hits = 0;
+    };
+    struct Key {
+      Slice key;
+      uint32_t index = 0;
+    };
+    // Keys that opted in to indexing; everything else is never indexed.
+    std::vector<std::string> indexed_keys_;
+    Pair pairs_[kNumPairs];
+    Key keys_[kNumKeys];
+  };
+
   struct PreviousTimeout {
     Timeout timeout;
     uint32_t index;
@@ -228,6 +272,7 @@ class HPackCompressor {
   Slice user_agent_;
   SliceIndex path_index_;
   SliceIndex authority_index_;
+  UserMetadataIndex user_metadata_index_;
   std::vector<PreviousTimeout> previous_timeouts_;
 };
 
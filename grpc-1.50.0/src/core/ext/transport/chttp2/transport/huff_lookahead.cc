@@ -0,0 +1,93 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/transport/chttp2/transport/huff_lookahead.h"
+
+#include <string.h>
+
+#include <grpc/support/log.h>
+
+#include "src/core/ext/transport/chttp2/transport/huffsyms.h"
+
+namespace grpc_core {
+
+namespace {
+
+// Find the symbol whose code starts at bit `start` (counting from the msb) of
+// the kLookaheadBits wide `window`, considering only codes that end inside
+// the window. Returns the code length, or 0 if no such code exists.
+int MatchShortCode(uint32_t window, int start, int lookahead_bits,
+                   uint16_t* sym) {
+  for (int s = 0; s < GRPC_CHTTP2_NUM_HUFFSYMS; s++) {
+    const int length = static_cast<int>(grpc_chttp2_huffsyms[s].length);
+    if (start + length > lookahead_bits) continue;
+    const uint32_t code = (window >> (lookahead_bits - start - length)) &
+                          ((1u << length) - 1);
+    if (code == grpc_chttp2_huffsyms[s].bits) {
+      *sym = static_cast<uint16_t>(s);
+      return length;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+const HuffLookaheadDecoder::Tables& HuffLookaheadDecoder::GetTables() {
+  static const Tables* tables = [] {
+    Tables* t = new Tables;
+    memset(t, 0, sizeof(*t));
+    // Canonical layout: within each length codes must be consecutive, which
+    // holds for the RFC 7541 table and lets long codes be resolved with one
+    // subtraction per candidate length.
+    uint16_t next = 0;
+    for (int length = 1; length <= kMaxCodeLength; length++) {
+      t->index[length] = next;
+      bool first = true;
+      for (int s = 0; s < GRPC_CHTTP2_NUM_HUFFSYMS; s++) {
+        if (static_cast<int>(grpc_chttp2_huffsyms[s].length) != length) {
+          continue;
+        }
+        if (first) {
+          t->first_code[length] = grpc_chttp2_huffsyms[s].bits;
+          first = false;
+        }
+        const uint32_t offset =
+            grpc_chttp2_huffsyms[s].bits - t->first_code[length];
+        GPR_ASSERT(offset == t->count[length]);
+        t->sorted_syms[next + offset] = static_cast<uint16_t>(s);
+        t->count[length]++;
+      }
+      next += t->count[length];
+    }
+    GPR_ASSERT(next == GRPC_CHTTP2_NUM_HUFFSYMS);
+    for (uint32_t i = 0; i < (1u << kLookaheadBits); i++) {
+      uint16_t sym0 = 0;
+      uint16_t sym1 = 0;
+      const int len0 = MatchShortCode(i, 0, kLookaheadBits, &sym0);
+      if (len0 == 0) continue;
+      const int len1 = MatchShortCode(i, len0, kLookaheadBits, &sym1);
+      // EOS is 30 bits long, so it never lands in this table.
+      GPR_ASSERT(sym0 < 256 && sym1 < 256);
+      t->lookahead[i] = sym0 | (sym1 << 8) | (len0 << 16) |
+                        ((len0 + len1) << 20) | ((len1 == 0 ? 1 : 2) << 24);
+    }
+    return t;
+  }();
+  return *tables;
+}
+
+}  // namespace grpc_core
@@ -0,0 +1,114 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_HUFF_LOOKAHEAD_H
+#define GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_HUFF_LOOKAHEAD_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace grpc_core {
+
+// Table driven HPACK huffman decoder that resolves up to two symbols per
+// lookup.
+// The top kLookaheadBits of the input select an entry that records which
+// symbols are completely contained in those bits, so the common short codes
+// (5-8 bits, which cover nearly all of the header alphabet) decode two at a
+// time. Codes longer than kLookaheadBits fall back to a canonical code walk.
+//
+// Behaves exactly like the original nibble state machine: trailing bits that
+// do not form a complete symbol are ignored, and EOS codes in the stream are
+// skipped rather than emitted.
+class HuffLookaheadDecoder {
+ public:
+  static constexpr int kLookaheadBits = 12;
+
+  template <typename Out>
+  static void Decode(const uint8_t* begin, const uint8_t* end, Out output) {
+    const Tables& tables = GetTables();
+    // Bits are kept msb-aligned in buffer; only the top buffer_len are valid.
+    uint64_t buffer = 0;
+    int buffer_len = 0;
+    for (;;) {
+      while (buffer_len <= 56 && begin != end) {
+        buffer |= static_cast<uint64_t>(*begin++) << (56 - buffer_len);
+        buffer_len += 8;
+      }
+      if (buffer_len == 0) return;
+      uint32_t index = static_cast<uint32_t>(buffer >> (64 - kLookaheadBits));
+      if (buffer_len < kLookaheadBits) {
+        // Pad the tail with ones, as the encoder does; the length checks
+        // below stop us emitting anything that depends on the padding.
+        index |= (1u << (kLookaheadBits - buffer_len)) - 1;
+      }
+      const uint32_t entry = tables.lookahead[index];
+      const int nsyms = EntrySymbols(entry);
+      if (GPR_LIKELY(nsyms != 0)) {
+        const int len0 = EntryFirstLength(entry);
+        if (len0 > buffer_len) return;
+        output(static_cast<uint8_t>(entry));
+        int consumed = len0;
+        if (nsyms == 2 && EntryTotalLength(entry) <= buffer_len) {
+          output(static_cast<uint8_t>(entry >> 8));
+          consumed = EntryTotalLength(entry);
+        }
+        buffer <<= consumed;
+        buffer_len -= consumed;
+        continue;
+      }
+      // A code longer than the lookahead: walk the canonical code lengths.
+      int length = kLookaheadBits + 1;
+      for (; length <= kMaxCodeLength && length <= buffer_len; length++) {
+        const uint32_t code = static_cast<uint32_t>(buffer >> (64 - length));
+        const uint32_t offset = code - tables.first_code[length];
+        if (offset < tables.count[length]) {
+          const uint16_t sym = tables.sorted_syms[tables.index[length] + offset];
+          if (sym != 256) output(static_cast<uint8_t>(sym));
+          break;
+        }
+      }
+      if (length > kMaxCodeLength || length > buffer_len) return;
+      buffer <<= length;
+      buffer_len -= length;
+    }
+  }
+
+ private:
+  static constexpr int kMaxCodeLength = 30;
+
+  struct Tables {
+    // Per lookahead index: sym0 | sym1 << 8 | len0 << 16 | total_len << 20 |
+    // nsyms << 24. nsyms is 0 if the first code is longer than the
+    // lookahead.
+    uint32_t lookahead[1 << kLookaheadBits];
+    // Canonical code description, indexed by code length.
+    uint32_t first_code[kMaxCodeLength + 1];
+    uint32_t count[kMaxCodeLength + 1];
+    uint16_t index[kMaxCodeLength + 1];
+    // All symbols ordered by (length, code).
+    uint16_t sorted_syms[257];
+  };
+
+  static int EntrySymbols(uint32_t entry) { return (entry >> 24) & 3; }
+  static int EntryFirstLength(uint32_t entry) { return (entry >> 16) & 0xf; }
+  static int EntryTotalLength(uint32_t entry) { return (entry >> 20) & 0xf; }
+
+  static const Tables& GetTables();
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_EXT_TRANSPORT_CHTTP2_TRANSPORT_HUFF_LOOKAHEAD_H
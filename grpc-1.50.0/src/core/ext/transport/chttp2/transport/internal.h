@@ -128,6 +128,7 @@ typedef enum {
   GRPC_CHTTP2_INITIATE_WRITE_TRANSPORT_FLOW_CONTROL_UNSTALLED,
   GRPC_CHTTP2_INITIATE_WRITE_PING_RESPONSE,
   GRPC_CHTTP2_INITIATE_WRITE_FORCE_RST_STREAM,
+  GRPC_CHTTP2_INITIATE_WRITE_COALESCE_DEADLINE,
 } grpc_chttp2_initiate_write_reason;
 
 const char* grpc_chttp2_initiate_write_reason_string(
@@ -308,6 +309,19 @@ struct grpc_chttp2_transport {
    */
   uint32_t write_buffer_size = grpc_core::chttp2::kDefaultWindow;
 
+  /** write coalescing: how long a write for stream data may be held while
+      idle, or zero if coalescing is disabled */
+  grpc_core::Duration write_coalesce_delay;
+  /** flush a held write once this many message bytes are waiting */
+  size_t write_coalesce_bytes = 0;
+  /** message bytes queued since the current write was held */
+  size_t write_coalesce_pending_bytes = 0;
+  /** is a write being held for coalescing? */
+  bool write_coalesce_held = false;
+  bool have_write_coalesce_timer = false;
+  grpc_timer write_coalesce_timer;
+  grpc_closure write_coalesce_timer_expired_locked;
+
   /** Set to a grpc_error object if a goaway frame is received. By default, set
    * to GRPC_ERROR_NONE */
   grpc_error_handle goaway_error = GRPC_ERROR_NONE;
@@ -347,6 +361,11 @@ struct grpc_chttp2_transport {
 
   /** parser for headers */
   grpc_core::HPackParser hpack_parser;
+  /** HEADER_TABLE_SIZE to advertise to the peer without memory pressure */
+  uint32_t hpack_decoder_table_size = 0;
+  /** shift applied to it under memory pressure; see
+      grpc_core::BufferShrinkShiftForMemoryPressure() */
+  int hpack_decoder_table_shrink_shift = 0;
   /** simple one shot parsers */
   union {
     grpc_chttp2_window_update_parser window_update;
@@ -297,6 +297,7 @@ class WriteContext {
           &t_->outbuf, grpc_chttp2_window_update_create(0, transport_announce,
                                                         &throwaway_stats));
       grpc_chttp2_reset_ping_clock(t_);
+      IncWindowUpdateWrites();
     }
   }
 
@@ -343,6 +344,7 @@ class WriteContext {
   void IncInitialMetadataWrites() { ++initial_metadata_writes_; }
   void IncWindowUpdateWrites() { ++flow_control_writes_; }
   void IncMessageWrites() { ++message_writes_; }
+  void IncDataFrames() { ++data_frames_; }
   void IncTrailingMetadataWrites() { ++trailing_metadata_writes_; }
 
   void NoteScheduledResults() { result_.early_results_scheduled = true; }
@@ -351,6 +353,11 @@ class WriteContext {
 
   grpc_chttp2_begin_write_result Result() {
     result_.writing = t_->outbuf.count > 0;
+    if (result_.writing) {
+      GRPC_STATS_INC_HTTP2_FRAMES_PER_WRITE(
+          initial_metadata_writes_ + data_frames_ + trailing_metadata_writes_ +
+          flow_control_writes_);
+    }
     return result_;
   }
 
@@ -363,6 +370,7 @@ class WriteContext {
   int initial_metadata_writes_ = 0;
   int trailing_metadata_writes_ = 0;
   int message_writes_ = 0;
+  int data_frames_ = 0;
   grpc_chttp2_begin_write_result result_ = {false, false, false};
 };
 
@@ -401,6 +409,7 @@ class DataSendContext {
                      s_->send_trailing_metadata->empty();
     grpc_chttp2_encode_data(s_->id, &s_->flow_controlled_buffer, send_bytes,
                             is_last_frame_, &s_->stats.outgoing, &t_->outbuf);
+    write_context_->IncDataFrames();
     sfc_upd_.SentData(send_bytes);
     s_->sending_bytes += send_bytes;
   }
@@ -0,0 +1,626 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/transport/shm/shm_endpoint.h"
+
+#ifdef GRPC_POSIX_SHM
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/strip.h"
+
+#include <grpc/slice.h>
+#include <grpc/slice_buffer.h>
+#include <grpc/support/log.h>
+
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/ref_counted.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/iomgr/closure.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/slice/slice_internal.h"
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "shm rings need address-free 64-bit atomics");
+
+namespace grpc_core {
+
+namespace {
+
+constexpr uint64_t kSegmentMagic = 0x314d485343505247;  // "GRPCSHM1"
+constexpr char kSegmentNamePrefix[] = "/grpc-shm-";
+
+enum : uint32_t { kSegmentOffered = 1, kSegmentAccepted = 2 };
+
+// Control words of one ring. The producer advances head and the consumer
+// advances tail; each raises its waiting flag before blocking on the doorbell
+// and the other side clears it and rings. Head and tail live on separate
+// cache lines so the two sides do not false-share.
+struct RingControl {
+  alignas(64) std::atomic<uint64_t> head;
+  std::atomic<uint32_t> consumer_waiting;
+  alignas(64) std::atomic<uint64_t> tail;
+  std::atomic<uint32_t> producer_waiting;
+};
+
+struct SegmentHeader {
+  uint64_t magic;
+  uint32_t ring_size;
+  std::atomic<uint32_t> state;
+  RingControl rings[2];
+};
+
+constexpr size_t kHeaderSize = (sizeof(SegmentHeader) + 63) & ~size_t{63};
+
+SegmentHeader* Header(void* base) { return static_cast<SegmentHeader*>(base); }
+
+bool IsValidRingSize(uint64_t size) {
+  return size >= ShmSegment::kMinRingSize &&
+         size <= ShmSegment::kMaxRingSize && (size & (size - 1)) == 0;
+}
+
+absl::Status ErrnoStatus(const char* call) {
+  return absl::InternalError(absl::StrCat(call, ": ", strerror(errno)));
+}
+
+}  // namespace
+
+//
+// ShmSegment
+//
+
+absl::StatusOr<ShmSegment> ShmSegment::Create(uint32_t ring_size) {
+  GPR_ASSERT(IsValidRingSize(ring_size));
+  absl::BitGen bitgen;
+  std::string name = absl::StrFormat("%s%d-%016" PRIx64, kSegmentNamePrefix,
+                                     getpid(), absl::Uniform<uint64_t>(bitgen));
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd < 0) return ErrnoStatus("shm_open");
+  size_t size = kHeaderSize + 2 * static_cast<size_t>(ring_size);
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    absl::Status status = ErrnoStatus("ftruncate");
+    close(fd);
+    shm_unlink(name.c_str());
+    return status;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    absl::Status status = ErrnoStatus("mmap");
+    shm_unlink(name.c_str());
+    return status;
+  }
+  SegmentHeader* header = new (base) SegmentHeader();
+  header->magic = kSegmentMagic;
+  header->ring_size = ring_size;
+  for (RingControl& ring : header->rings) {
+    ring.head.store(0, std::memory_order_relaxed);
+    ring.tail.store(0, std::memory_order_relaxed);
+    ring.consumer_waiting.store(0, std::memory_order_relaxed);
+    ring.producer_waiting.store(0, std::memory_order_relaxed);
+  }
+  header->state.store(kSegmentOffered, std::memory_order_release);
+  return ShmSegment(std::move(name), base, size, ring_size);
+}
+
+absl::StatusOr<ShmSegment> ShmSegment::Open(absl::string_view name,
+                                            pid_t peer_pid, uid_t peer_uid) {
+  // Only attach to segments named the way Create() names them, by the process
+  // on the other end of the socket.
+  absl::string_view rest = name;
+  int name_pid;
+  if (name.size() > kMaxNameLength ||
+      !absl::ConsumePrefix(&rest, kSegmentNamePrefix) ||
+      rest.find('/') != absl::string_view::npos ||
+      rest.find('-') == absl::string_view::npos ||
+      !absl::SimpleAtoi(rest.substr(0, rest.find('-')), &name_pid)) {
+    return absl::InvalidArgumentError("invalid shm segment name");
+  }
+  if (name_pid != peer_pid) {
+    return absl::PermissionDeniedError(
+        "shm segment offered by another process");
+  }
+  std::string name_str(name);
+  int fd = shm_open(name_str.c_str(), O_RDWR, 0);
+  if (fd < 0) return ErrnoStatus("shm_open");
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    absl::Status status = ErrnoStatus("fstat");
+    close(fd);
+    return status;
+  }
+  // The segment is created with mode 0600, so it must belong to the peer.
+  if (st.st_uid != peer_uid || st.st_size < static_cast<off_t>(kHeaderSize)) {
+    close(fd);
+    return absl::PermissionDeniedError("unexpected shm segment");
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return ErrnoStatus("mmap");
+  SegmentHeader* header = Header(base);
+  // Read the ring size exactly once; the peer can change the header under us.
+  const uint32_t ring_size =
+      *static_cast<volatile uint32_t*>(&header->ring_size);
+  ShmSegment segment(std::move(name_str), base, size, ring_size);
+  uint32_t expected = kSegmentOffered;
+  if (header->magic != kSegmentMagic || !IsValidRingSize(ring_size) ||
+      size != kHeaderSize + 2 * static_cast<size_t>(ring_size) ||
+      !header->state.compare_exchange_strong(expected, kSegmentAccepted,
+                                             std::memory_order_acq_rel)) {
+    return absl::InvalidArgumentError("shm segment is not on offer");
+  }
+  return std::move(segment);
+}
+
+ShmSegment::ShmSegment(ShmSegment&& other) noexcept
+    : name_(std::move(other.name_)),
+      unlinked_(other.unlinked_),
+      base_(other.base_),
+      size_(other.size_),
+      ring_size_(other.ring_size_) {
+  other.base_ = nullptr;
+  other.size_ = 0;
+  other.ring_size_ = 0;
+}
+
+ShmSegment& ShmSegment::operator=(ShmSegment&& other) noexcept {
+  std::swap(name_, other.name_);
+  std::swap(unlinked_, other.unlinked_);
+  std::swap(base_, other.base_);
+  std::swap(size_, other.size_);
+  std::swap(ring_size_, other.ring_size_);
+  return *this;
+}
+
+ShmSegment::~ShmSegment() {
+  if (base_ != nullptr) munmap(base_, size_);
+}
+
+void ShmSegment::Unlink() {
+  if (unlinked_ || name_.empty()) return;
+  unlinked_ = true;
+  // The peer may already have removed it.
+  shm_unlink(name_.c_str());
+}
+
+namespace {
+
+// Upper bound on the bytes handed to a single read callback.
+constexpr size_t kMaxReadSize = 256 * 1024;
+
+struct Ring {
+  RingControl* control;
+  uint8_t* data;
+  uint64_t size;
+
+  void CopyIn(uint64_t pos, const uint8_t* src, size_t n) const {
+    size_t offset = static_cast<size_t>(pos & (size - 1));
+    size_t first = std::min<size_t>(n, size - offset);
+    memcpy(data + offset, src, first);
+    memcpy(data, src + first, n - first);
+  }
+
+  void CopyOut(uint64_t pos, uint8_t* dst, size_t n) const {
+    size_t offset = static_cast<size_t>(pos & (size - 1));
+    size_t first = std::min<size_t>(n, size - offset);
+    memcpy(dst, data + offset, first);
+    memcpy(dst + first, data, n - first);
+  }
+};
+
+// Doorbell operations decided under the endpoint lock and started after it
+// is released, since the wrapped endpoint may run callbacks inline.
+struct DoorbellOps {
+  bool read = false;
+  bool write = false;
+};
+
+class ShmEndpoint {
+ public:
+  ShmEndpoint(grpc_endpoint* doorbell, ShmSegment segment, bool is_client);
+  ~ShmEndpoint();
+
+  grpc_endpoint* base() { return &base_; }
+
+  static const grpc_endpoint_vtable kVtable;
+
+ private:
+  static ShmEndpoint* FromBase(grpc_endpoint* ep) {
+    return reinterpret_cast<ShmEndpoint*>(ep);
+  }
+
+  static void ReadFn(grpc_endpoint* ep, grpc_slice_buffer* slices,
+                     grpc_closure* cb, bool /*urgent*/,
+                     int /*min_progress_size*/) {
+    FromBase(ep)->Read(slices, cb);
+  }
+  static void WriteFn(grpc_endpoint* ep, grpc_slice_buffer* slices,
+                      grpc_closure* cb, void* /*arg*/,
+                      int /*max_frame_size*/) {
+    FromBase(ep)->Write(slices, cb);
+  }
+  static void AddToPollsetFn(grpc_endpoint* ep, grpc_pollset* pollset) {
+    grpc_endpoint_add_to_pollset(FromBase(ep)->doorbell_, pollset);
+  }
+  static void AddToPollsetSetFn(grpc_endpoint* ep, grpc_pollset_set* pollset) {
+    grpc_endpoint_add_to_pollset_set(FromBase(ep)->doorbell_, pollset);
+  }
+  static void DeleteFromPollsetSetFn(grpc_endpoint* ep,
+                                     grpc_pollset_set* pollset) {
+    grpc_endpoint_delete_from_pollset_set(FromBase(ep)->doorbell_, pollset);
+  }
+  static void ShutdownFn(grpc_endpoint* ep, grpc_error_handle why) {
+    FromBase(ep)->Shutdown(why);
+  }
+  static void DestroyFn(grpc_endpoint* ep) { FromBase(ep)->Destroy(); }
+  // Peer and local addresses are those of the Unix socket, so local
+  // credentials see a UDS connection.
+  static absl::string_view GetPeerFn(grpc_endpoint* ep) {
+    return grpc_endpoint_get_peer(FromBase(ep)->doorbell_);
+  }
+  static absl::string_view GetLocalAddressFn(grpc_endpoint* ep) {
+    return grpc_endpoint_get_local_address(FromBase(ep)->doorbell_);
+  }
+  static int GetFdFn(grpc_endpoint* /*ep*/) { return -1; }
+  static bool CanTrackErrFn(grpc_endpoint* /*ep*/) { return false; }
+
+  static void OnDoorbellRead(void* arg, grpc_error_handle error);
+  static void OnDoorbellWritten(void* arg, grpc_error_handle error);
+
+  void Read(grpc_slice_buffer* slices, grpc_closure* cb);
+  void Write(grpc_slice_buffer* slices, grpc_closure* cb);
+  void Shutdown(grpc_error_handle why);
+  void Destroy();
+
+  void Ref() { refs_.Ref(); }
+  void Unref() {
+    if (refs_.Unref()) delete this;
+  }
+
+  // Completes whatever pending read and write can make progress and arms a
+  // doorbell read if either still has to wait for the peer.
+  void ProgressLocked(DoorbellOps* ops) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool TryReadLocked(DoorbellOps* ops) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool TryWriteLocked(DoorbellOps* ops) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RingDoorbellLocked(DoorbellOps* ops) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void SetErrorLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void StartDoorbellOps(const DoorbellOps& ops);
+
+  grpc_endpoint base_;
+  grpc_endpoint* const doorbell_;
+  ShmSegment segment_;
+  RefCount refs_;
+  Ring tx_;
+  Ring rx_;
+  grpc_closure on_doorbell_read_;
+  grpc_closure on_doorbell_written_;
+
+  Mutex mu_;
+  // Our own ring positions; the copies in shared memory are only published.
+  uint64_t tx_head_ ABSL_GUARDED_BY(mu_) = 0;
+  uint64_t rx_tail_ ABSL_GUARDED_BY(mu_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
+  // Set once the doorbell socket fails or the peer corrupts a ring.
+  grpc_error_handle error_ ABSL_GUARDED_BY(mu_) = GRPC_ERROR_NONE;
+  grpc_closure* read_cb_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_slice_buffer* read_slices_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_closure* write_cb_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_slice_buffer* write_slices_ ABSL_GUARDED_BY(mu_) = nullptr;
+  size_t write_index_ ABSL_GUARDED_BY(mu_) = 0;
+  size_t write_offset_ ABSL_GUARDED_BY(mu_) = 0;
+  bool doorbell_read_pending_ ABSL_GUARDED_BY(mu_) = false;
+  bool doorbell_write_pending_ ABSL_GUARDED_BY(mu_) = false;
+  // Another doorbell was requested while one was in flight.
+  bool doorbell_write_needed_ ABSL_GUARDED_BY(mu_) = false;
+  grpc_slice_buffer doorbell_in_;
+  grpc_slice_buffer doorbell_out_;
+};
+
+const grpc_endpoint_vtable ShmEndpoint::kVtable = {
+    ShmEndpoint::ReadFn,
+    ShmEndpoint::WriteFn,
+    ShmEndpoint::AddToPollsetFn,
+    ShmEndpoint::AddToPollsetSetFn,
+    ShmEndpoint::DeleteFromPollsetSetFn,
+    ShmEndpoint::ShutdownFn,
+    ShmEndpoint::DestroyFn,
+    ShmEndpoint::GetPeerFn,
+    ShmEndpoint::GetLocalAddressFn,
+    ShmEndpoint::GetFdFn,
+    ShmEndpoint::CanTrackErrFn};
+
+ShmEndpoint::ShmEndpoint(grpc_endpoint* doorbell, ShmSegment segment,
+                         bool is_client)
+    : doorbell_(doorbell), segment_(std::move(segment)) {
+  base_.vtable = &kVtable;
+  SegmentHeader* header = Header(segment_.base());
+  uint8_t* data = static_cast<uint8_t*>(segment_.base()) + kHeaderSize;
+  uint64_t ring_size = segment_.ring_size();
+  Ring rings[2] = {{&header->rings[0], data, ring_size},
+                   {&header->rings[1], data + ring_size, ring_size}};
+  tx_ = rings[is_client ? 0 : 1];
+  rx_ = rings[is_client ? 1 : 0];
+  GRPC_CLOSURE_INIT(&on_doorbell_read_, OnDoorbellRead, this,
+                    grpc_schedule_on_exec_ctx);
+  GRPC_CLOSURE_INIT(&on_doorbell_written_, OnDoorbellWritten, this,
+                    grpc_schedule_on_exec_ctx);
+  grpc_slice_buffer_init(&doorbell_in_);
+  grpc_slice_buffer_init(&doorbell_out_);
+}
+
+ShmEndpoint::~ShmEndpoint() {
+  grpc_endpoint_destroy(doorbell_);
+  grpc_slice_buffer_destroy_internal(&doorbell_in_);
+  grpc_slice_buffer_destroy_internal(&doorbell_out_);
+  GRPC_ERROR_UNREF(error_);
+}
+
+void ShmEndpoint::SetErrorLocked(grpc_error_handle error) {
+  if (GRPC_ERROR_IS_NONE(error_)) {
+    error_ = error;
+  } else {
+    GRPC_ERROR_UNREF(error);
+  }
+}
+
+bool ShmEndpoint::TryReadLocked(DoorbellOps* ops) {
+  uint64_t available =
+      rx_.control->head.load(std::memory_order_acquire) - rx_tail_;
+  if (available == 0) {
+    // Announce that we are about to wait, then look again so that a write
+    // racing with the announcement is not missed.
+    rx_.control->consumer_waiting.store(1, std::memory_order_seq_cst);
+    available = rx_.control->head.load(std::memory_order_seq_cst) - rx_tail_;
+    if (available == 0) return false;
+    rx_.control->consumer_waiting.store(0, std::memory_order_relaxed);
+  }
+  if (available > rx_.size) {
+    SetErrorLocked(
+        GRPC_ERROR_CREATE_FROM_STATIC_STRING("shm ring head out of range"));
+    return false;
+  }
+  size_t n = static_cast<size_t>(std::min<uint64_t>(available, kMaxReadSize));
+  grpc_slice slice = GRPC_SLICE_MALLOC(n);
+  rx_.CopyOut(rx_tail_, GRPC_SLICE_START_PTR(slice), n);
+  grpc_slice_buffer_add(read_slices_, slice);
+  rx_tail_ += n;
+  rx_.control->tail.store(rx_tail_, std::memory_order_seq_cst);
+  if (rx_.control->producer_waiting.load(std::memory_order_seq_cst) != 0 &&
+      rx_.control->producer_waiting.exchange(0, std::memory_order_seq_cst) !=
+          0) {
+    RingDoorbellLocked(ops);
+  }
+  return true;
+}
+
+bool ShmEndpoint::TryWriteLocked(DoorbellOps* ops) {
+  while (write_index_ < write_slices_->count) {
+    uint64_t used = tx_head_ - tx_.control->tail.load(std::memory_order_acquire);
+    if (used == tx_.size) {
+      tx_.control->producer_waiting.store(1, std::memory_order_seq_cst);
+      used = tx_head_ - tx_.control->tail.load(std::memory_order_seq_cst);
+      if (used == tx_.size) return false;
+      tx_.control->producer_waiting.store(0, std::memory_order_relaxed);
+    }
+    if (used > tx_.size) {
+      SetErrorLocked(
+          GRPC_ERROR_CREATE_FROM_STATIC_STRING("shm ring tail out of range"));
+      return false;
+    }
+    uint64_t space = tx_.size - used;
+    while (space > 0 && write_index_ < write_slices_->count) {
+      const grpc_slice& slice = write_slices_->slices[write_index_];
+      size_t n = std::min<size_t>(GRPC_SLICE_LENGTH(slice) - write_offset_,
+                                  static_cast<size_t>(space));
+      tx_.CopyIn(tx_head_, GRPC_SLICE_START_PTR(slice) + write_offset_, n);
+      tx_head_ += n;
+      space -= n;
+      write_offset_ += n;
+      if (write_offset_ == GRPC_SLICE_LENGTH(slice)) {
+        ++write_index_;
+        write_offset_ = 0;
+      }
+    }
+    tx_.control->head.store(tx_head_, std::memory_order_seq_cst);
+    if (tx_.control->consumer_waiting.load(std::memory_order_seq_cst) != 0 &&
+        tx_.control->consumer_waiting.exchange(0, std::memory_order_seq_cst) !=
+            0) {
+      RingDoorbellLocked(ops);
+    }
+  }
+  return true;
+}
+
+void ShmEndpoint::RingDoorbellLocked(DoorbellOps* ops) {
+  if (!GRPC_ERROR_IS_NONE(error_)) return;
+  if (doorbell_write_pending_) {
+    doorbell_write_needed_ = true;
+    return;
+  }
+  doorbell_write_pending_ = true;
+  grpc_slice_buffer_add(&doorbell_out_, grpc_slice_from_static_string("!"));
+  Ref();
+  ops->write = true;
+}
+
+void ShmEndpoint::ProgressLocked(DoorbellOps* ops) {
+  if (read_cb_ != nullptr) {
+    // Data the peer wrote before going away is still delivered.
+    if (TryReadLocked(ops)) {
+      ExecCtx::Run(DEBUG_LOCATION, std::exchange(read_cb_, nullptr),
+                   GRPC_ERROR_NONE);
+    } else if (!GRPC_ERROR_IS_NONE(error_)) {
+      ExecCtx::Run(DEBUG_LOCATION, std::exchange(read_cb_, nullptr),
+                   GRPC_ERROR_REF(error_));
+    }
+  }
+  if (write_cb_ != nullptr) {
+    if (GRPC_ERROR_IS_NONE(error_) && TryWriteLocked(ops)) {
+      ExecCtx::Run(DEBUG_LOCATION, std::exchange(write_cb_, nullptr),
+                   GRPC_ERROR_NONE);
+    } else if (!GRPC_ERROR_IS_NONE(error_)) {
+      ExecCtx::Run(DEBUG_LOCATION, std::exchange(write_cb_, nullptr),
+                   GRPC_ERROR_REF(error_));
+    }
+  }
+  if ((read_cb_ != nullptr || write_cb_ != nullptr) &&
+      !doorbell_read_pending_) {
+    doorbell_read_pending_ = true;
+    Ref();
+    ops->read = true;
+  }
+}
+
+void ShmEndpoint::StartDoorbellOps(const DoorbellOps& ops) {
+  if (ops.read) {
+    grpc_endpoint_read(doorbell_, &doorbell_in_, &on_doorbell_read_,
+                       /*urgent=*/true, /*min_progress_size=*/1);
+  }
+  if (ops.write) {
+    grpc_endpoint_write(doorbell_, &doorbell_out_, &on_doorbell_written_,
+                        nullptr, /*max_frame_size=*/INT_MAX);
+  }
+}
+
+void ShmEndpoint::OnDoorbellRead(void* arg, grpc_error_handle error) {
+  ShmEndpoint* ep = static_cast<ShmEndpoint*>(arg);
+  DoorbellOps ops;
+  {
+    MutexLock lock(&ep->mu_);
+    ep->doorbell_read_pending_ = false;
+    // The bytes carry no information beyond the wakeup itself.
+    grpc_slice_buffer_reset_and_unref_internal(&ep->doorbell_in_);
+    if (!GRPC_ERROR_IS_NONE(error)) ep->SetErrorLocked(GRPC_ERROR_REF(error));
+    ep->ProgressLocked(&ops);
+  }
+  ep->StartDoorbellOps(ops);
+  ep->Unref();
+}
+
+void ShmEndpoint::OnDoorbellWritten(void* arg, grpc_error_handle error) {
+  ShmEndpoint* ep = static_cast<ShmEndpoint*>(arg);
+  DoorbellOps ops;
+  {
+    MutexLock lock(&ep->mu_);
+    ep->doorbell_write_pending_ = false;
+    grpc_slice_buffer_reset_and_unref_internal(&ep->doorbell_out_);
+    if (!GRPC_ERROR_IS_NONE(error)) {
+      ep->SetErrorLocked(GRPC_ERROR_REF(error));
+      ep->ProgressLocked(&ops);
+    } else if (ep->doorbell_write_needed_) {
+      ep->doorbell_write_needed_ = false;
+      ep->RingDoorbellLocked(&ops);
+    }
+  }
+  ep->StartDoorbellOps(ops);
+  ep->Unref();
+}
+
+void ShmEndpoint::Read(grpc_slice_buffer* slices, grpc_closure* cb) {
+  DoorbellOps ops;
+  {
+    MutexLock lock(&mu_);
+    GPR_ASSERT(read_cb_ == nullptr);
+    grpc_slice_buffer_reset_and_unref_internal(slices);
+    if (shutdown_) {
+      ExecCtx::Run(DEBUG_LOCATION, cb, GRPC_ERROR_REF(error_));
+      return;
+    }
+    read_cb_ = cb;
+    read_slices_ = slices;
+    ProgressLocked(&ops);
+  }
+  StartDoorbellOps(ops);
+}
+
+void ShmEndpoint::Write(grpc_slice_buffer* slices, grpc_closure* cb) {
+  DoorbellOps ops;
+  {
+    MutexLock lock(&mu_);
+    GPR_ASSERT(write_cb_ == nullptr);
+    if (shutdown_) {
+      ExecCtx::Run(DEBUG_LOCATION, cb, GRPC_ERROR_REF(error_));
+      return;
+    }
+    write_cb_ = cb;
+    write_slices_ = slices;
+    write_index_ = 0;
+    write_offset_ = 0;
+    ProgressLocked(&ops);
+  }
+  StartDoorbellOps(ops);
+}
+
+void ShmEndpoint::Shutdown(grpc_error_handle why) {
+  {
+    MutexLock lock(&mu_);
+    if (!shutdown_) {
+      shutdown_ = true;
+      SetErrorLocked(GRPC_ERROR_REF(why));
+      if (read_cb_ != nullptr) {
+        ExecCtx::Run(DEBUG_LOCATION, std::exchange(read_cb_, nullptr),
+                     GRPC_ERROR_REF(error_));
+      }
+      if (write_cb_ != nullptr) {
+        ExecCtx::Run(DEBUG_LOCATION, std::exchange(write_cb_, nullptr),
+                     GRPC_ERROR_REF(error_));
+      }
+    }
+  }
+  // Fails any doorbell operation still in flight; each holds a ref, so the
+  // last one to complete frees the endpoint.
+  grpc_endpoint_shutdown(doorbell_, why);
+}
+
+void ShmEndpoint::Destroy() {
+  Shutdown(GRPC_ERROR_CREATE_FROM_STATIC_STRING("shm endpoint destroyed"));
+  Unref();
+}
+
+}  // namespace
+
+}  // namespace grpc_core
+
+grpc_endpoint* grpc_shm_endpoint_create(grpc_endpoint* doorbell,
+                                        grpc_core::ShmSegment segment,
+                                        bool is_client) {
+  auto* ep =
+      new grpc_core::ShmEndpoint(doorbell, std::move(segment), is_client);
+  return ep->base();
+}
+
+#endif  // GRPC_POSIX_SHM
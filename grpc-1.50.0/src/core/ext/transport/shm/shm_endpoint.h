@@ -0,0 +1,102 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_EXT_TRANSPORT_SHM_SHM_ENDPOINT_H
+#define GRPC_CORE_EXT_TRANSPORT_SHM_SHM_ENDPOINT_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+#include "src/core/lib/iomgr/endpoint.h"
+#include "src/core/lib/iomgr/port.h"
+
+#ifdef GRPC_POSIX_SHM
+
+namespace grpc_core {
+
+// A POSIX shared memory segment holding one single-producer/single-consumer
+// byte ring per direction. The client creates the segment and hands its name
+// to the server over the Unix socket the connection was made on; after that
+// both sides only touch the mapping.
+class ShmSegment {
+ public:
+  // Ring sizes are powers of two within these bounds.
+  static constexpr uint32_t kMinRingSize = 4 * 1024;
+  static constexpr uint32_t kMaxRingSize = 64 * 1024 * 1024;
+  static constexpr size_t kMaxNameLength = 64;
+
+  // Creates and maps a new segment with rings of ring_size bytes each.
+  static absl::StatusOr<ShmSegment> Create(uint32_t ring_size);
+  // Maps a segment offered by a peer and marks it accepted, so that a segment
+  // can be attached to at most one connection. peer_pid and peer_uid are the
+  // credentials of the socket the offer came in on: the segment must belong
+  // to peer_uid and carry peer_pid in its name, so that nobody can claim a
+  // segment another process offered on its own connection.
+  static absl::StatusOr<ShmSegment> Open(absl::string_view name,
+                                         pid_t peer_pid, uid_t peer_uid);
+
+  ShmSegment() = default;
+  ShmSegment(ShmSegment&& other) noexcept;
+  ShmSegment& operator=(ShmSegment&& other) noexcept;
+  ShmSegment(const ShmSegment&) = delete;
+  ShmSegment& operator=(const ShmSegment&) = delete;
+  ~ShmSegment();
+
+  // Removes the segment's name. The mapping stays valid until destruction.
+  void Unlink();
+
+  const std::string& name() const { return name_; }
+  void* base() const { return base_; }
+  // The ring size validated against the mapping when the segment was created
+  // or opened. The copy in the shared header is never trusted after that,
+  // since the peer can rewrite it at any time.
+  uint32_t ring_size() const { return ring_size_; }
+
+ private:
+  ShmSegment(std::string name, void* base, size_t size, uint32_t ring_size)
+      : name_(std::move(name)),
+        base_(base),
+        size_(size),
+        ring_size_(ring_size) {}
+
+  std::string name_;
+  bool unlinked_ = false;
+  void* base_ = nullptr;
+  size_t size_ = 0;
+  uint32_t ring_size_ = 0;
+};
+
+}  // namespace grpc_core
+
+// Creates an endpoint that carries bytes through the rings of segment and
+// uses doorbell, the Unix socket the segment was negotiated on, only to wake
+// a peer that is blocked on an empty or full ring. The client side writes the
+// first ring and reads the second; the server side does the opposite.
+// Takes ownership of doorbell and segment.
+grpc_endpoint* grpc_shm_endpoint_create(grpc_endpoint* doorbell,
+                                        grpc_core::ShmSegment segment,
+                                        bool is_client);
+
+#endif  // GRPC_POSIX_SHM
+
+#endif  // GRPC_CORE_EXT_TRANSPORT_SHM_SHM_ENDPOINT_H
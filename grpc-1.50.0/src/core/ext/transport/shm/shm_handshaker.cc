@@ -0,0 +1,411 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/transport/shm/shm_handshaker.h"
+
+#include "src/core/lib/iomgr/port.h"
+
+#ifdef GRPC_POSIX_SHM
+
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+#include <grpc/slice.h>
+#include <grpc/slice_buffer.h>
+#include <grpc/support/alloc.h>
+#include <grpc/support/log.h>
+
+#include "src/core/ext/transport/shm/shm_endpoint.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/iomgr/closure.h"
+#include "src/core/lib/iomgr/endpoint.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/iomgr_fwd.h"
+#include "src/core/lib/slice/slice_internal.h"
+#include "src/core/lib/transport/error_utils.h"
+#include "src/core/lib/transport/handshaker.h"
+#include "src/core/lib/transport/handshaker_factory.h"
+#include "src/core/lib/transport/handshaker_registry.h"
+
+namespace grpc_core {
+
+namespace {
+
+// The client opens with kOfferMagic, one length byte and the segment name;
+// the server maps the segment and answers with kAccept, or with kReject if it
+// cannot use the segment. Neither side sends anything else on the socket
+// until then. After kAccept the socket only carries doorbells; after kReject
+// the connection carries on over the socket as if it were plain UDS.
+constexpr char kOfferMagic[] = "GRPCSHM1";
+constexpr size_t kOfferMagicLength = sizeof(kOfferMagic) - 1;
+constexpr char kAccept = 'A';
+constexpr char kReject = 'R';
+constexpr uint32_t kRingSize = 1024 * 1024;
+
+class ShmHandshaker : public Handshaker {
+ public:
+  explicit ShmHandshaker(bool is_client) : is_client_(is_client) {
+    grpc_slice_buffer_init(&outgoing_);
+  }
+  void Shutdown(grpc_error_handle why) override;
+  void DoHandshake(grpc_tcp_server_acceptor* acceptor,
+                   grpc_closure* on_handshake_done,
+                   HandshakerArgs* args) override;
+  const char* name() const override { return "shm"; }
+
+ private:
+  ~ShmHandshaker() override;
+
+  static void OnReadDoneScheduler(void* arg, grpc_error_handle error);
+  static void OnReadDone(void* arg, grpc_error_handle error);
+  static void OnWriteDoneScheduler(void* arg, grpc_error_handle error);
+  static void OnWriteDone(void* arg, grpc_error_handle error);
+
+  grpc_error_handle SendOfferLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  grpc_error_handle OnBytesReceivedLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  grpc_error_handle OnOfferReceivedLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  absl::StatusOr<ShmSegment> OpenOfferedSegmentLocked(absl::string_view name)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Gives bytes that follow the handshake back to the next handshaker.
+  void ReturnBytesLocked(absl::string_view bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void StartReadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void StartWriteLocked(std::string bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FinishLocked(bool wrap_endpoint) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void HandshakeFailedLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void CleanupArgsForFailureLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const bool is_client_;
+  Mutex mu_;
+  bool is_shutdown_ ABSL_GUARDED_BY(mu_) = false;
+  HandshakerArgs* args_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_closure* on_handshake_done_ ABSL_GUARDED_BY(mu_) = nullptr;
+  // Endpoint and read buffer to destroy after a shutdown.
+  grpc_endpoint* endpoint_to_destroy_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_slice_buffer* read_buffer_to_destroy_ ABSL_GUARDED_BY(mu_) = nullptr;
+  // Bytes of the peer's message received so far.
+  std::string received_ ABSL_GUARDED_BY(mu_);
+  grpc_slice_buffer outgoing_ ABSL_GUARDED_BY(mu_);
+  ShmSegment segment_ ABSL_GUARDED_BY(mu_);
+  // Set on the server once it has answered an offer with kReject.
+  bool rejected_ ABSL_GUARDED_BY(mu_) = false;
+  grpc_closure on_read_done_;
+  grpc_closure on_write_done_;
+};
+
+ShmHandshaker::~ShmHandshaker() {
+  if (endpoint_to_destroy_ != nullptr) {
+    grpc_endpoint_destroy(endpoint_to_destroy_);
+  }
+  if (read_buffer_to_destroy_ != nullptr) {
+    grpc_slice_buffer_destroy_internal(read_buffer_to_destroy_);
+    gpr_free(read_buffer_to_destroy_);
+  }
+  grpc_slice_buffer_destroy_internal(&outgoing_);
+  // On failure the client still owns the name of the segment it offered.
+  segment_.Unlink();
+}
+
+void ShmHandshaker::CleanupArgsForFailureLocked() {
+  endpoint_to_destroy_ = args_->endpoint;
+  args_->endpoint = nullptr;
+  read_buffer_to_destroy_ = args_->read_buffer;
+  args_->read_buffer = nullptr;
+  args_->args = ChannelArgs();
+}
+
+void ShmHandshaker::HandshakeFailedLocked(grpc_error_handle error) {
+  if (GRPC_ERROR_IS_NONE(error)) {
+    error = GRPC_ERROR_CREATE_FROM_STATIC_STRING("Handshaker shutdown");
+  }
+  gpr_log(GPR_DEBUG, "shm handshake failed: %s",
+          grpc_error_std_string(error).c_str());
+  if (!is_shutdown_) {
+    grpc_endpoint_shutdown(args_->endpoint, GRPC_ERROR_REF(error));
+    CleanupArgsForFailureLocked();
+    is_shutdown_ = true;
+  }
+  ExecCtx::Run(DEBUG_LOCATION, std::exchange(on_handshake_done_, nullptr),
+               error);
+}
+
+void ShmHandshaker::FinishLocked(bool wrap_endpoint) {
+  if (wrap_endpoint) {
+    args_->endpoint = grpc_shm_endpoint_create(
+        args_->endpoint, std::move(segment_), is_client_);
+  }
+  ExecCtx::Run(DEBUG_LOCATION, std::exchange(on_handshake_done_, nullptr),
+               GRPC_ERROR_NONE);
+}
+
+void ShmHandshaker::StartReadLocked() {
+  Ref().release();  // Ref held by callback.
+  grpc_endpoint_read(
+      args_->endpoint, args_->read_buffer,
+      GRPC_CLOSURE_INIT(&on_read_done_, &ShmHandshaker::OnReadDoneScheduler,
+                        this, grpc_schedule_on_exec_ctx),
+      /*urgent=*/true, /*min_progress_size=*/1);
+}
+
+void ShmHandshaker::StartWriteLocked(std::string bytes) {
+  grpc_slice_buffer_reset_and_unref_internal(&outgoing_);
+  grpc_slice_buffer_add(&outgoing_, grpc_slice_from_cpp_string(std::move(bytes)));
+  Ref().release();  // Ref held by callback.
+  grpc_endpoint_write(
+      args_->endpoint, &outgoing_,
+      GRPC_CLOSURE_INIT(&on_write_done_, &ShmHandshaker::OnWriteDoneScheduler,
+                        this, grpc_schedule_on_exec_ctx),
+      nullptr, /*max_frame_size=*/INT_MAX);
+}
+
+void ShmHandshaker::ReturnBytesLocked(absl::string_view bytes) {
+  if (bytes.empty()) return;
+  grpc_slice_buffer_add(
+      args_->read_buffer,
+      grpc_slice_from_copied_buffer(bytes.data(), bytes.size()));
+}
+
+grpc_error_handle ShmHandshaker::SendOfferLocked() {
+  absl::StatusOr<ShmSegment> segment = ShmSegment::Create(kRingSize);
+  if (!segment.ok()) {
+    // Without an offer the server treats this as a plain UDS client.
+    gpr_log(GPR_INFO, "shm segment unavailable, using the socket: %s",
+            segment.status().ToString().c_str());
+    FinishLocked(/*wrap_endpoint=*/false);
+    return GRPC_ERROR_NONE;
+  }
+  segment_ = std::move(*segment);
+  std::string offer(kOfferMagic, kOfferMagicLength);
+  offer.push_back(static_cast<char>(segment_.name().size()));
+  offer.append(segment_.name());
+  StartWriteLocked(std::move(offer));
+  return GRPC_ERROR_NONE;
+}
+
+grpc_error_handle ShmHandshaker::OnBytesReceivedLocked() {
+  for (size_t i = 0; i < args_->read_buffer->count; i++) {
+    const grpc_slice& slice = args_->read_buffer->slices[i];
+    received_.append(reinterpret_cast<const char*>(GRPC_SLICE_START_PTR(slice)),
+                     GRPC_SLICE_LENGTH(slice));
+  }
+  grpc_slice_buffer_reset_and_unref_internal(args_->read_buffer);
+  if (is_client_) {
+    if (received_.empty()) {
+      StartReadLocked();
+      return GRPC_ERROR_NONE;
+    }
+    if (received_[0] == kReject) {
+      // The server could not use the segment, so the connection stays on the
+      // socket; whatever followed the reject is already HTTP/2.
+      gpr_log(GPR_INFO, "shm segment rejected by server, using the socket");
+      segment_.Unlink();
+      segment_ = ShmSegment();
+      ReturnBytesLocked(absl::string_view(received_).substr(1));
+      FinishLocked(/*wrap_endpoint=*/false);
+      return GRPC_ERROR_NONE;
+    }
+    if (received_[0] != kAccept) {
+      return GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+          "shm handshake: unexpected reply to the segment offer");
+    }
+    // Anything after the accept byte is a doorbell the server already rang;
+    // the rings themselves tell the endpoint whether there is data.
+    segment_.Unlink();
+    FinishLocked(/*wrap_endpoint=*/true);
+    return GRPC_ERROR_NONE;
+  }
+  return OnOfferReceivedLocked();
+}
+
+grpc_error_handle ShmHandshaker::OnOfferReceivedLocked() {
+  absl::string_view received(received_);
+  absl::string_view magic(kOfferMagic, kOfferMagicLength);
+  if (received.substr(0, magic.size()) !=
+      magic.substr(0, std::min(received.size(), magic.size()))) {
+    // Not an shm client: hand the bytes back so that the connection proceeds
+    // over the socket.
+    grpc_slice_buffer_add(args_->read_buffer,
+                          grpc_slice_from_cpp_string(std::move(received_)));
+    FinishLocked(/*wrap_endpoint=*/false);
+    return GRPC_ERROR_NONE;
+  }
+  if (received.size() <= magic.size() ||
+      received.size() < magic.size() + 1 +
+                            static_cast<uint8_t>(received[magic.size()])) {
+    StartReadLocked();
+    return GRPC_ERROR_NONE;
+  }
+  size_t name_length = static_cast<uint8_t>(received[magic.size()]);
+  absl::string_view name = received.substr(magic.size() + 1, name_length);
+  absl::StatusOr<ShmSegment> segment = OpenOfferedSegmentLocked(name);
+  if (!segment.ok()) {
+    // The client waits for the answer, so it has not sent anything else yet.
+    gpr_log(GPR_INFO, "rejecting shm segment %s: %s",
+            std::string(name).c_str(), segment.status().ToString().c_str());
+    rejected_ = true;
+    StartWriteLocked(std::string(1, kReject));
+    return GRPC_ERROR_NONE;
+  }
+  segment_ = std::move(*segment);
+  segment_.Unlink();
+  StartWriteLocked(std::string(1, kAccept));
+  return GRPC_ERROR_NONE;
+}
+
+absl::StatusOr<ShmSegment> ShmHandshaker::OpenOfferedSegmentLocked(
+    absl::string_view name) {
+  // Only the process on the other end of this socket may hand us a segment;
+  // segment names are visible to every local user.
+  int fd = grpc_endpoint_get_fd(args_->endpoint);
+  if (fd < 0) {
+    return absl::FailedPreconditionError("no socket to check the peer of");
+  }
+  struct ucred peer;
+  socklen_t peer_length = sizeof(peer);
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &peer, &peer_length) != 0) {
+    return absl::InternalError(
+        absl::StrCat("getsockopt(SO_PEERCRED): ", strerror(errno)));
+  }
+  return ShmSegment::Open(name, peer.pid, peer.uid);
+}
+
+void ShmHandshaker::OnReadDoneScheduler(void* arg, grpc_error_handle error) {
+  ShmHandshaker* h = static_cast<ShmHandshaker*>(arg);
+  ExecCtx::Run(DEBUG_LOCATION,
+               GRPC_CLOSURE_INIT(&h->on_read_done_, &ShmHandshaker::OnReadDone,
+                                 h, grpc_schedule_on_exec_ctx),
+               GRPC_ERROR_REF(error));
+}
+
+void ShmHandshaker::OnReadDone(void* arg, grpc_error_handle error) {
+  RefCountedPtr<ShmHandshaker> h(static_cast<ShmHandshaker*>(arg));
+  MutexLock lock(&h->mu_);
+  if (!GRPC_ERROR_IS_NONE(error) || h->is_shutdown_) {
+    h->HandshakeFailedLocked(GRPC_ERROR_CREATE_REFERENCING_FROM_STATIC_STRING(
+        "shm handshake read failed", &error, 1));
+    return;
+  }
+  error = h->OnBytesReceivedLocked();
+  if (!GRPC_ERROR_IS_NONE(error)) h->HandshakeFailedLocked(error);
+}
+
+void ShmHandshaker::OnWriteDoneScheduler(void* arg, grpc_error_handle error) {
+  ShmHandshaker* h = static_cast<ShmHandshaker*>(arg);
+  ExecCtx::Run(
+      DEBUG_LOCATION,
+      GRPC_CLOSURE_INIT(&h->on_write_done_, &ShmHandshaker::OnWriteDone, h,
+                        grpc_schedule_on_exec_ctx),
+      GRPC_ERROR_REF(error));
+}
+
+void ShmHandshaker::OnWriteDone(void* arg, grpc_error_handle error) {
+  RefCountedPtr<ShmHandshaker> h(static_cast<ShmHandshaker*>(arg));
+  MutexLock lock(&h->mu_);
+  if (!GRPC_ERROR_IS_NONE(error) || h->is_shutdown_) {
+    h->HandshakeFailedLocked(GRPC_ERROR_CREATE_REFERENCING_FROM_STATIC_STRING(
+        "shm handshake write failed", &error, 1));
+    return;
+  }
+  if (h->is_client_) {
+    h->StartReadLocked();
+  } else {
+    h->FinishLocked(/*wrap_endpoint=*/!h->rejected_);
+  }
+}
+
+void ShmHandshaker::Shutdown(grpc_error_handle why) {
+  MutexLock lock(&mu_);
+  // Once the handshake is done the endpoint belongs to the next handshaker.
+  if (!is_shutdown_ && on_handshake_done_ != nullptr) {
+    is_shutdown_ = true;
+    grpc_endpoint_shutdown(args_->endpoint, GRPC_ERROR_REF(why));
+    CleanupArgsForFailureLocked();
+  }
+  GRPC_ERROR_UNREF(why);
+}
+
+void ShmHandshaker::DoHandshake(grpc_tcp_server_acceptor* /*acceptor*/,
+                                grpc_closure* on_handshake_done,
+                                HandshakerArgs* args) {
+  MutexLock lock(&mu_);
+  args_ = args;
+  on_handshake_done_ = on_handshake_done;
+  grpc_error_handle error =
+      is_client_ ? SendOfferLocked() : OnBytesReceivedLocked();
+  if (!GRPC_ERROR_IS_NONE(error)) HandshakeFailedLocked(error);
+}
+
+//
+// ShmHandshakerFactory
+//
+
+class ShmHandshakerFactory : public HandshakerFactory {
+ public:
+  explicit ShmHandshakerFactory(bool is_client) : is_client_(is_client) {}
+  void AddHandshakers(const ChannelArgs& args,
+                      grpc_pollset_set* /*interested_parties*/,
+                      HandshakeManager* handshake_mgr) override {
+    if (args.GetBool(GRPC_ARG_SHM_TRANSPORT).value_or(false)) {
+      handshake_mgr->Add(MakeRefCounted<ShmHandshaker>(is_client_));
+    }
+  }
+  ~ShmHandshakerFactory() override = default;
+
+ private:
+  const bool is_client_;
+};
+
+}  // namespace
+
+void RegisterShmHandshakers(CoreConfiguration::Builder* builder) {
+  builder->handshaker_registry()->RegisterHandshakerFactory(
+      false /* at_start */, HANDSHAKER_CLIENT,
+      absl::make_unique<ShmHandshakerFactory>(/*is_client=*/true));
+  builder->handshaker_registry()->RegisterHandshakerFactory(
+      false /* at_start */, HANDSHAKER_SERVER,
+      absl::make_unique<ShmHandshakerFactory>(/*is_client=*/false));
+}
+
+}  // namespace grpc_core
+
+#else  // GRPC_POSIX_SHM
+
+namespace grpc_core {
+
+void RegisterShmHandshakers(CoreConfiguration::Builder* /*builder*/) {}
+
+}  // namespace grpc_core
+
+#endif  // GRPC_POSIX_SHM
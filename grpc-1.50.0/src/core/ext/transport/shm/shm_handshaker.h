@@ -0,0 +1,36 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_EXT_TRANSPORT_SHM_SHM_HANDSHAKER_H
+#define GRPC_CORE_EXT_TRANSPORT_SHM_SHM_HANDSHAKER_H
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/config/core_configuration.h"
+
+// Set by the unix-shm resolver on each address and by the server on unix-shm
+// listeners: once connected over the Unix socket, move the connection's bytes
+// onto a shared memory ring pair.
+#define GRPC_ARG_SHM_TRANSPORT "grpc.internal.shm_transport"
+
+namespace grpc_core {
+
+// Registers the client and server handshakers that set up the shared memory
+// rings. They run before the security handshakers, which then see an
+// endpoint whose addresses are those of the Unix socket.
+void RegisterShmHandshakers(CoreConfiguration::Builder* builder);
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_EXT_TRANSPORT_SHM_SHM_HANDSHAKER_H
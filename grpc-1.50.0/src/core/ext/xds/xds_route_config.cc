@@ -73,6 +73,7 @@
 #include "src/core/lib/gprpp/time.h"
 #include "src/core/lib/iomgr/error.h"
 #include "src/core/lib/matchers/matchers.h"
+#include "src/core/lib/matchers/regex_cache.h"
 
 namespace grpc_core {
 
@@ -141,22 +142,15 @@ XdsRouteConfigResource::Route::RouteAction::HashPolicy::HashPolicy(
     const HashPolicy& other)
     : type(other.type),
       header_name(other.header_name),
-      regex_substitution(other.regex_substitution) {
-  if (other.regex != nullptr) {
-    regex =
-        absl::make_unique<RE2>(other.regex->pattern(), other.regex->options());
-  }
-}
+      regex(other.regex),
+      regex_substitution(other.regex_substitution) {}
 
 XdsRouteConfigResource::Route::RouteAction::HashPolicy&
 XdsRouteConfigResource::Route::RouteAction::HashPolicy::operator=(
     const HashPolicy& other) {
   type = other.type;
   header_name = other.header_name;
-  if (other.regex != nullptr) {
-    regex =
-        absl::make_unique<RE2>(other.regex->pattern(), other.regex->options());
-  }
+  regex = other.regex;
   regex_substitution = other.regex_substitution;
   return *this;
 }
@@ -887,11 +881,8 @@ absl::StatusOr<XdsRouteConfigResource::Route::RouteAction> RouteActionParse(
               "missing");
           continue;
         }
-        RE2::Options options;
-        policy.regex = absl::make_unique<RE2>(
-            UpbStringToStdString(
-                envoy_type_matcher_v3_RegexMatcher_regex(regex_matcher)),
-            options);
+        policy.regex = RegexCache::Get(UpbStringToAbsl(
+            envoy_type_matcher_v3_RegexMatcher_regex(regex_matcher)));
         if (!policy.regex->ok()) {
           gpr_log(
               GPR_DEBUG,
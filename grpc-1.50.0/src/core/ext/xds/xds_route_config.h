@@ -107,7 +107,8 @@ struct XdsRouteConfigResource {
         bool terminal = false;
         // Fields used for type HEADER.
         std::string header_name;
-        std::unique_ptr<RE2> regex = nullptr;
+        // Shared by copies of the policy.
+        std::shared_ptr<const RE2> regex;
         std::string regex_substitution;
 
         HashPolicy() {}
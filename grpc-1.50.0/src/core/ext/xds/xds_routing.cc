@@ -151,6 +151,13 @@ bool HeadersMatch(const std::vector<HeaderMatcher>& header_matchers,
   return true;
 }
 
+// Below this many regex path matchers, running the regexes one at a time is
+// as fast as a set.
+constexpr size_t kMinRegexPathMatchersForSet = 4;
+// RE2's default memory budget fits a few thousand simple patterns per set;
+// stay well below it.
+constexpr size_t kMaxRegexesPerSet = 512;
+
 bool UnderFraction(const uint32_t fraction_per_million) {
   // Generate a random number in [0, 1000000).
   const uint32_t random_number = rand() % 1000000;
@@ -159,13 +166,76 @@ bool UnderFraction(const uint32_t fraction_per_million) {
 
 }  // namespace
 
+std::unique_ptr<XdsRouting::RegexPathMatcherSet>
+XdsRouting::RegexPathMatcherSet::Create(
+    const RouteListIterator& route_list_iterator) {
+  std::unique_ptr<RegexPathMatcherSet> matchers(new RegexPathMatcherSet());
+  for (size_t i = 0; i < route_list_iterator.Size(); ++i) {
+    const StringMatcher& path_matcher =
+        route_list_iterator.GetMatchersForRoute(i).path_matcher;
+    if (path_matcher.type() != StringMatcher::Type::kSafeRegex) continue;
+    if (matchers->route_indices_.size() % kMaxRegexesPerSet == 0) {
+      // StringMatcher compiles safe_regex patterns with the default options
+      // and matches them with RE2::FullMatch(); the sets do the same.
+      matchers->sets_.emplace_back(RE2::Options(), RE2::ANCHOR_BOTH);
+    }
+    if (matchers->sets_.back().Add(path_matcher.regex_matcher()->pattern(),
+                                   nullptr) < 0) {
+      return nullptr;
+    }
+    matchers->route_indices_.push_back(i);
+  }
+  if (matchers->route_indices_.size() < kMinRegexPathMatchersForSet) {
+    return nullptr;
+  }
+  for (RE2::Set& set : matchers->sets_) {
+    if (!set.Compile()) return nullptr;
+  }
+  return matchers;
+}
+
+bool XdsRouting::RegexPathMatcherSet::Match(
+    absl::string_view path, std::vector<size_t>* route_indices) const {
+  route_indices->clear();
+  std::vector<int> matches;
+  for (size_t i = 0; i < sets_.size(); ++i) {
+    RE2::Set::ErrorInfo error_info;
+    if (!sets_[i].Match(re2::StringPiece(path.data(), path.size()), &matches,
+                        &error_info)) {
+      if (error_info.kind != RE2::Set::kNoError) return false;
+      continue;
+    }
+    for (int match : matches) {
+      route_indices->push_back(route_indices_[i * kMaxRegexesPerSet + match]);
+    }
+  }
+  std::sort(route_indices->begin(), route_indices->end());
+  return true;
+}
+
 absl::optional<size_t> XdsRouting::GetRouteForRequest(
     const RouteListIterator& route_list_iterator, absl::string_view path,
-    grpc_metadata_batch* initial_metadata) {
+    grpc_metadata_batch* initial_metadata,
+    const RegexPathMatcherSet* regex_path_matchers) {
+  // Routes with a regex path matcher whose index is in regex_matches match
+  // the path; regex_matches is consumed in order as the routes are visited.
+  std::vector<size_t> regex_matches;
+  bool use_regex_set = regex_path_matchers != nullptr &&
+                       regex_path_matchers->Match(path, &regex_matches);
+  auto next_regex_match = regex_matches.begin();
   for (size_t i = 0; i < route_list_iterator.Size(); ++i) {
     const XdsRouteConfigResource::Route::Matchers& matchers =
         route_list_iterator.GetMatchersForRoute(i);
-    if (matchers.path_matcher.Match(path) &&
+    bool path_match;
+    if (use_regex_set && matchers.path_matcher.type() ==
+                             StringMatcher::Type::kSafeRegex) {
+      path_match = next_regex_match != regex_matches.end() &&
+                   *next_regex_match == i;
+      if (path_match) ++next_regex_match;
+    } else {
+      path_match = matchers.path_matcher.Match(path);
+    }
+    if (path_match &&
         HeadersMatch(matchers.header_matchers, initial_metadata) &&
         (!matchers.fraction_per_million.has_value() ||
          UnderFraction(*matchers.fraction_per_million))) {
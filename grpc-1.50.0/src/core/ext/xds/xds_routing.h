@@ -24,12 +24,14 @@
 #include <stddef.h>
 
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "re2/set.h"
 
 #include "src/core/ext/xds/xds_listener.h"
 #include "src/core/ext/xds/xds_route_config.h"
@@ -60,15 +62,46 @@ class XdsRouting {
         size_t index) const = 0;
   };
 
+  // Evaluates the safe_regex path matchers of a route list in a single pass
+  // over the request path per RE2::Set, instead of running each route's
+  // regex in turn. Built once per route list.
+  class RegexPathMatcherSet {
+   public:
+    // Returns null if the route list has too few regex path matchers for the
+    // set to pay off, or if the set fails to compile.
+    static std::unique_ptr<RegexPathMatcherSet> Create(
+        const RouteListIterator& route_list_iterator);
+
+    // Sets *route_indices to the indices of the routes whose regex path
+    // matcher matches path, in increasing order. Returns false if the set
+    // could not be evaluated (e.g., the DFA ran out of memory), in which case
+    // the caller must match the routes one at a time.
+    bool Match(absl::string_view path,
+               std::vector<size_t>* route_indices) const;
+
+   private:
+    RegexPathMatcherSet() = default;
+
+    // Each set holds up to kMaxRegexesPerSet regexes, so that large route
+    // lists stay within RE2's per-set memory budget.
+    std::vector<RE2::Set> sets_;
+    // Index in the route list of each regex, in the order they were added
+    // to sets_.
+    std::vector<size_t> route_indices_;
+  };
+
   // Returns the index of the selected virtual host in the list.
   static absl::optional<size_t> FindVirtualHostForDomain(
       const VirtualHostListIterator& vhost_iterator, absl::string_view domain);
 
   // Returns the index in route_list_iterator to use for a request with
   // the specified path and metadata, or nullopt if no route matches.
+  // If non-null, regex_path_matchers must have been created from the same
+  // route list.
   static absl::optional<size_t> GetRouteForRequest(
       const RouteListIterator& route_list_iterator, absl::string_view path,
-      grpc_metadata_batch* initial_metadata);
+      grpc_metadata_batch* initial_metadata,
+      const RegexPathMatcherSet* regex_path_matchers = nullptr);
 
   // Returns true if \a domain_pattern is a valid domain pattern, false
   // otherwise.
@@ -347,6 +347,7 @@ class XdsServerConfigFetcher::ListenerWatcher::FilterChainMatchManager::
 
     std::vector<std::string> domains;
     std::vector<Route> routes;
+    std::unique_ptr<XdsRouting::RegexPathMatcherSet> regex_path_matchers;
   };
 
   class VirtualHostListIterator : public XdsRouting::VirtualHostListIterator {
@@ -1171,6 +1172,8 @@ XdsServerConfigFetcher::ListenerWatcher::FilterChainMatchManager::
             ServiceConfigImpl::Create(result->args, json.c_str()).value();
       }
     }
+    virtual_host.regex_path_matchers = XdsRouting::RegexPathMatcherSet::Create(
+        VirtualHost::RouteListIterator(&virtual_host.routes));
   }
   return config_selector;
 }
@@ -1204,7 +1207,8 @@ ServerConfigSelector::CallConfig XdsServerConfigFetcher::ListenerWatcher::
   }
   auto& virtual_host = virtual_hosts_[vhost_index.value()];
   auto route_index = XdsRouting::GetRouteForRequest(
-      VirtualHost::RouteListIterator(&virtual_host.routes), path, metadata);
+      VirtualHost::RouteListIterator(&virtual_host.routes), path, metadata,
+      virtual_host.regex_path_matchers.get());
   if (route_index.has_value()) {
     auto& route = virtual_host.routes[route_index.value()];
     // Found the matching route
@@ -0,0 +1,219 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/channel/call_metrics.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/numeric/bits.h"
+
+#include <grpc/support/cpu.h>
+
+#include "src/core/lib/channel/status_util.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+
+namespace grpc_core {
+
+namespace {
+
+size_t BucketFor(uint64_t value) {
+  return std::min<size_t>(absl::bit_width(value),
+                          CallMetrics::kHistogramBuckets - 1);
+}
+
+Json HistogramJson(const uint64_t* buckets, uint64_t sum) {
+  uint64_t count = 0;
+  Json::Array nonzero;
+  for (size_t i = 0; i < CallMetrics::kHistogramBuckets; ++i) {
+    if (buckets[i] == 0) continue;
+    count += buckets[i];
+    // Upper bound (exclusive) of the bucket; the last one is open-ended.
+    Json::Object bucket = {{"count", std::to_string(buckets[i])}};
+    if (i + 1 < CallMetrics::kHistogramBuckets) {
+      bucket["lessThan"] = std::to_string(uint64_t(1) << i);
+    }
+    nonzero.emplace_back(std::move(bucket));
+  }
+  return Json::Object{
+      {"count", std::to_string(count)},
+      {"sum", std::to_string(sum)},
+      {"buckets", std::move(nonzero)},
+  };
+}
+
+}  // namespace
+
+//
+// CallMetrics::Histogram
+//
+
+void CallMetrics::Histogram::Add(uint64_t value) {
+  buckets_[BucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+}
+
+void CallMetrics::Histogram::MergeInto(uint64_t* buckets,
+                                       uint64_t* sum) const {
+  for (size_t i = 0; i < kHistogramBuckets; ++i) {
+    buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+  }
+  *sum += sum_.load(std::memory_order_relaxed);
+}
+
+//
+// CallMetrics
+//
+
+CallMetrics* CallMetrics::Get() {
+  static CallMetrics* metrics = new CallMetrics();
+  return metrics;
+}
+
+CallMetrics::CallMetrics()
+    : num_shards_(std::max(1u, gpr_cpu_num_cores())),
+      shards_(new Shard[num_shards_]) {}
+
+CallMetrics::Shard::~Shard() {
+  for (auto& slot : slots) delete slot.load(std::memory_order_relaxed);
+}
+
+// Returns the entry for method, or nullptr with *slot set to the empty slot
+// where it would be inserted.
+CallMetrics::MethodEntry* CallMetrics::FindMethod(const Shard& shard,
+                                                  absl::string_view method,
+                                                  size_t* slot) {
+  static_assert((kMethodSlots & (kMethodSlots - 1)) == 0,
+                "kMethodSlots must be a power of two");
+  size_t i = absl::Hash<absl::string_view>()(method) & (kMethodSlots - 1);
+  for (;;) {
+    MethodEntry* entry = shard.slots[i].load(std::memory_order_acquire);
+    if (entry == nullptr || entry->name == method) {
+      *slot = i;
+      return entry;
+    }
+    i = (i + 1) & (kMethodSlots - 1);
+  }
+}
+
+CallMetrics::MethodMetrics* CallMetrics::GetMethodMetrics(
+    Shard* shard, absl::string_view method) {
+  size_t slot;
+  MethodEntry* entry = FindMethod(*shard, method, &slot);
+  if (GPR_LIKELY(entry != nullptr)) return &entry->metrics;
+  // First call for this method on this shard.
+  MutexLock lock(&shard->mu);
+  entry = FindMethod(*shard, method, &slot);
+  if (entry == nullptr && shard->num_methods >= kMaxMethodsPerShard) {
+    method = "<other>";
+    entry = FindMethod(*shard, method, &slot);
+  }
+  if (entry == nullptr) {
+    entry = new MethodEntry(method);
+    shard->slots[slot].store(entry, std::memory_order_release);
+    ++shard->num_methods;
+  }
+  return &entry->metrics;
+}
+
+void CallMetrics::Record(const CallRecord& record) {
+  ExecCtx* exec_ctx = ExecCtx::Get();
+  unsigned cpu = exec_ctx != nullptr ? exec_ctx->starting_cpu()
+                                     : gpr_cpu_current_cpu();
+  Shard* shard = &shards_[cpu % num_shards_];
+  MethodMetrics* m = GetMethodMetrics(shard, record.method);
+  size_t status = static_cast<size_t>(record.status);
+  if (status >= kStatusCodes) status = GRPC_STATUS_UNKNOWN;
+  m->status[status].fetch_add(1, std::memory_order_relaxed);
+  m->retries[std::min<size_t>(record.retries, kRetryBuckets - 1)].fetch_add(
+      1, std::memory_order_relaxed);
+  if (record.transparent_retries != 0) {
+    m->transparent_retries.fetch_add(record.transparent_retries,
+                                     std::memory_order_relaxed);
+  }
+  m->latency_us.Add(record.latency_us);
+  m->request_bytes.Add(record.request_bytes);
+  m->response_bytes.Add(record.response_bytes);
+}
+
+Json CallMetrics::RenderJson() {
+  struct Totals {
+    uint64_t status[kStatusCodes] = {};
+    uint64_t retries[kRetryBuckets] = {};
+    uint64_t transparent_retries = 0;
+    uint64_t latency_us[kHistogramBuckets] = {};
+    uint64_t latency_us_sum = 0;
+    uint64_t request_bytes[kHistogramBuckets] = {};
+    uint64_t request_bytes_sum = 0;
+    uint64_t response_bytes[kHistogramBuckets] = {};
+    uint64_t response_bytes_sum = 0;
+  };
+  std::map<std::string, Totals> totals;
+  for (size_t i = 0; i < num_shards_; ++i) {
+    for (const auto& slot : shards_[i].slots) {
+      const MethodEntry* entry = slot.load(std::memory_order_acquire);
+      if (entry == nullptr) continue;
+      const MethodMetrics& m = entry->metrics;
+      Totals& t = totals[entry->name];
+      for (size_t j = 0; j < kStatusCodes; ++j) {
+        t.status[j] += m.status[j].load(std::memory_order_relaxed);
+      }
+      for (size_t j = 0; j < kRetryBuckets; ++j) {
+        t.retries[j] += m.retries[j].load(std::memory_order_relaxed);
+      }
+      t.transparent_retries +=
+          m.transparent_retries.load(std::memory_order_relaxed);
+      m.latency_us.MergeInto(t.latency_us, &t.latency_us_sum);
+      m.request_bytes.MergeInto(t.request_bytes, &t.request_bytes_sum);
+      m.response_bytes.MergeInto(t.response_bytes, &t.response_bytes_sum);
+    }
+  }
+  Json::Array methods;
+  for (const auto& p : totals) {
+    const Totals& t = p.second;
+    uint64_t calls = 0;
+    Json::Object status;
+    for (size_t j = 0; j < kStatusCodes; ++j) {
+      if (t.status[j] == 0) continue;
+      calls += t.status[j];
+      status[grpc_status_code_to_string(static_cast<grpc_status_code>(j))] =
+          std::to_string(t.status[j]);
+    }
+    Json::Array retries;
+    for (size_t j = 0; j < kRetryBuckets; ++j) {
+      retries.emplace_back(std::to_string(t.retries[j]));
+    }
+    methods.emplace_back(Json::Object{
+        {"method", p.first},
+        {"calls", std::to_string(calls)},
+        {"status", std::move(status)},
+        {"retries", std::move(retries)},
+        {"transparentRetries", std::to_string(t.transparent_retries)},
+        {"latencyUs", HistogramJson(t.latency_us, t.latency_us_sum)},
+        {"requestBytes", HistogramJson(t.request_bytes, t.request_bytes_sum)},
+        {"responseBytes",
+         HistogramJson(t.response_bytes, t.response_bytes_sum)},
+    });
+  }
+  return Json::Object{{"methods", std::move(methods)}};
+}
+
+}  // namespace grpc_core
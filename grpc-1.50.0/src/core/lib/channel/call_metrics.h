@@ -0,0 +1,131 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef GRPC_CORE_LIB_CHANNEL_CALL_METRICS_H
+#define GRPC_CORE_LIB_CHANNEL_CALL_METRICS_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+
+#include <grpc/status.h>
+
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/json/json.h"
+
+namespace grpc_core {
+
+// Process-wide per-method call metrics: status codes, latency, request and
+// response sizes, and retries. Calls are recorded by the call_metrics filter
+// on client channels created with GRPC_ARG_ENABLE_CALL_METRICS.
+//
+// Data is sharded per CPU. Each shard keeps its methods in an insert-only
+// open-addressed table, so recording a call for a method that the shard has
+// already seen takes no lock: the shard lock is only held to add a new
+// method. The counters themselves are relaxed atomics, so snapshots never
+// block recording.
+class CallMetrics {
+ public:
+  // Histograms use power-of-two buckets: bucket 0 counts zero, and bucket i
+  // counts values in [2^(i-1), 2^i). The last bucket also takes anything
+  // larger.
+  static constexpr size_t kHistogramBuckets = 32;
+  // Retries are counted exactly up to kRetryBuckets - 1; the last bucket
+  // takes anything larger.
+  static constexpr size_t kRetryBuckets = 8;
+  // Beyond this many distinct methods per shard, calls are recorded under
+  // the method name "<other>".
+  static constexpr size_t kMaxMethodsPerShard = 1024;
+  static constexpr size_t kStatusCodes = GRPC_STATUS_UNAUTHENTICATED + 1;
+
+  struct CallRecord {
+    absl::string_view method;
+    grpc_status_code status = GRPC_STATUS_OK;
+    uint64_t latency_us = 0;
+    uint64_t request_bytes = 0;
+    uint64_t response_bytes = 0;
+    uint32_t retries = 0;
+    uint32_t transparent_retries = 0;
+  };
+
+  static CallMetrics* Get();
+
+  void Record(const CallRecord& record);
+
+  // Merges all shards into a JSON object with one entry per method.
+  Json RenderJson();
+
+ private:
+  class Histogram {
+   public:
+    void Add(uint64_t value);
+    void MergeInto(uint64_t* buckets, uint64_t* sum) const;
+
+   private:
+    std::atomic<uint64_t> buckets_[kHistogramBuckets] = {};
+    std::atomic<uint64_t> sum_{0};
+  };
+
+  struct MethodMetrics {
+    std::atomic<uint64_t> status[kStatusCodes] = {};
+    std::atomic<uint64_t> retries[kRetryBuckets] = {};
+    std::atomic<uint64_t> transparent_retries{0};
+    Histogram latency_us;
+    Histogram request_bytes;
+    Histogram response_bytes;
+  };
+
+  struct MethodEntry {
+    explicit MethodEntry(absl::string_view name) : name(name) {}
+    const std::string name;
+    MethodMetrics metrics;
+  };
+
+  // Twice kMaxMethodsPerShard (plus "<other>"), so probes stay short and
+  // always reach an empty slot.
+  static constexpr size_t kMethodSlots = 2 * kMaxMethodsPerShard;
+
+  struct Shard {
+    ~Shard();
+    // Serializes inserts; lookups only read slots.
+    Mutex mu;
+    size_t num_methods ABSL_GUARDED_BY(mu) = 0;
+    // Entries are published with release stores and never removed or
+    // replaced, so a non-null slot can be read without the lock.
+    std::atomic<MethodEntry*> slots[kMethodSlots] = {};
+  };
+
+  CallMetrics();
+
+  static MethodEntry* FindMethod(const Shard& shard, absl::string_view method,
+                                 size_t* slot);
+  MethodMetrics* GetMethodMetrics(Shard* shard, absl::string_view method);
+
+  const size_t num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_LIB_CHANNEL_CALL_METRICS_H
@@ -307,6 +307,24 @@ Json ServerNode::RenderJson() {
   }
   // Ask CallCountingHelper to populate call count data.
   call_counter_.PopulateCallCounts(&data);
+  // Pending call queue depth and admission control counters. Like the call
+  // counts, these are only rendered when non-zero.
+  int64_t pending_calls = pending_calls_.load(std::memory_order_relaxed);
+  if (pending_calls != 0) {
+    data["pendingCalls"] = std::to_string(pending_calls);
+  }
+  int64_t calls_shed = calls_shed_queue_full_.load(std::memory_order_relaxed);
+  if (calls_shed != 0) {
+    data["callsShedQueueFull"] = std::to_string(calls_shed);
+  }
+  calls_shed = calls_shed_deadline_exceeded_.load(std::memory_order_relaxed);
+  if (calls_shed != 0) {
+    data["callsShedDeadlineExceeded"] = std::to_string(calls_shed);
+  }
+  calls_shed = calls_shed_queue_delay_.load(std::memory_order_relaxed);
+  if (calls_shed != 0) {
+    data["callsShedQueueDelay"] = std::to_string(calls_shed);
+  }
   // Construct top-level object.
   Json::Object object = {
       {"ref",
@@ -270,8 +270,30 @@ class ServerNode : public BaseNode {
   void RecordCallFailed() { call_counter_.RecordCallFailed(); }
   void RecordCallSucceeded() { call_counter_.RecordCallSucceeded(); }
 
+  // Admission control bookkeeping for calls waiting to be matched with an
+  // application request.
+  void RecordPendingCallQueued() {
+    pending_calls_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordPendingCallDequeued() {
+    pending_calls_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  void RecordCallShedQueueFull() {
+    calls_shed_queue_full_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordCallShedDeadlineExceeded() {
+    calls_shed_deadline_exceeded_.fetch_add(1, std::memory_order_relaxed);
+  }
+  void RecordCallShedQueueDelay() {
+    calls_shed_queue_delay_.fetch_add(1, std::memory_order_relaxed);
+  }
+
  private:
   CallCountingHelper call_counter_;
+  std::atomic<int64_t> pending_calls_{0};
+  std::atomic<int64_t> calls_shed_queue_full_{0};
+  std::atomic<int64_t> calls_shed_deadline_exceeded_{0};
+  std::atomic<int64_t> calls_shed_queue_delay_{0};
   ChannelTrace trace_;
   Mutex child_mu_;  // Guards child maps below.
   std::map<intptr_t, RefCountedPtr<SocketNode>> child_sockets_;
@@ -30,6 +30,7 @@
 #include <grpc/support/log.h>
 #include <grpc/support/string_util.h>
 
+#include "src/core/lib/channel/call_metrics.h"
 #include "src/core/lib/channel/channelz.h"
 #include "src/core/lib/gprpp/sync.h"
 #include "src/core/lib/iomgr/exec_ctx.h"
@@ -43,6 +44,10 @@ const int kPaginationLimit = 100;
 
 }  // anonymous namespace
 
+std::string ChannelzRegistry::GetCallMetrics() {
+  return CallMetrics::Get()->RenderJson().Dump();
+}
+
 ChannelzRegistry* ChannelzRegistry::Default() {
   static ChannelzRegistry* singleton = new ChannelzRegistry();
   return singleton;
@@ -275,3 +280,10 @@ char* grpc_channelz_get_socket(intptr_t socket_id) {
   };
   return gpr_strdup(json.Dump().c_str());
 }
+
+char* grpc_channelz_get_call_metrics(void) {
+  grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
+  grpc_core::ExecCtx exec_ctx;
+  return gpr_strdup(
+      grpc_core::channelz::ChannelzRegistry::GetCallMetrics().c_str());
+}
@@ -56,6 +56,10 @@ class ChannelzRegistry {
     return Default()->InternalGetServers(start_server_id);
   }
 
+  // Returns the JSON string of the process-wide per-method call metrics
+  // (see CallMetrics).
+  static std::string GetCallMetrics();
+
   // Test only helper function to dump the JSON representation to std out.
   // This can aid in debugging channelz code.
   static void LogAllEntities() { Default()->InternalLogAllEntities(); }
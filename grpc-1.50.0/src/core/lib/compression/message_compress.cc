@@ -20,27 +20,52 @@
 
 #include "src/core/lib/compression/message_compress.h"
 
+#include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include <zconf.h>
 #include <zlib.h>
 
+#include "absl/strings/str_cat.h"
+
+#include <grpc/event_engine/memory_allocator.h>
 #include <grpc/slice_buffer.h>
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 
+#include "src/core/lib/gpr/alloc.h"
 #include "src/core/lib/slice/slice_refcount.h"
 
 #define OUTPUT_BLOCK_SIZE 1024
+#define MAX_OUTPUT_BLOCK_SIZE (64 * 1024)
 
+/* Runs 'flate' over 'input', appending the result to 'output'.  Output
+   blocks start at OUTPUT_BLOCK_SIZE and double up to MAX_OUTPUT_BLOCK_SIZE,
+   so small messages stay small and large ones do not need thousands of
+   1KB slices.  No block is made larger than needed to detect that more
+   than 'max_output_size' bytes would be produced; if that happens,
+   *too_large is set and 0 is returned. */
 static int zlib_body(z_stream* zs, grpc_slice_buffer* input,
                      grpc_slice_buffer* output,
-                     int (*flate)(z_stream* zs, int flush)) {
+                     int (*flate)(z_stream* zs, int flush),
+                     size_t max_output_size, bool* too_large) {
   int r = Z_STREAM_END; /* Do not fail on an empty input. */
   int flush;
   size_t i;
-  grpc_slice outbuf = GRPC_SLICE_MALLOC(OUTPUT_BLOCK_SIZE);
+  size_t produced = 0;
+  size_t block_size = OUTPUT_BLOCK_SIZE;
   const uInt uint_max = ~static_cast<uInt>(0);
+  /* Allow one byte beyond the limit, so that overflow can be told apart
+     from a message that is exactly max_output_size long.  Blocks are
+     always heap slices, since the final one is trimmed in place. */
+  auto next_block_size = [&]() {
+    size_t budget = max_output_size - produced;
+    if (budget < SIZE_MAX) ++budget;
+    return std::max<size_t>(1, std::min(block_size, budget));
+  };
+  grpc_slice outbuf = grpc_slice_malloc_large(next_block_size());
 
   GPR_ASSERT(GRPC_SLICE_LENGTH(outbuf) <= uint_max);
   zs->avail_out = static_cast<uInt> GRPC_SLICE_LENGTH(outbuf);
@@ -53,8 +78,14 @@ static int zlib_body(z_stream* zs, grpc_slice_buffer* input,
     zs->next_in = GRPC_SLICE_START_PTR(input->slices[i]);
     do {
       if (zs->avail_out == 0) {
+        produced += GRPC_SLICE_LENGTH(outbuf);
         grpc_slice_buffer_add_indexed(output, outbuf);
-        outbuf = GRPC_SLICE_MALLOC(OUTPUT_BLOCK_SIZE);
+        if (produced > max_output_size) {
+          if (too_large != nullptr) *too_large = true;
+          return 0;
+        }
+        block_size = std::min<size_t>(block_size * 2, MAX_OUTPUT_BLOCK_SIZE);
+        outbuf = grpc_slice_malloc_large(next_block_size());
         GPR_ASSERT(GRPC_SLICE_LENGTH(outbuf) <= uint_max);
         zs->avail_out = static_cast<uInt> GRPC_SLICE_LENGTH(outbuf);
         zs->next_out = GRPC_SLICE_START_PTR(outbuf);
@@ -77,7 +108,12 @@ static int zlib_body(z_stream* zs, grpc_slice_buffer* input,
 
   GPR_ASSERT(outbuf.refcount);
   outbuf.data.refcounted.length -= zs->avail_out;
+  produced += GRPC_SLICE_LENGTH(outbuf);
   grpc_slice_buffer_add_indexed(output, outbuf);
+  if (produced > max_output_size) {
+    if (too_large != nullptr) *too_large = true;
+    return 0;
+  }
 
   return 1;
 
@@ -86,59 +122,64 @@ error:
   return 0;
 }
 
-static void* zalloc_gpr(void* /*opaque*/, unsigned int items,
-                        unsigned int size) {
-  return gpr_malloc(items * size);
+/* zlib allocations.  'opaque' is the MemoryAllocator to charge them to, if
+   any; charged blocks start with a header that records their size, so that
+   zfree_gpr can release the charge. */
+#define ZALLOC_HEADER_SIZE GPR_ROUND_UP_TO_ALIGNMENT_SIZE(sizeof(size_t))
+
+static void* zalloc_gpr(void* opaque, unsigned int items, unsigned int size) {
+  size_t n = static_cast<size_t>(items) * size;
+  auto* memory_allocator =
+      static_cast<grpc_event_engine::experimental::MemoryAllocator*>(opaque);
+  if (memory_allocator == nullptr) return gpr_malloc(n);
+  memory_allocator->Reserve(n);
+  char* block = static_cast<char*>(gpr_malloc(ZALLOC_HEADER_SIZE + n));
+  memcpy(block, &n, sizeof(n));
+  return block + ZALLOC_HEADER_SIZE;
 }
 
-static void zfree_gpr(void* /*opaque*/, void* address) { gpr_free(address); }
+static void zfree_gpr(void* opaque, void* address) {
+  auto* memory_allocator =
+      static_cast<grpc_event_engine::experimental::MemoryAllocator*>(opaque);
+  if (memory_allocator == nullptr) {
+    gpr_free(address);
+    return;
+  }
+  char* block = static_cast<char*>(address) - ZALLOC_HEADER_SIZE;
+  size_t n;
+  memcpy(&n, block, sizeof(n));
+  memory_allocator->Release(n);
+  gpr_free(block);
+}
 
-static int zlib_compress(grpc_slice_buffer* input, grpc_slice_buffer* output,
-                         int gzip) {
-  z_stream zs;
-  int r;
-  size_t i;
+/* Drops anything appended to 'output' since it had 'count_before' slices
+   and 'length_before' bytes. */
+static void truncate_output(grpc_slice_buffer* output, size_t count_before,
+                            size_t length_before) {
+  for (size_t i = count_before; i < output->count; i++) {
+    grpc_slice_unref_internal(output->slices[i]);
+  }
+  output->count = count_before;
+  output->length = length_before;
+}
+
+static int zlib_compress(z_stream* zs, grpc_slice_buffer* input,
+                         grpc_slice_buffer* output) {
   size_t count_before = output->count;
   size_t length_before = output->length;
-  memset(&zs, 0, sizeof(zs));
-  zs.zalloc = zalloc_gpr;
-  zs.zfree = zfree_gpr;
-  r = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | (gzip ? 16 : 0),
-                   8, Z_DEFAULT_STRATEGY);
-  GPR_ASSERT(r == Z_OK);
-  r = zlib_body(&zs, input, output, deflate) && output->length < input->length;
-  if (!r) {
-    for (i = count_before; i < output->count; i++) {
-      grpc_slice_unref_internal(output->slices[i]);
-    }
-    output->count = count_before;
-    output->length = length_before;
-  }
-  deflateEnd(&zs);
+  int r = zlib_body(zs, input, output, deflate, SIZE_MAX, nullptr) &&
+          output->length < input->length;
+  if (!r) truncate_output(output, count_before, length_before);
   return r;
 }
 
-static int zlib_decompress(grpc_slice_buffer* input, grpc_slice_buffer* output,
-                           int gzip) {
-  z_stream zs;
-  int r;
-  size_t i;
+static int zlib_decompress(z_stream* zs, grpc_slice_buffer* input,
+                           grpc_slice_buffer* output, size_t max_output_size,
+                           bool* too_large) {
   size_t count_before = output->count;
   size_t length_before = output->length;
-  memset(&zs, 0, sizeof(zs));
-  zs.zalloc = zalloc_gpr;
-  zs.zfree = zfree_gpr;
-  r = inflateInit2(&zs, 15 | (gzip ? 16 : 0));
-  GPR_ASSERT(r == Z_OK);
-  r = zlib_body(&zs, input, output, inflate);
-  if (!r) {
-    for (i = count_before; i < output->count; i++) {
-      grpc_slice_unref_internal(output->slices[i]);
-    }
-    output->count = count_before;
-    output->length = length_before;
-  }
-  inflateEnd(&zs);
+  int r = zlib_body(zs, input, output, inflate, max_output_size, too_large);
+  if (!r) truncate_output(output, count_before, length_before);
   return r;
 }
 
@@ -150,45 +191,150 @@ static int copy(grpc_slice_buffer* input, grpc_slice_buffer* output) {
   return 1;
 }
 
-static int compress_inner(grpc_compression_algorithm algorithm,
-                          grpc_slice_buffer* input, grpc_slice_buffer* output) {
+int grpc_msg_compress(grpc_compression_algorithm algorithm,
+                      grpc_slice_buffer* input, grpc_slice_buffer* output) {
+  grpc_core::MessageCompressionState state;
+  return state.Compress(algorithm, input, output);
+}
+
+int grpc_msg_decompress(grpc_compression_algorithm algorithm,
+                        grpc_slice_buffer* input, grpc_slice_buffer* output) {
+  grpc_core::MessageCompressionState state;
+  return state.Decompress(algorithm, input, output, SIZE_MAX).ok();
+}
+
+namespace grpc_core {
+
+MessageCompressionState::~MessageCompressionState() {
+  if (deflate_stream_ != nullptr) {
+    deflateEnd(deflate_stream_);
+    delete deflate_stream_;
+  }
+  if (inflate_stream_ != nullptr) {
+    inflateEnd(inflate_stream_);
+    delete inflate_stream_;
+  }
+}
+
+z_stream* MessageCompressionState::GetDeflateStream(bool gzip) {
+  if (deflate_stream_ != nullptr) {
+    // The gzip wrapper is fixed at init time, so switching formats needs
+    // a fresh stream; otherwise a reset keeps the allocated tables.
+    if (deflate_gzip_ == gzip) {
+      GPR_ASSERT(deflateReset(deflate_stream_) == Z_OK);
+      return deflate_stream_;
+    }
+    deflateEnd(deflate_stream_);
+  } else {
+    deflate_stream_ = new z_stream;
+  }
+  memset(deflate_stream_, 0, sizeof(*deflate_stream_));
+  deflate_stream_->zalloc = zalloc_gpr;
+  deflate_stream_->zfree = zfree_gpr;
+  deflate_stream_->opaque = memory_allocator_;
+  int r = deflateInit2(deflate_stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                       15 | (gzip ? 16 : 0), 8, Z_DEFAULT_STRATEGY);
+  GPR_ASSERT(r == Z_OK);
+  deflate_gzip_ = gzip;
+  return deflate_stream_;
+}
+
+z_stream* MessageCompressionState::GetInflateStream(bool gzip) {
+  const int window_bits = 15 | (gzip ? 16 : 0);
+  if (inflate_stream_ != nullptr) {
+    GPR_ASSERT(inflateReset2(inflate_stream_, window_bits) == Z_OK);
+    return inflate_stream_;
+  }
+  inflate_stream_ = new z_stream;
+  memset(inflate_stream_, 0, sizeof(*inflate_stream_));
+  inflate_stream_->zalloc = zalloc_gpr;
+  inflate_stream_->zfree = zfree_gpr;
+  inflate_stream_->opaque = memory_allocator_;
+  int r = inflateInit2(inflate_stream_, window_bits);
+  GPR_ASSERT(r == Z_OK);
+  return inflate_stream_;
+}
+
+void MessageCompressionState::MaybeReleaseDeflateStream() {
+  if (++deflate_messages_ > 1 || deflate_stream_ == nullptr) return;
+  deflateEnd(deflate_stream_);
+  delete deflate_stream_;
+  deflate_stream_ = nullptr;
+}
+
+void MessageCompressionState::MaybeReleaseInflateStream() {
+  if (++inflate_messages_ > 1 || inflate_stream_ == nullptr) return;
+  inflateEnd(inflate_stream_);
+  delete inflate_stream_;
+  inflate_stream_ = nullptr;
+}
+
+int MessageCompressionState::Compress(grpc_compression_algorithm algorithm,
+                                      grpc_slice_buffer* input,
+                                      grpc_slice_buffer* output) {
+  int r = 0;
   switch (algorithm) {
     case GRPC_COMPRESS_NONE:
       /* the fallback path always needs to be send uncompressed: we simply
          rely on that here */
-      return 0;
+      break;
     case GRPC_COMPRESS_DEFLATE:
-      return zlib_compress(input, output, 0);
+      r = zlib_compress(GetDeflateStream(false), input, output);
+      MaybeReleaseDeflateStream();
+      break;
     case GRPC_COMPRESS_GZIP:
-      return zlib_compress(input, output, 1);
+      r = zlib_compress(GetDeflateStream(true), input, output);
+      MaybeReleaseDeflateStream();
+      break;
     case GRPC_COMPRESS_ALGORITHMS_COUNT:
+      gpr_log(GPR_ERROR, "invalid compression algorithm %d", algorithm);
       break;
   }
-  gpr_log(GPR_ERROR, "invalid compression algorithm %d", algorithm);
-  return 0;
-}
-
-int grpc_msg_compress(grpc_compression_algorithm algorithm,
-                      grpc_slice_buffer* input, grpc_slice_buffer* output) {
-  if (!compress_inner(algorithm, input, output)) {
+  if (!r) {
     copy(input, output);
     return 0;
   }
   return 1;
 }
 
-int grpc_msg_decompress(grpc_compression_algorithm algorithm,
-                        grpc_slice_buffer* input, grpc_slice_buffer* output) {
+absl::Status MessageCompressionState::Decompress(
+    grpc_compression_algorithm algorithm, grpc_slice_buffer* input,
+    grpc_slice_buffer* output, size_t max_output_size) {
+  bool too_large = false;
+  int r = 0;
   switch (algorithm) {
     case GRPC_COMPRESS_NONE:
-      return copy(input, output);
+      if (input->length > max_output_size) {
+        too_large = true;
+        break;
+      }
+      r = copy(input, output);
+      break;
     case GRPC_COMPRESS_DEFLATE:
-      return zlib_decompress(input, output, 0);
+      r = zlib_decompress(GetInflateStream(false), input, output,
+                          max_output_size, &too_large);
+      MaybeReleaseInflateStream();
+      break;
     case GRPC_COMPRESS_GZIP:
-      return zlib_decompress(input, output, 1);
-    case GRPC_COMPRESS_ALGORITHMS_COUNT:
+      r = zlib_decompress(GetInflateStream(true), input, output,
+                          max_output_size, &too_large);
+      MaybeReleaseInflateStream();
       break;
+    case GRPC_COMPRESS_ALGORITHMS_COUNT:
+      gpr_log(GPR_ERROR, "invalid compression algorithm %d", algorithm);
+      return absl::InvalidArgumentError(
+          absl::StrCat("invalid compression algorithm ", algorithm));
   }
-  gpr_log(GPR_ERROR, "invalid compression algorithm %d", algorithm);
-  return 0;
+  if (too_large) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Decompressed message larger than max (", max_output_size, ")"));
+  }
+  if (!r) {
+    return absl::InternalError(absl::StrCat(
+        "Unexpected error decompressing data for algorithm with enum value ",
+        algorithm));
+  }
+  return absl::OkStatus();
 }
+
+}  // namespace grpc_core
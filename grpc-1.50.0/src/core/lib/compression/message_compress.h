@@ -21,9 +21,21 @@
 
 #include <grpc/support/port_platform.h>
 
+#include <stddef.h>
+
+#include "absl/status/status.h"
+
 #include <grpc/impl/codegen/compression_types.h>
 #include <grpc/slice.h>
 
+struct z_stream_s;
+
+namespace grpc_event_engine {
+namespace experimental {
+class MemoryAllocator;
+}  // namespace experimental
+}  // namespace grpc_event_engine
+
 /* compress 'input' to 'output' using 'algorithm'.
    On success, appends compressed slices to output and returns 1.
    On failure, appends uncompressed slices to output and returns 0. */
@@ -36,4 +48,58 @@ int grpc_msg_compress(grpc_compression_algorithm algorithm,
 int grpc_msg_decompress(grpc_compression_algorithm algorithm,
                         grpc_slice_buffer* input, grpc_slice_buffer* output);
 
+namespace grpc_core {
+
+// zlib state that is kept across the messages of a single call.
+//
+// Setting up a deflate stream allocates and initializes roughly 256KB of
+// window and hash tables, so reusing the stream via deflateReset() (and
+// likewise inflateReset2()) for every message after the first makes
+// compressed streaming calls much cheaper.  A stream is freed again right
+// after the first message it handles, so a unary call holds no zlib state
+// between messages; it is only kept from the second message on.  While a
+// stream is allocated, its memory is charged to 'memory_allocator', if one
+// is given, so that it counts against the resource quota.  Not thread-safe;
+// a call's filters only use it from within the call combiner.
+class MessageCompressionState {
+ public:
+  explicit MessageCompressionState(
+      grpc_event_engine::experimental::MemoryAllocator* memory_allocator =
+          nullptr)
+      : memory_allocator_(memory_allocator) {}
+  ~MessageCompressionState();
+
+  MessageCompressionState(const MessageCompressionState&) = delete;
+  MessageCompressionState& operator=(const MessageCompressionState&) = delete;
+
+  // Same contract as grpc_msg_compress().
+  int Compress(grpc_compression_algorithm algorithm, grpc_slice_buffer* input,
+               grpc_slice_buffer* output);
+
+  // Decompresses 'input' into 'output', appending at most
+  // 'max_output_size' bytes.  Output is produced in bounded chunks, so a
+  // message that inflates past the limit fails with RESOURCE_EXHAUSTED
+  // without allocating more than roughly one extra chunk.  On failure,
+  // output is unchanged.
+  absl::Status Decompress(grpc_compression_algorithm algorithm,
+                          grpc_slice_buffer* input, grpc_slice_buffer* output,
+                          size_t max_output_size);
+
+ private:
+  z_stream_s* GetDeflateStream(bool gzip);
+  z_stream_s* GetInflateStream(bool gzip);
+  // Free the streams after the first message each of them handles.
+  void MaybeReleaseDeflateStream();
+  void MaybeReleaseInflateStream();
+
+  grpc_event_engine::experimental::MemoryAllocator* const memory_allocator_;
+  z_stream_s* deflate_stream_ = nullptr;
+  bool deflate_gzip_ = false;
+  size_t deflate_messages_ = 0;
+  z_stream_s* inflate_stream_ = nullptr;
+  size_t inflate_messages_ = 0;
+};
+
+}  // namespace grpc_core
+
 #endif /* GRPC_CORE_LIB_COMPRESSION_MESSAGE_COMPRESS_H */
@@ -55,6 +55,7 @@ typedef enum {
   GRPC_STATS_HISTOGRAM_TCP_READ_OFFER,
   GRPC_STATS_HISTOGRAM_TCP_READ_OFFER_IOV_SIZE,
   GRPC_STATS_HISTOGRAM_HTTP2_SEND_MESSAGE_SIZE,
+  GRPC_STATS_HISTOGRAM_HTTP2_FRAMES_PER_WRITE,
   GRPC_STATS_HISTOGRAM_COUNT
 } grpc_stats_histograms;
 extern const char* grpc_stats_histogram_name[GRPC_STATS_HISTOGRAM_COUNT];
@@ -74,7 +75,9 @@ typedef enum {
   GRPC_STATS_HISTOGRAM_TCP_READ_OFFER_IOV_SIZE_BUCKETS = 10,
   GRPC_STATS_HISTOGRAM_HTTP2_SEND_MESSAGE_SIZE_FIRST_SLOT = 104,
   GRPC_STATS_HISTOGRAM_HTTP2_SEND_MESSAGE_SIZE_BUCKETS = 20,
-  GRPC_STATS_HISTOGRAM_BUCKETS = 124
+  GRPC_STATS_HISTOGRAM_HTTP2_FRAMES_PER_WRITE_FIRST_SLOT = 124,
+  GRPC_STATS_HISTOGRAM_HTTP2_FRAMES_PER_WRITE_BUCKETS = 10,
+  GRPC_STATS_HISTOGRAM_BUCKETS = 134
 } grpc_stats_histogram_constants;
 #define GRPC_STATS_INC_CLIENT_CALLS_CREATED() \
   GRPC_STATS_INC_COUNTER(GRPC_STATS_COUNTER_CLIENT_CALLS_CREATED)
@@ -138,14 +141,18 @@ typedef enum {
   GRPC_STATS_INC_HISTOGRAM(                           \
       GRPC_STATS_HISTOGRAM_HTTP2_SEND_MESSAGE_SIZE,   \
       grpc_core::BucketForHistogramValue_16777216_20(static_cast<int>(value)))
+#define GRPC_STATS_INC_HTTP2_FRAMES_PER_WRITE(value) \
+  GRPC_STATS_INC_HISTOGRAM(                          \
+      GRPC_STATS_HISTOGRAM_HTTP2_FRAMES_PER_WRITE,   \
+      grpc_core::BucketForHistogramValue_80_10(static_cast<int>(value)))
 namespace grpc_core {
 int BucketForHistogramValue_32768_24(int value);
 int BucketForHistogramValue_16777216_20(int value);
 int BucketForHistogramValue_80_10(int value);
 }  // namespace grpc_core
-extern const int grpc_stats_histo_buckets[7];
-extern const int grpc_stats_histo_start[7];
-extern const int* const grpc_stats_histo_bucket_boundaries[7];
-extern int (*const grpc_stats_get_bucket[7])(int value);
+extern const int grpc_stats_histo_buckets[8];
+extern const int grpc_stats_histo_start[8];
+extern const int* const grpc_stats_histo_bucket_boundaries[8];
+extern int (*const grpc_stats_get_bucket[8])(int value);
 
 #endif /* GRPC_CORE_LIB_DEBUG_STATS_DATA_H */
@@ -33,6 +33,8 @@
 #include <grpc/support/time.h>
 
 #include "src/core/lib/debug/trace.h"
+#include "src/core/lib/event_engine/posix_engine/timer_wheel.h"
+#include "src/core/lib/experiments/experiments.h"
 #include "src/core/lib/gpr/tls.h"
 #include "src/core/lib/gprpp/thd.h"
 
@@ -226,7 +228,11 @@ void TimerManager::Run(grpc_core::Thread thread) {
 bool TimerManager::IsTimerManagerThread() { return g_timer_thread; }
 
 TimerManager::TimerManager() : host_(this) {
-  timer_list_ = absl::make_unique<TimerList>(&host_);
+  if (grpc_core::IsTimerWheelEnabled()) {
+    timer_list_ = absl::make_unique<TimerWheelList>(&host_);
+  } else {
+    timer_list_ = absl::make_unique<TimerList>(&host_);
+  }
   grpc_core::MutexLock lock(&mu_);
   StartThread();
 }
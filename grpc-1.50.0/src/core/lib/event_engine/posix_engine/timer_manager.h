@@ -132,7 +132,7 @@ class TimerManager final : public grpc_event_engine::experimental::Forkable {
   // number of timer wakeups
   uint64_t wakeups_ ABSL_GUARDED_BY(mu_) = 0;
   // actual timer implementation
-  std::unique_ptr<TimerList> timer_list_;
+  std::unique_ptr<TimerListInterface> timer_list_;
   int prefork_thread_count_ = 0;
 };
 
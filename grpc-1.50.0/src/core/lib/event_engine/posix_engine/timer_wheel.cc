@@ -0,0 +1,134 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/event_engine/posix_engine/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "absl/memory/memory.h"
+
+#include <grpc/support/cpu.h>
+
+#include "src/core/lib/gpr/useful.h"
+
+namespace grpc_event_engine {
+namespace posix_engine {
+
+TimerWheelList::TimerWheelList(TimerListHost* host)
+    : host_(host),
+      num_shards_(grpc_core::Clamp(2 * gpr_cpu_num_cores(), 1u, 32u)) {
+  const int64_t now = host_->Now().milliseconds_after_process_epoch();
+  shards_.reserve(num_shards_);
+  for (size_t i = 0; i < num_shards_; i++) {
+    shards_.push_back(absl::make_unique<Shard>(now));
+  }
+}
+
+void TimerWheelList::TimerInit(Timer* timer, grpc_core::Timestamp deadline,
+                               experimental::EventEngine::Closure* closure) {
+  Shard* shard = shards_[grpc_core::HashPointer(timer, num_shards_)].get();
+  timer->closure = closure;
+  timer->deadline = deadline.milliseconds_after_process_epoch();
+
+#ifndef NDEBUG
+  timer->hash_table_next = nullptr;
+#endif
+
+  bool is_first_timer = false;
+  {
+    grpc_core::MutexLock lock(&shard->mu);
+    timer->pending = true;
+    // Unlike TimerList, there is no need to read the clock here: the wheel
+    // files a deadline that has already passed under its current tick, which
+    // the next TimerCheck fires.
+    shard->wheel.Add(timer);
+    if (timer->deadline < shard->next_tick) {
+      shard->next_tick = timer->deadline;
+      is_first_timer = true;
+    }
+  }
+
+  // As in TimerList::TimerInit, a TimerCheck may run between the two locks;
+  // at worst that delays this timer to the next check, and lowering
+  // min_timer_ under mu_ keeps it from being lost.
+  if (is_first_timer) {
+    grpc_core::MutexLock lock(&mu_);
+    if (timer->deadline < min_timer_.load(std::memory_order_relaxed)) {
+      min_timer_.store(timer->deadline, std::memory_order_relaxed);
+      host_->Kick();
+    }
+  }
+}
+
+bool TimerWheelList::TimerCancel(Timer* timer) {
+  Shard* shard = shards_[grpc_core::HashPointer(timer, num_shards_)].get();
+  grpc_core::MutexLock lock(&shard->mu);
+  if (timer->pending) {
+    timer->pending = false;
+    shard->wheel.Remove(timer);
+    return true;
+  }
+  return false;
+}
+
+std::vector<experimental::EventEngine::Closure*>
+TimerWheelList::FindExpiredTimers(grpc_core::Timestamp now,
+                                  grpc_core::Timestamp* next) {
+  const int64_t now_ms = now.milliseconds_after_process_epoch();
+  std::vector<experimental::EventEngine::Closure*> done;
+  grpc_core::MutexLock lock(&mu_);
+  int64_t min_timer = std::numeric_limits<int64_t>::max();
+  for (auto& shard : shards_) {
+    grpc_core::MutexLock shard_lock(&shard->mu);
+    if (shard->next_tick <= now_ms) {
+      shard->wheel.Advance(now_ms, [&done](Timer* timer) {
+        timer->pending = false;
+        done.push_back(timer->closure);
+      });
+      shard->next_tick = shard->wheel.NextEventTick();
+    }
+    min_timer = std::min(min_timer, shard->next_tick);
+  }
+  min_timer_.store(min_timer, std::memory_order_relaxed);
+  if (next != nullptr) {
+    *next = std::min(
+        *next, grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+                   min_timer));
+  }
+  return done;
+}
+
+absl::optional<std::vector<experimental::EventEngine::Closure*>>
+TimerWheelList::TimerCheck(grpc_core::Timestamp* next) {
+  grpc_core::Timestamp now = host_->Now();
+  grpc_core::Timestamp min_timer =
+      grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+          min_timer_.load(std::memory_order_relaxed));
+  if (now < min_timer) {
+    if (next != nullptr) *next = std::min(*next, min_timer);
+    return std::vector<experimental::EventEngine::Closure*>();
+  }
+  if (!checker_mu_.TryLock()) return absl::nullopt;
+  std::vector<experimental::EventEngine::Closure*> run =
+      FindExpiredTimers(now, next);
+  checker_mu_.Unlock();
+  return std::move(run);
+}
+
+}  // namespace posix_engine
+}  // namespace grpc_event_engine
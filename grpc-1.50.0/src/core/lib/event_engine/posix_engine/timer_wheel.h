@@ -0,0 +1,95 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_LIB_EVENT_ENGINE_POSIX_ENGINE_TIMER_WHEEL_H
+#define GRPC_CORE_LIB_EVENT_ENGINE_POSIX_ENGINE_TIMER_WHEEL_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/types/optional.h"
+
+#include <grpc/event_engine/event_engine.h>
+
+#include "src/core/lib/event_engine/posix_engine/timer.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/gprpp/time.h"
+#include "src/core/lib/gprpp/timing_wheel.h"
+
+namespace grpc_event_engine {
+namespace posix_engine {
+
+// TimerListInterface implementation that keeps each shard's timers in a
+// hierarchical timing wheel rather than a heap, so TimerInit and TimerCancel
+// are O(1) regardless of how many timers are pending. Behaves like TimerList:
+// deadlines in the past fire on the next TimerCheck, and TimerCheck returns
+// nullopt when another thread is already checking.
+//
+// Arming is cheaper than in TimerList, but cancelling unlinks the timer from
+// a per-slot list whose neighbours are usually not adjacent in memory. When
+// timers sit next to each other in memory and are cancelled in the order they
+// were armed, TimerList's single unordered list has hot neighbours, so for
+// far-out deadlines it cancels faster and the wheel gains nothing overall.
+class TimerWheelList final : public TimerListInterface {
+ public:
+  explicit TimerWheelList(TimerListHost* host);
+
+  TimerWheelList(const TimerWheelList&) = delete;
+  TimerWheelList& operator=(const TimerWheelList&) = delete;
+
+  void TimerInit(Timer* timer, grpc_core::Timestamp deadline,
+                 experimental::EventEngine::Closure* closure) override;
+  bool TimerCancel(Timer* timer) override GRPC_MUST_USE_RESULT;
+  absl::optional<std::vector<experimental::EventEngine::Closure*>> TimerCheck(
+      grpc_core::Timestamp* next) override;
+
+ private:
+  struct Shard {
+    explicit Shard(int64_t now) : wheel(now) {}
+
+    grpc_core::Mutex mu;
+    grpc_core::TimingWheel<Timer> wheel ABSL_GUARDED_BY(mu);
+    // Lower bound on the deadline of the next timer in this shard.
+    int64_t next_tick ABSL_GUARDED_BY(mu) =
+        std::numeric_limits<int64_t>::max();
+  };
+
+  std::vector<experimental::EventEngine::Closure*> FindExpiredTimers(
+      grpc_core::Timestamp now, grpc_core::Timestamp* next);
+
+  TimerListHost* const host_;
+  const size_t num_shards_;
+  // Serializes updates of min_timer_.
+  grpc_core::Mutex mu_;
+  // Lower bound on the deadline of the next timer across all shards. Only
+  // lowered while holding mu_, but read without it.
+  std::atomic<int64_t> min_timer_{std::numeric_limits<int64_t>::max()};
+  // Allow only one FindExpiredTimers at once (used as a TryLock, protects no
+  // fields but ensures limits on concurrency)
+  grpc_core::Mutex checker_mu_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace posix_engine
+}  // namespace grpc_event_engine
+
+#endif  // GRPC_CORE_LIB_EVENT_ENGINE_POSIX_ENGINE_TIMER_WHEEL_H
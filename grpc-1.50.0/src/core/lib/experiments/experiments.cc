@@ -46,6 +46,17 @@ const char* const description_new_hpack_huffman_decoder =
     "implementation.";
 const char* const description_event_engine_client =
     "Use EventEngine clients instead of iomgr's grpc_tcp_client";
+const char* const description_hpack_adaptive_indexing =
+    "Track how often user metadata repeats on each connection and add "
+    "repeated key/value pairs to the HPACK dynamic table instead of always "
+    "sending them as literals. Only keys listed in "
+    "GRPC_ARG_HTTP2_HPACK_INDEXED_METADATA_KEYS are indexed.";
+const char* const description_timer_wheel =
+    "Back the iomgr and posix event engine timer lists with hierarchical "
+    "timing wheels, making timer arm and cancel O(1).";
+const char* const description_ssl_zero_copy_protector =
+    "Protect TLS connections with a zero-copy frame protector that writes "
+    "whole records straight from and into slice buffers.";
 #ifdef NDEBUG
 const bool kDefaultForDebugOnly = false;
 #else
@@ -70,6 +81,9 @@ const ExperimentMetadata g_experiment_metadata[] = {
     {"new_hpack_huffman_decoder", description_new_hpack_huffman_decoder,
      kDefaultForDebugOnly},
     {"event_engine_client", description_event_engine_client, false},
+    {"hpack_adaptive_indexing", description_hpack_adaptive_indexing, false},
+    {"timer_wheel", description_timer_wheel, false},
+    {"ssl_zero_copy_protector", description_ssl_zero_copy_protector, false},
 };
 
 }  // namespace grpc_core
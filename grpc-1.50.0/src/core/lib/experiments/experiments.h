@@ -41,6 +41,13 @@ inline bool IsUnconstrainedMaxQuotaBufferSizeEnabled() {
 }
 inline bool IsNewHpackHuffmanDecoderEnabled() { return IsExperimentEnabled(8); }
 inline bool IsEventEngineClientEnabled() { return IsExperimentEnabled(9); }
+inline bool IsHpackAdaptiveIndexingEnabled() {
+  return IsExperimentEnabled(10);
+}
+inline bool IsTimerWheelEnabled() { return IsExperimentEnabled(11); }
+inline bool IsSslZeroCopyProtectorEnabled() {
+  return IsExperimentEnabled(12);
+}
 
 struct ExperimentMetadata {
   const char* name;
@@ -48,7 +55,7 @@ struct ExperimentMetadata {
   bool default_value;
 };
 
-constexpr const size_t kNumExperiments = 10;
+constexpr const size_t kNumExperiments = 13;
 extern const ExperimentMetadata g_experiment_metadata[kNumExperiments];
 
 }  // namespace grpc_core
@@ -0,0 +1,200 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_LIB_GPRPP_TIMING_WHEEL_H
+#define GRPC_CORE_LIB_GPRPP_TIMING_WHEEL_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "absl/numeric/bits.h"
+
+namespace grpc_core {
+
+// Hierarchical timing wheel over intrusive timer nodes, with one millisecond
+// ticks.
+//
+// There are kLevels wheels of 64 slots; level L holds timers whose deadline
+// agrees with the current tick in every bit above 6*(L+1), in the slot given
+// by bits [6L, 6L+6) of the deadline. Timers that are further out than the
+// top wheel covers (about 2 years) wait in an overflow list. Add and Remove
+// are O(1). As time advances, the slot a higher level reaches is cascaded
+// down to the lower levels, so each timer moves at most kLevels times over
+// its lifetime; timers that are cancelled early (the common case for
+// deadlines) mostly never move at all. Per-level occupancy bitmaps let
+// Advance and NextEventTick skip empty stretches of time.
+//
+// T must have an integral `deadline` (in milliseconds), `T* next`,
+// `T* prev` and an unsigned integral `heap_index` member; the wheel uses
+// heap_index to remember which slot a timer is linked into.
+//
+// Not thread safe.
+template <typename T>
+class TimingWheel {
+ public:
+  explicit TimingWheel(int64_t now) : now_(now) {}
+
+  TimingWheel(const TimingWheel&) = delete;
+  TimingWheel& operator=(const TimingWheel&) = delete;
+
+  // Link timer into the wheel. Deadlines at or before the current tick fire on
+  // the next Advance.
+  void Add(T* timer) {
+    const int64_t deadline = std::max<int64_t>(timer->deadline, now_);
+    const uint64_t diff =
+        static_cast<uint64_t>(deadline) ^ static_cast<uint64_t>(now_);
+    const int level =
+        diff == 0 ? 0 : (63 - absl::countl_zero(diff)) / kBitsPerLevel;
+    uint32_t slot = kOverflowSlot;
+    if (level < kLevels) {
+      slot = level * kSlotsPerLevel +
+             ((deadline >> (level * kBitsPerLevel)) & (kSlotsPerLevel - 1));
+      occupied_[level] |= uint64_t{1} << (slot % kSlotsPerLevel);
+    }
+    timer->heap_index = slot;
+    timer->prev = nullptr;
+    timer->next = slots_[slot];
+    if (timer->next != nullptr) timer->next->prev = timer;
+    slots_[slot] = timer;
+    ++size_;
+  }
+
+  // Unlink a timer previously passed to Add that has not yet expired.
+  void Remove(T* timer) {
+    const uint32_t slot = static_cast<uint32_t>(timer->heap_index);
+    if (timer->prev != nullptr) {
+      timer->prev->next = timer->next;
+    } else {
+      slots_[slot] = timer->next;
+      if (timer->next == nullptr && slot != kOverflowSlot) {
+        occupied_[slot / kSlotsPerLevel] &=
+            ~(uint64_t{1} << (slot % kSlotsPerLevel));
+      }
+    }
+    if (timer->next != nullptr) timer->next->prev = timer->prev;
+    --size_;
+  }
+
+  // Move the wheel forward to now, unlinking every timer whose deadline is at
+  // or before now and passing it to on_expired.
+  template <typename F>
+  void Advance(int64_t now, F on_expired) {
+    for (;;) {
+      const int64_t tick = NextEventTick();
+      if (tick > now) break;
+      now_ = tick;
+      if (slots_[kOverflowSlot] != nullptr &&
+          (now_ & ((int64_t{1} << (kLevels * kBitsPerLevel)) - 1)) == 0) {
+        Cascade(kOverflowSlot);
+      }
+      for (int level = kLevels - 1; level > 0; level--) {
+        const uint32_t index =
+            (now_ >> (level * kBitsPerLevel)) & (kSlotsPerLevel - 1);
+        if (occupied_[level] & (uint64_t{1} << index)) {
+          Cascade(level * kSlotsPerLevel + index);
+        }
+      }
+      T* timer = TakeSlot(now_ & (kSlotsPerLevel - 1));
+      while (timer != nullptr) {
+        T* next = timer->next;
+        --size_;
+        on_expired(timer);
+        timer = next;
+      }
+    }
+    now_ = std::max(now_, now);
+  }
+
+  // Unlink every timer, passing each to on_expired.
+  template <typename F>
+  void Drain(F on_expired) {
+    for (uint32_t slot = 0; slot <= kOverflowSlot; slot++) {
+      T* timer = slots_[slot];
+      slots_[slot] = nullptr;
+      while (timer != nullptr) {
+        T* next = timer->next;
+        on_expired(timer);
+        timer = next;
+      }
+    }
+    std::fill(occupied_, occupied_ + kLevels, 0);
+    size_ = 0;
+  }
+
+  // The earliest tick at which Advance has work to do: either a timer firing
+  // or a slot cascading to a lower level. A lower bound for the next deadline;
+  // int64_t max if the wheel is empty.
+  int64_t NextEventTick() const {
+    for (int level = 0; level < kLevels; level++) {
+      const int shift = level * kBitsPerLevel;
+      const uint32_t index = (now_ >> shift) & (kSlotsPerLevel - 1);
+      // Level 0 includes the current tick; the current slot of every higher
+      // level has already been cascaded.
+      const uint32_t first = level == 0 ? index : index + 1;
+      if (first >= kSlotsPerLevel) continue;
+      const uint64_t pending = occupied_[level] & (~uint64_t{0} << first);
+      if (pending == 0) continue;
+      const int64_t base = now_ & ~((int64_t{1} << (shift + kBitsPerLevel)) - 1);
+      return base + (static_cast<int64_t>(absl::countr_zero(pending)) << shift);
+    }
+    if (slots_[kOverflowSlot] != nullptr) {
+      const int shift = kLevels * kBitsPerLevel;
+      return ((now_ >> shift) + 1) << shift;
+    }
+    return std::numeric_limits<int64_t>::max();
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr int kBitsPerLevel = 6;
+  static constexpr uint32_t kSlotsPerLevel = 1u << kBitsPerLevel;
+  static constexpr int kLevels = 6;
+  static constexpr uint32_t kOverflowSlot = kLevels * kSlotsPerLevel;
+
+  T* TakeSlot(uint32_t slot) {
+    T* head = slots_[slot];
+    slots_[slot] = nullptr;
+    if (slot != kOverflowSlot) {
+      occupied_[slot / kSlotsPerLevel] &=
+          ~(uint64_t{1} << (slot % kSlotsPerLevel));
+    }
+    return head;
+  }
+
+  void Cascade(uint32_t slot) {
+    T* timer = TakeSlot(slot);
+    while (timer != nullptr) {
+      T* next = timer->next;
+      --size_;
+      Add(timer);
+      timer = next;
+    }
+  }
+
+  T* slots_[kOverflowSlot + 1] = {};
+  uint64_t occupied_[kLevels] = {};
+  int64_t now_;
+  size_t size_ = 0;
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_LIB_GPRPP_TIMING_WHEEL_H
@@ -59,6 +59,7 @@
 #define GRPC_LINUX_MULTIPOLL_WITH_EPOLL 1
 #define GRPC_POSIX_FORK 1
 #define GRPC_POSIX_HOST_NAME_MAX 1
+#define GRPC_POSIX_SHM 1
 #define GRPC_POSIX_SOCKET 1
 #define GRPC_POSIX_WAKEUP_FD 1
 #ifdef __GLIBC_PREREQ
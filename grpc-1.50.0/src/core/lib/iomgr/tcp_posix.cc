@@ -480,6 +480,9 @@ struct grpc_tcp {
   bool has_posted_reclaimer ABSL_GUARDED_BY(read_mu) = false;
   double target_length;
   double bytes_read_this_round;
+  /* Read buffers are sized target_length >> buffer_shrink_shift; see
+   * grpc_core::BufferShrinkShiftForMemoryPressure(). */
+  int buffer_shrink_shift ABSL_GUARDED_BY(read_mu) = 0;
   grpc_core::RefCount refcount;
   gpr_atm shutdown_count;
 
@@ -940,6 +943,11 @@ static bool tcp_do_read(grpc_tcp* tcp, grpc_error_handle* error)
         }
         finish_estimate(tcp);
         tcp->inq = 0;
+        /* Under memory pressure, don't hold on to read buffers while waiting
+         * for data. They are reallocated once the socket is readable. */
+        if (tcp->buffer_shrink_shift > 0) {
+          grpc_slice_buffer_reset_and_unref_internal(tcp->incoming_buffer);
+        }
         return false;
       } else {
         grpc_slice_buffer_reset_and_unref_internal(tcp->incoming_buffer);
@@ -1047,18 +1055,20 @@ static bool tcp_do_read(grpc_tcp* tcp, grpc_error_handle* error)
 
 static void maybe_make_read_slices(grpc_tcp* tcp)
     ABSL_EXCLUSIVE_LOCKS_REQUIRED(tcp->read_mu) {
+  tcp->buffer_shrink_shift =
+      tcp->memory_owner.BufferShrinkShift(tcp->buffer_shrink_shift);
   if (grpc_core::IsTcpReadChunksEnabled()) {
     static const int kBigAlloc = 64 * 1024;
     static const int kSmallAlloc = 8 * 1024;
     if (tcp->incoming_buffer->length <
         static_cast<size_t>(tcp->min_progress_size)) {
       size_t allocate_length = tcp->min_progress_size;
-      const size_t target_length = static_cast<size_t>(tcp->target_length);
-      // If memory pressure is low and we think there will be more than
-      // min_progress_size bytes to read, allocate a bit more.
-      const bool low_memory_pressure =
-          tcp->memory_owner.GetPressureInfo().pressure_control_value < 0.8;
-      if (low_memory_pressure && target_length > allocate_length) {
+      const size_t target_length =
+          static_cast<size_t>(tcp->target_length) >> tcp->buffer_shrink_shift;
+      // If we think there will be more than min_progress_size bytes to read,
+      // allocate a bit more, scaled down under memory pressure.
+      const bool low_memory_pressure = tcp->buffer_shrink_shift == 0;
+      if (target_length > allocate_length) {
         allocate_length = target_length;
       }
       int extra_wanted =
@@ -1092,8 +1102,9 @@ static void maybe_make_read_slices(grpc_tcp* tcp)
                 tcp, tcp->min_read_chunk_size, tcp->max_read_chunk_size,
                 tcp->target_length, tcp->incoming_buffer->length);
       }
-      int target_length = std::max(static_cast<int>(tcp->target_length),
-                                   tcp->min_progress_size);
+      int target_length = std::max(
+          static_cast<int>(tcp->target_length) >> tcp->buffer_shrink_shift,
+          tcp->min_progress_size);
       int extra_wanted =
           target_length - static_cast<int>(tcp->incoming_buffer->length);
       int min_read_chunk_size =
@@ -1161,6 +1172,11 @@ static void tcp_read(grpc_endpoint* ep, grpc_slice_buffer* incoming_buffer,
     tcp->is_first_read = false;
     notify_on_read(tcp);
   } else if (!urgent && tcp->inq == 0) {
+    /* Under memory pressure, release the spare capacity left over from the
+     * last read rather than holding it while the connection is idle. */
+    if (tcp->buffer_shrink_shift > 0) {
+      grpc_slice_buffer_reset_and_unref_internal(incoming_buffer);
+    }
     update_rcvlowat(tcp);
     tcp->read_mu.Unlock();
     /* Upper layer asked to read more but we know there is no pending data
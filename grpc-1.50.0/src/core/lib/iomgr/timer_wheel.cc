@@ -0,0 +1,280 @@
+//
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+// Timer implementation backed by hierarchical timing wheels; selected instead
+// of timer_generic.cc by the timer_wheel experiment.
+//
+// timer_generic.cc keeps near-term timers in a heap, which costs O(log n) on
+// every arm and cancel. Deadlines are typically long and almost always
+// cancelled, so with many concurrent calls that churn dominates. Here each
+// shard owns a grpc_core::TimingWheel, making arm and cancel O(1) under the
+// shard lock. The global lock is only taken when a timer becomes the earliest
+// in its shard.
+
+#include <grpc/support/port_platform.h>
+
+#include <inttypes.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#include <grpc/support/alloc.h>
+#include <grpc/support/cpu.h>
+#include <grpc/support/log.h>
+#include <grpc/support/sync.h>
+
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gpr/spinlock.h"
+#include "src/core/lib/gpr/tls.h"
+#include "src/core/lib/gpr/useful.h"
+#include "src/core/lib/gprpp/manual_constructor.h"
+#include "src/core/lib/gprpp/time.h"
+#include "src/core/lib/gprpp/timing_wheel.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/timer.h"
+
+extern grpc_core::TraceFlag grpc_timer_trace;
+extern grpc_core::TraceFlag grpc_timer_check_trace;
+
+namespace {
+
+struct WheelShard {
+  gpr_mu mu;
+  grpc_core::ManualConstructor<grpc_core::TimingWheel<grpc_timer>> wheel;
+  // Lower bound on the next deadline in this shard. Guarded by mu.
+  int64_t next_tick;
+};
+
+size_t g_num_shards;
+WheelShard* g_shards;
+
+struct WheelSharedMutables {
+  // Lower bound on the next deadline across all shards. Only lowered while
+  // holding mu, but read without it.
+  std::atomic<int64_t> min_timer{0};
+  // Allow only one RunExpiredTimers at once.
+  gpr_spinlock checker_mu;
+  bool initialized;
+  // Serializes updates of min_timer.
+  gpr_mu mu;
+} GPR_ALIGN_STRUCT(GPR_CACHELINE_SIZE);
+
+WheelSharedMutables g_shared_mutables;
+
+// Deadline of the next timer this thread last saw; lets most checks skip
+// touching the shared cacheline.
+GPR_THREAD_LOCAL(int64_t) g_last_seen_min_timer;
+
+constexpr int64_t kNoTimers = std::numeric_limits<int64_t>::max();
+
+void TimerListInit() {
+  g_num_shards = grpc_core::Clamp(2 * gpr_cpu_num_cores(), 1u, 32u);
+  g_shards =
+      static_cast<WheelShard*>(gpr_zalloc(g_num_shards * sizeof(*g_shards)));
+  const int64_t now =
+      grpc_core::Timestamp::Now().milliseconds_after_process_epoch();
+  g_shared_mutables.initialized = true;
+  g_shared_mutables.checker_mu = GPR_SPINLOCK_INITIALIZER;
+  gpr_mu_init(&g_shared_mutables.mu);
+  g_shared_mutables.min_timer.store(kNoTimers, std::memory_order_relaxed);
+  g_last_seen_min_timer = 0;
+  for (size_t i = 0; i < g_num_shards; i++) {
+    WheelShard* shard = &g_shards[i];
+    gpr_mu_init(&shard->mu);
+    shard->wheel.Init(now);
+    shard->next_tick = kNoTimers;
+  }
+}
+
+void TimerListShutdown() {
+  grpc_error_handle error =
+      GRPC_ERROR_CREATE_FROM_STATIC_STRING("Timer list shutdown");
+  for (size_t i = 0; i < g_num_shards; i++) {
+    WheelShard* shard = &g_shards[i];
+    gpr_mu_lock(&shard->mu);
+    shard->wheel->Drain([error](grpc_timer* timer) {
+      timer->pending = false;
+      grpc_core::ExecCtx::Run(DEBUG_LOCATION, timer->closure,
+                              GRPC_ERROR_REF(error));
+    });
+    gpr_mu_unlock(&shard->mu);
+    shard->wheel.Destroy();
+    gpr_mu_destroy(&shard->mu);
+  }
+  GRPC_ERROR_UNREF(error);
+  gpr_mu_destroy(&g_shared_mutables.mu);
+  gpr_free(g_shards);
+  g_shared_mutables.initialized = false;
+}
+
+void TimerInit(grpc_timer* timer, grpc_core::Timestamp deadline,
+               grpc_closure* closure) {
+  WheelShard* shard = &g_shards[grpc_core::HashPointer(timer, g_num_shards)];
+  timer->closure = closure;
+  timer->deadline = deadline.milliseconds_after_process_epoch();
+
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
+    gpr_log(GPR_INFO, "TIMER %p: SET %" PRId64 " now %" PRId64 " call %p[%p]",
+            timer, deadline.milliseconds_after_process_epoch(),
+            grpc_core::Timestamp::Now().milliseconds_after_process_epoch(),
+            closure, closure->cb);
+  }
+
+  if (!g_shared_mutables.initialized) {
+    timer->pending = false;
+    grpc_core::ExecCtx::Run(
+        DEBUG_LOCATION, timer->closure,
+        GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+            "Attempt to create timer before initialization"));
+    return;
+  }
+
+  gpr_mu_lock(&shard->mu);
+  if (deadline <= grpc_core::Timestamp::Now()) {
+    timer->pending = false;
+    grpc_core::ExecCtx::Run(DEBUG_LOCATION, timer->closure, GRPC_ERROR_NONE);
+    gpr_mu_unlock(&shard->mu);
+    return;
+  }
+  timer->pending = true;
+  shard->wheel->Add(timer);
+  const bool is_first_timer = timer->deadline < shard->next_tick;
+  if (is_first_timer) shard->next_tick = timer->deadline;
+  gpr_mu_unlock(&shard->mu);
+
+  // As in timer_generic.cc, a concurrent check may run between the unlock
+  // above and the lock below; at worst that delays this timer to the next
+  // check, and lowering min_timer under the lock keeps it from being lost.
+  if (is_first_timer) {
+    gpr_mu_lock(&g_shared_mutables.mu);
+    if (timer->deadline <
+        g_shared_mutables.min_timer.load(std::memory_order_relaxed)) {
+      g_shared_mutables.min_timer.store(timer->deadline,
+                                        std::memory_order_relaxed);
+      grpc_kick_poller();
+    }
+    gpr_mu_unlock(&g_shared_mutables.mu);
+  }
+}
+
+void TimerConsumeKick() {
+  // Force re-evaluation of last seen min
+  g_last_seen_min_timer = 0;
+}
+
+void TimerCancel(grpc_timer* timer) {
+  if (!g_shared_mutables.initialized) {
+    // must have already been cancelled, also the shard mutex is invalid
+    return;
+  }
+  WheelShard* shard = &g_shards[grpc_core::HashPointer(timer, g_num_shards)];
+  gpr_mu_lock(&shard->mu);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
+    gpr_log(GPR_INFO, "TIMER %p: CANCEL pending=%s", timer,
+            timer->pending ? "true" : "false");
+  }
+  if (timer->pending) {
+    grpc_core::ExecCtx::Run(DEBUG_LOCATION, timer->closure,
+                            GRPC_ERROR_CANCELLED);
+    timer->pending = false;
+    shard->wheel->Remove(timer);
+  }
+  gpr_mu_unlock(&shard->mu);
+}
+
+grpc_timer_check_result RunExpiredTimers(grpc_core::Timestamp now,
+                                         grpc_core::Timestamp* next) {
+  const int64_t now_ms = now.milliseconds_after_process_epoch();
+  int64_t min_timer =
+      g_shared_mutables.min_timer.load(std::memory_order_relaxed);
+  g_last_seen_min_timer = min_timer;
+  if (now_ms < min_timer) {
+    if (next != nullptr) {
+      *next = std::min(
+          *next, grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+                     min_timer));
+    }
+    return GRPC_TIMERS_CHECKED_AND_EMPTY;
+  }
+  if (!gpr_spinlock_trylock(&g_shared_mutables.checker_mu)) {
+    return GRPC_TIMERS_NOT_CHECKED;
+  }
+  grpc_timer_check_result result = GRPC_TIMERS_CHECKED_AND_EMPTY;
+  gpr_mu_lock(&g_shared_mutables.mu);
+  min_timer = kNoTimers;
+  for (size_t i = 0; i < g_num_shards; i++) {
+    WheelShard* shard = &g_shards[i];
+    gpr_mu_lock(&shard->mu);
+    if (shard->next_tick <= now_ms) {
+      size_t n = 0;
+      shard->wheel->Advance(now_ms, [&n](grpc_timer* timer) {
+        timer->pending = false;
+        grpc_core::ExecCtx::Run(DEBUG_LOCATION, timer->closure,
+                                GRPC_ERROR_NONE);
+        n++;
+      });
+      shard->next_tick = shard->wheel->NextEventTick();
+      if (n > 0) result = GRPC_TIMERS_FIRED;
+      if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+        gpr_log(GPR_INFO, "  .. shard[%d] popped %" PRIdPTR,
+                static_cast<int>(i), n);
+      }
+    }
+    min_timer = std::min(min_timer, shard->next_tick);
+    gpr_mu_unlock(&shard->mu);
+  }
+  g_shared_mutables.min_timer.store(min_timer, std::memory_order_relaxed);
+  gpr_mu_unlock(&g_shared_mutables.mu);
+  gpr_spinlock_unlock(&g_shared_mutables.checker_mu);
+  if (next != nullptr) {
+    *next = std::min(
+        *next,
+        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(min_timer));
+  }
+  return result;
+}
+
+grpc_timer_check_result TimerCheck(grpc_core::Timestamp* next) {
+  grpc_core::Timestamp now = grpc_core::Timestamp::Now();
+  // fetch from a thread-local first: this avoids contention on a globally
+  // mutable cacheline in the common case
+  grpc_core::Timestamp min_timer =
+      grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+          g_last_seen_min_timer);
+  if (now < min_timer) {
+    if (next != nullptr) *next = std::min(*next, min_timer);
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+      gpr_log(GPR_INFO, "TIMER CHECK SKIP: now=%" PRId64 " min_timer=%" PRId64,
+              now.milliseconds_after_process_epoch(),
+              min_timer.milliseconds_after_process_epoch());
+    }
+    return GRPC_TIMERS_CHECKED_AND_EMPTY;
+  }
+  grpc_timer_check_result r = RunExpiredTimers(now, next);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
+    gpr_log(GPR_INFO, "TIMER CHECK END: r=%d", r);
+  }
+  return r;
+}
+
+}  // namespace
+
+grpc_timer_vtable grpc_wheel_timer_vtable = {
+    TimerInit,     TimerCancel,       TimerCheck,
+    TimerListInit, TimerListShutdown, TimerConsumeKick};
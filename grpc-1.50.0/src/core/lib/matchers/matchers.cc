@@ -18,13 +18,14 @@
 
 #include <utility>
 
-#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 
+#include "src/core/lib/matchers/regex_cache.h"
+
 namespace grpc_core {
 
 //
@@ -35,7 +36,9 @@ absl::StatusOr<StringMatcher> StringMatcher::Create(Type type,
                                                     absl::string_view matcher,
                                                     bool case_sensitive) {
   if (type == Type::kSafeRegex) {
-    auto regex_matcher = absl::make_unique<RE2>(std::string(matcher));
+    // Regexes are shared through RegexCache, so a config update that keeps
+    // a pattern does not compile it again.
+    auto regex_matcher = RegexCache::Get(matcher);
     if (!regex_matcher->ok()) {
       return absl::InvalidArgumentError(
           "Invalid regex string specified in matcher.");
@@ -50,13 +53,13 @@ StringMatcher::StringMatcher(Type type, absl::string_view matcher,
                              bool case_sensitive)
     : type_(type), string_matcher_(matcher), case_sensitive_(case_sensitive) {}
 
-StringMatcher::StringMatcher(std::unique_ptr<RE2> regex_matcher)
+StringMatcher::StringMatcher(std::shared_ptr<const RE2> regex_matcher)
     : type_(Type::kSafeRegex), regex_matcher_(std::move(regex_matcher)) {}
 
 StringMatcher::StringMatcher(const StringMatcher& other)
     : type_(other.type_), case_sensitive_(other.case_sensitive_) {
   if (type_ == Type::kSafeRegex) {
-    regex_matcher_ = absl::make_unique<RE2>(other.regex_matcher_->pattern());
+    regex_matcher_ = other.regex_matcher_;
   } else {
     string_matcher_ = other.string_matcher_;
   }
@@ -65,7 +68,7 @@ StringMatcher::StringMatcher(const StringMatcher& other)
 StringMatcher& StringMatcher::operator=(const StringMatcher& other) {
   type_ = other.type_;
   if (type_ == Type::kSafeRegex) {
-    regex_matcher_ = absl::make_unique<RE2>(other.regex_matcher_->pattern());
+    regex_matcher_ = other.regex_matcher_;
   } else {
     string_matcher_ = other.string_matcher_;
   }
@@ -122,7 +125,8 @@ bool StringMatcher::Match(absl::string_view value) const {
                  : absl::StrContains(absl::AsciiStrToLower(value),
                                      absl::AsciiStrToLower(string_matcher_));
     case StringMatcher::Type::kSafeRegex:
-      return RE2::FullMatch(std::string(value), *regex_matcher_);
+      return RE2::FullMatch(re2::StringPiece(value.data(), value.size()),
+                            *regex_matcher_);
     default:
       return false;
   }
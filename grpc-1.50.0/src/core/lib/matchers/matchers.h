@@ -61,18 +61,18 @@ class StringMatcher {
   // Valid for kExact, kPrefix, kSuffix and kContains.
   const std::string& string_matcher() const { return string_matcher_; }
 
-  // Valid for kSafeRegex.
-  RE2* regex_matcher() const { return regex_matcher_.get(); }
+  // Valid for kSafeRegex. Copies of a matcher share the compiled regex.
+  const RE2* regex_matcher() const { return regex_matcher_.get(); }
 
   bool case_sensitive() const { return case_sensitive_; }
 
  private:
   StringMatcher(Type type, absl::string_view matcher, bool case_sensitive);
-  explicit StringMatcher(std::unique_ptr<RE2> regex_matcher);
+  explicit StringMatcher(std::shared_ptr<const RE2> regex_matcher);
 
   Type type_ = Type::kExact;
   std::string string_matcher_;
-  std::unique_ptr<RE2> regex_matcher_;
+  std::shared_ptr<const RE2> regex_matcher_;
   bool case_sensitive_ = true;
 };
 
@@ -132,7 +132,7 @@ class HeaderMatcher {
   }
 
   // Valid for kSafeRegex.
-  RE2* regex_matcher() const { return matcher_.regex_matcher(); }
+  const RE2* regex_matcher() const { return matcher_.regex_matcher(); }
 
   bool Match(const absl::optional<absl::string_view>& value) const;
 
@@ -0,0 +1,82 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/matchers/regex_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+
+namespace grpc_core {
+
+namespace {
+
+// Everything in RE2::Options that affects how a pattern is compiled or
+// matched, followed by the pattern itself.
+std::string CacheKey(absl::string_view pattern, const RE2::Options& options) {
+  return absl::StrCat(options.ParseFlags(), ",", options.longest_match(), ",",
+                      options.log_errors(), ",", options.max_mem(), ":",
+                      pattern);
+}
+
+}  // namespace
+
+RegexCache* RegexCache::Instance() {
+  static RegexCache* cache = new RegexCache();
+  return cache;
+}
+
+std::shared_ptr<const RE2> RegexCache::Get(absl::string_view pattern,
+                                           const RE2::Options& options) {
+  return Instance()->GetInternal(pattern, options);
+}
+
+std::shared_ptr<const RE2> RegexCache::GetInternal(
+    absl::string_view pattern, const RE2::Options& options) {
+  std::string key = CacheKey(pattern, options);
+  {
+    MutexLock lock(&mu_);
+    auto it = regexes_.find(key);
+    if (it != regexes_.end()) {
+      std::shared_ptr<const RE2> regex = it->second.lock();
+      if (regex != nullptr) return regex;
+    }
+  }
+  // Compile without holding the lock, since large patterns can take a while.
+  auto regex = std::make_shared<const RE2>(
+      re2::StringPiece(pattern.data(), pattern.size()), options);
+  if (!regex->ok()) return regex;
+  MutexLock lock(&mu_);
+  std::weak_ptr<const RE2>& entry = regexes_[std::move(key)];
+  // Another thread may have compiled the same pattern in the meantime.
+  std::shared_ptr<const RE2> existing = entry.lock();
+  if (existing != nullptr) return existing;
+  entry = regex;
+  if (regexes_.size() > purge_threshold_) {
+    for (auto it = regexes_.begin(); it != regexes_.end();) {
+      if (it->second.expired()) {
+        it = regexes_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    purge_threshold_ = std::max<size_t>(64, regexes_.size() * 2);
+  }
+  return regex;
+}
+
+}  // namespace grpc_core
@@ -0,0 +1,65 @@
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GRPC_CORE_LIB_MATCHERS_REGEX_CACHE_H
+#define GRPC_CORE_LIB_MATCHERS_REGEX_CACHE_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "re2/re2.h"
+
+#include "src/core/lib/gprpp/sync.h"
+
+namespace grpc_core {
+
+// Process-wide cache of compiled regexes, keyed by pattern and options.
+//
+// xDS and RBAC config updates usually carry mostly the same patterns as the
+// config they replace. Looking the patterns up here lets the new config share
+// the compiled RE2 objects of the old one instead of compiling them again.
+// The cache holds only weak references: a regex is freed once the last
+// matcher using it goes away.
+class RegexCache {
+ public:
+  // Returns the compiled regex for pattern. The caller must check ok() on
+  // the result; regexes that fail to compile are not cached.
+  static std::shared_ptr<const RE2> Get(
+      absl::string_view pattern, const RE2::Options& options = RE2::Options());
+
+ private:
+  RegexCache() = default;
+
+  static RegexCache* Instance();
+
+  std::shared_ptr<const RE2> GetInternal(absl::string_view pattern,
+                                         const RE2::Options& options);
+
+  Mutex mu_;
+  std::map<std::string, std::weak_ptr<const RE2>, std::less<>> regexes_
+      ABSL_GUARDED_BY(mu_);
+  // Expired entries are purged when the map grows past this size.
+  size_t purge_threshold_ ABSL_GUARDED_BY(mu_) = 64;
+};
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_LIB_MATCHERS_REGEX_CACHE_H
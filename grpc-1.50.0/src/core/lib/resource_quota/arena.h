@@ -88,6 +88,9 @@ class Arena {
     return &p->t;
   }
 
+  // The allocator this arena's memory is charged to.
+  MemoryAllocator* memory_allocator() const { return memory_allocator_; }
+
  private:
   struct Zone {
     Zone* prev;
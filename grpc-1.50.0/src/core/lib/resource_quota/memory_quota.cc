@@ -583,6 +583,23 @@ double PressureTracker::AddSampleAndGetControlValue(double sample) {
 
 }  // namespace memory_quota_detail
 
+int BufferShrinkShiftForMemoryPressure(double pressure, int current_shift) {
+  static constexpr double kFirstStepPressure = 0.5;
+  static constexpr double kStepPressure = 0.1;
+  static constexpr double kGrowBackHysteresis = 0.05;
+  auto shift_for = [](double pressure) {
+    if (pressure < kFirstStepPressure) return 0;
+    return std::min(kMaxBufferShrinkShift,
+                    1 + static_cast<int>((pressure - kFirstStepPressure) /
+                                         kStepPressure));
+  };
+  int shift = shift_for(pressure);
+  if (shift < current_shift) {
+    shift = std::min(current_shift, shift_for(pressure + kGrowBackHysteresis));
+  }
+  return shift;
+}
+
 //
 // MemoryQuota
 //
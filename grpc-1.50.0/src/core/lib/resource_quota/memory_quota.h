@@ -438,6 +438,16 @@ class GrpcMemoryAllocatorImpl final : public EventEngineMemoryAllocatorImpl {
   std::string name_;
 };
 
+// Per-connection buffers (endpoint read buffers, HTTP/2 flow control window
+// targets and HPACK tables) shrink together as memory pressure rises: each is
+// divided by 2^shift, where shift is the value returned here. The shift is 0
+// below 50% pressure and grows by one for every further 10%, up to
+// kMaxBufferShrinkShift. Buffers shrink as soon as pressure crosses a step,
+// but only grow back once it is 5% below it, so that their sizes do not flap
+// around a step boundary. current_shift is the shift the caller applies now.
+constexpr int kMaxBufferShrinkShift = 4;
+int BufferShrinkShiftForMemoryPressure(double pressure, int current_shift);
+
 // MemoryOwner is an enhanced MemoryAllocator that can also reclaim memory, and
 // be rebound to a different memory quota.
 // Different modules should not share a MemoryOwner between themselves, instead
@@ -464,6 +474,13 @@ class MemoryOwner final : public MemoryAllocator {
     return impl()->GetPressureInfo();
   }
 
+  // Shift to apply to per-connection buffer sizes under the current memory
+  // pressure; see BufferShrinkShiftForMemoryPressure().
+  int BufferShrinkShift(int current_shift) const {
+    return BufferShrinkShiftForMemoryPressure(
+        GetPressureInfo().pressure_control_value, current_shift);
+  }
+
   template <typename T, typename... Args>
   OrphanablePtr<T> MakeOrphanable(Args&&... args) {
     return OrphanablePtr<T>(New<T>(std::forward<Args>(args)...));
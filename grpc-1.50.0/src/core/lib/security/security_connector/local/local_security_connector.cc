@@ -66,6 +66,7 @@
 
 #define GRPC_UDS_URI_PATTERN "unix:"
 #define GRPC_ABSTRACT_UDS_URI_PATTERN "unix-abstract:"
+#define GRPC_SHM_URI_PATTERN "unix-shm:"
 #define GRPC_LOCAL_TRANSPORT_SECURITY_TYPE "local"
 
 namespace {
@@ -286,7 +287,8 @@ grpc_local_channel_security_connector_create(
       args.GetString(GRPC_ARG_SERVER_URI).value_or("");
   if (creds->connect_type() == UDS &&
       !absl::StartsWith(server_uri_str, GRPC_UDS_URI_PATTERN) &&
-      !absl::StartsWith(server_uri_str, GRPC_ABSTRACT_UDS_URI_PATTERN)) {
+      !absl::StartsWith(server_uri_str, GRPC_ABSTRACT_UDS_URI_PATTERN) &&
+      !absl::StartsWith(server_uri_str, GRPC_SHM_URI_PATTERN)) {
     gpr_log(GPR_ERROR,
             "Invalid UDS target name to "
             "grpc_local_channel_security_connector_create()");
@@ -317,6 +317,7 @@ class FilterStackCall final : public Call {
       : Call(arena, args.server_transport_data == nullptr, args.send_deadline),
         cq_(args.cq),
         channel_(args.channel->Ref()),
+        method_call_size_estimator_(args.method_call_size_estimator),
         stream_op_payload_(context_) {}
 
   static void ReleaseCall(void* call, grpc_error_handle);
@@ -348,6 +349,8 @@ class FilterStackCall final : public Call {
   grpc_completion_queue* cq_;
   grpc_polling_entity pollent_;
   RefCountedPtr<Channel> channel_;
+  // Owned by channel_, which outlives the call.
+  CallSizeEstimator* const method_call_size_estimator_;
   gpr_cycle_counter start_time_ = gpr_get_cycle_counter();
 
   /** has grpc_call_unref been called */
@@ -530,7 +533,11 @@ grpc_error_handle FilterStackCall::Create(grpc_call_create_args* args,
   FilterStackCall* call;
   grpc_error_handle error = GRPC_ERROR_NONE;
   grpc_channel_stack* channel_stack = channel->channel_stack();
-  size_t initial_size = channel->CallSizeEstimate();
+  CallSizeEstimator* method_estimator = args->method_call_size_estimator;
+  size_t initial_size =
+      method_estimator != nullptr && method_estimator->has_estimate()
+          ? method_estimator->CallSizeEstimate()
+          : channel->CallSizeEstimate();
   GRPC_STATS_INC_CALL_INITIAL_SIZE(initial_size);
   size_t call_alloc_size =
       GPR_ROUND_UP_TO_ALIGNMENT_SIZE(sizeof(FilterStackCall)) +
@@ -634,9 +641,14 @@ void FilterStackCall::SetCompletionQueue(grpc_completion_queue* cq) {
 void FilterStackCall::ReleaseCall(void* call, grpc_error_handle /*error*/) {
   auto* c = static_cast<FilterStackCall*>(call);
   RefCountedPtr<Channel> channel = std::move(c->channel_);
+  CallSizeEstimator* method_estimator = c->method_call_size_estimator_;
   Arena* arena = c->arena();
   c->~FilterStackCall();
-  channel->UpdateCallSizeEstimate(arena->Destroy());
+  size_t arena_size = arena->Destroy();
+  channel->UpdateCallSizeEstimate(arena_size);
+  if (method_estimator != nullptr) {
+    method_estimator->UpdateCallSizeEstimate(arena_size);
+  }
 }
 
 void FilterStackCall::DestroyCall(void* call, grpc_error_handle /*error*/) {
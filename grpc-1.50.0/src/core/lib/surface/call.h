@@ -65,6 +65,10 @@ typedef struct grpc_call_create_args {
   absl::optional<grpc_core::Slice> authority;
 
   grpc_core::Timestamp send_deadline;
+
+  /* if not NULL, the arena size estimate for the call's method; used in
+     preference to the channel's estimate */
+  grpc_core::CallSizeEstimator* method_call_size_estimator = nullptr;
 } grpc_call_create_args;
 
 /* Create a new call based on \a args.
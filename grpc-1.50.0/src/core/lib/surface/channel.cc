@@ -69,8 +69,8 @@ Channel::Channel(bool is_client, std::string target,
                  RefCountedPtr<grpc_channel_stack> channel_stack)
     : is_client_(is_client),
       compression_options_(compression_options),
-      call_size_estimate_(channel_stack->call_stack_size +
-                          grpc_call_get_initial_size_estimate()),
+      call_size_estimator_(channel_stack->call_stack_size +
+                           grpc_call_get_initial_size_estimate()),
       channelz_node_(channel_args.GetObjectRef<channelz::ChannelNode>()),
       allocator_(channel_args.GetObject<ResourceQuota>()
                      ->memory_quota()
@@ -234,7 +234,7 @@ absl::StatusOr<RefCountedPtr<Channel>> Channel::Create(
   return CreateWithBuilder(&builder);
 }
 
-void Channel::UpdateCallSizeEstimate(size_t size) {
+void CallSizeEstimator::UpdateCallSizeEstimate(size_t size) {
   size_t cur = call_size_estimate_.load(std::memory_order_relaxed);
   if (cur < size) {
     // size grew: update estimate
@@ -287,10 +287,15 @@ static grpc_call* grpc_channel_create_call_internal(
     grpc_channel* c_channel, grpc_call* parent_call, uint32_t propagation_mask,
     grpc_completion_queue* cq, grpc_pollset_set* pollset_set_alternative,
     grpc_core::Slice path, absl::optional<grpc_core::Slice> authority,
-    grpc_core::Timestamp deadline) {
+    grpc_core::Timestamp deadline,
+    grpc_core::CallSizeEstimator* method_call_size_estimator = nullptr) {
   auto channel = grpc_core::Channel::FromC(c_channel)->Ref();
   GPR_ASSERT(channel->is_client());
   GPR_ASSERT(!(cq != nullptr && pollset_set_alternative != nullptr));
+  if (method_call_size_estimator == nullptr) {
+    method_call_size_estimator =
+        channel->MethodCallSizeEstimator(path.as_string_view());
+  }
 
   grpc_call_create_args args;
   args.channel = std::move(channel);
@@ -303,6 +308,7 @@ static grpc_call* grpc_channel_create_call_internal(
   args.path = std::move(path);
   args.authority = std::move(authority);
   args.send_deadline = deadline;
+  args.method_call_size_estimator = method_call_size_estimator;
 
   grpc_call* call;
   GRPC_LOG_IF_ERROR("call_create", grpc_call_create(&args, &call));
@@ -353,7 +359,7 @@ RegisteredCall::RegisteredCall(const char* method_arg, const char* host_arg) {
 }
 
 RegisteredCall::RegisteredCall(const RegisteredCall& other)
-    : path(other.path.Ref()) {
+    : path(other.path.Ref()), call_size_estimator(other.call_size_estimator) {
   if (other.authority.has_value()) {
     authority = other.authority->Ref();
   }
@@ -387,7 +393,18 @@ RegisteredCall* Channel::RegisterCall(const char* method, const char* host) {
   }
   auto insertion_result = registration_table_.map.insert(
       {std::move(key), RegisteredCall(method, host)});
-  return &insertion_result.first->second;
+  RegisteredCall* rc = &insertion_result.first->second;
+  rc->call_size_estimator = MethodCallSizeEstimator(rc->path.as_string_view());
+  return rc;
+}
+
+CallSizeEstimator* Channel::MethodCallSizeEstimator(absl::string_view path) {
+  MutexLock lock(&method_call_size_estimators_.mu);
+  auto& map = method_call_size_estimators_.map;
+  auto it = map.find(path);
+  if (it != map.end()) return &it->second;
+  if (map.size() >= MethodCallSizeEstimators::kMaxMethods) return nullptr;
+  return &map.emplace(std::string(path), 0).first->second;
 }
 
 }  // namespace grpc_core
@@ -418,7 +435,8 @@ grpc_call* grpc_channel_create_registered_call(
       rc->authority.has_value()
           ? absl::optional<grpc_core::Slice>(rc->authority->Ref())
           : absl::nullopt,
-      grpc_core::Timestamp::FromTimespecRoundUp(deadline));
+      grpc_core::Timestamp::FromTimespecRoundUp(deadline),
+      rc->call_size_estimator);
 
   return call;
 }
@@ -25,6 +25,7 @@
 #include <stdint.h>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
@@ -84,9 +85,50 @@ void grpc_channel_update_call_size_estimate(grpc_channel* channel, size_t size);
 
 namespace grpc_core {
 
+// Running estimate of how large a call's arena should be, learned from the
+// arenas of previous calls. It jumps up immediately when a call needs more
+// and decays slowly when calls need less.
+class CallSizeEstimator {
+ public:
+  explicit CallSizeEstimator(size_t initial_estimate)
+      : call_size_estimate_(initial_estimate) {}
+  CallSizeEstimator(const CallSizeEstimator& other)
+      : call_size_estimate_(
+            other.call_size_estimate_.load(std::memory_order_relaxed)) {}
+  CallSizeEstimator& operator=(const CallSizeEstimator&) = delete;
+
+  // False until the first call has been recorded, for estimators that start
+  // without an initial estimate.
+  bool has_estimate() const {
+    return call_size_estimate_.load(std::memory_order_relaxed) != 0;
+  }
+
+  size_t CallSizeEstimate() const {
+    // We round up our current estimate to the NEXT value of kRoundUpSize.
+    // This ensures:
+    //  1. a consistent size allocation when our estimate is drifting slowly
+    //     (which is common) - which tends to help most allocators reuse memory
+    //  2. a small amount of allowed growth over the estimate without hitting
+    //     the arena size doubling case, reducing overall memory usage
+    static constexpr size_t kRoundUpSize = 256;
+    return (call_size_estimate_.load(std::memory_order_relaxed) +
+            2 * kRoundUpSize) &
+           ~(kRoundUpSize - 1);
+  }
+
+  void UpdateCallSizeEstimate(size_t size);
+
+ private:
+  std::atomic<size_t> call_size_estimate_;
+};
+
 struct RegisteredCall {
   Slice path;
   absl::optional<Slice> authority;
+  // The channel's arena size estimate for this method (see
+  // Channel::MethodCallSizeEstimator), looked up once at registration. Null if
+  // the channel is already tracking too many methods.
+  CallSizeEstimator* call_size_estimator = nullptr;
 
   explicit RegisteredCall(const char* method_arg, const char* host_arg);
   RegisteredCall(const RegisteredCall& other);
@@ -105,6 +147,18 @@ struct CallRegistrationTable {
   int method_registration_attempts ABSL_GUARDED_BY(mu) = 0;
 };
 
+// Arena size estimates for calls to each method, keyed by path. Channels often
+// carry methods with very different footprints; a per-method estimate avoids
+// sizing every call's arena for the largest of them.
+struct MethodCallSizeEstimators {
+  // Paths of unregistered calls come straight from the application, so the
+  // table is bounded; calls to methods past the limit use the channel's
+  // estimate.
+  static constexpr size_t kMaxMethods = 64;
+  Mutex mu;
+  std::map<std::string, CallSizeEstimator, std::less<>> map ABSL_GUARDED_BY(mu);
+};
+
 class Channel : public RefCounted<Channel>,
                 public CppImplOf<Channel, grpc_channel> {
  public:
@@ -125,23 +179,20 @@ class Channel : public RefCounted<Channel>,
   channelz::ChannelNode* channelz_node() const { return channelz_node_.get(); }
 
   size_t CallSizeEstimate() {
-    // We round up our current estimate to the NEXT value of kRoundUpSize.
-    // This ensures:
-    //  1. a consistent size allocation when our estimate is drifting slowly
-    //     (which is common) - which tends to help most allocators reuse memory
-    //  2. a small amount of allowed growth over the estimate without hitting
-    //     the arena size doubling case, reducing overall memory usage
-    static constexpr size_t kRoundUpSize = 256;
-    return (call_size_estimate_.load(std::memory_order_relaxed) +
-            2 * kRoundUpSize) &
-           ~(kRoundUpSize - 1);
+    return call_size_estimator_.CallSizeEstimate();
   }
 
-  void UpdateCallSizeEstimate(size_t size);
+  void UpdateCallSizeEstimate(size_t size) {
+    call_size_estimator_.UpdateCallSizeEstimate(size);
+  }
   absl::string_view target() const { return target_; }
   MemoryAllocator* allocator() { return &allocator_; }
   bool is_client() const { return is_client_; }
   RegisteredCall* RegisterCall(const char* method, const char* host);
+  // Returns the arena size estimate for calls to \a path, shared by registered
+  // and unregistered calls, or null if too many methods are tracked already.
+  // The estimator lives as long as the channel.
+  CallSizeEstimator* MethodCallSizeEstimator(absl::string_view path);
 
   int TestOnlyRegisteredCalls() {
     MutexLock lock(&registration_table_.mu);
@@ -160,8 +211,9 @@ class Channel : public RefCounted<Channel>,
 
   const bool is_client_;
   const grpc_compression_options compression_options_;
-  std::atomic<size_t> call_size_estimate_;
+  CallSizeEstimator call_size_estimator_;
   CallRegistrationTable registration_table_;
+  MethodCallSizeEstimators method_call_size_estimators_;
   RefCountedPtr<channelz::ChannelNode> channelz_node_;
   MemoryAllocator allocator_;
   std::string target_;
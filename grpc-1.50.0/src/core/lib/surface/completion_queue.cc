@@ -213,6 +213,8 @@ struct cq_vtable {
                  void* done_arg, grpc_cq_completion* storage, bool internal);
   grpc_event (*next)(grpc_completion_queue* cq, gpr_timespec deadline,
                      void* reserved);
+  int (*next_batch)(grpc_completion_queue* cq, grpc_event* events,
+                    int max_events, gpr_timespec deadline, void* reserved);
   grpc_event (*pluck)(grpc_completion_queue* cq, void* tag,
                       gpr_timespec deadline, void* reserved);
 };
@@ -236,6 +238,10 @@ class CqEventQueue {
 
   bool Push(grpc_cq_completion* c);
   grpc_cq_completion* Pop();
+  /* Pops up to max completions into out under a single acquisition of
+   * queue_lock_ and returns how many were popped. Like Pop(), may return 0
+   * even if the queue is not empty */
+  size_t PopMany(grpc_cq_completion** out, size_t max);
 
  private:
   /* Spinlock to serialize consumers i.e pop() operations */
@@ -398,6 +404,10 @@ static void cq_end_op_for_callback(
 static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
                           void* reserved);
 
+static int cq_next_batch(grpc_completion_queue* cq, grpc_event* events,
+                         int max_events, gpr_timespec deadline,
+                         void* reserved);
+
 static grpc_event cq_pluck(grpc_completion_queue* cq, void* tag,
                            gpr_timespec deadline, void* reserved);
 
@@ -417,15 +427,15 @@ static const cq_vtable g_cq_vtable[] = {
     /* GRPC_CQ_NEXT */
     {GRPC_CQ_NEXT, sizeof(cq_next_data), cq_init_next, cq_shutdown_next,
      cq_destroy_next, cq_begin_op_for_next, cq_end_op_for_next, cq_next,
-     nullptr},
+     cq_next_batch, nullptr},
     /* GRPC_CQ_PLUCK */
     {GRPC_CQ_PLUCK, sizeof(cq_pluck_data), cq_init_pluck, cq_shutdown_pluck,
      cq_destroy_pluck, cq_begin_op_for_pluck, cq_end_op_for_pluck, nullptr,
-     cq_pluck},
+     nullptr, cq_pluck},
     /* GRPC_CQ_CALLBACK */
     {GRPC_CQ_CALLBACK, sizeof(cq_callback_data), cq_init_callback,
      cq_shutdown_callback, cq_destroy_callback, cq_begin_op_for_callback,
-     cq_end_op_for_callback, nullptr, nullptr},
+     cq_end_op_for_callback, nullptr, nullptr, nullptr},
 };
 
 #define DATA_FROM_CQ(cq) ((void*)((cq) + 1))
@@ -500,6 +510,27 @@ grpc_cq_completion* CqEventQueue::Pop() {
   return c;
 }
 
+size_t CqEventQueue::PopMany(grpc_cq_completion** out, size_t max) {
+  size_t n = 0;
+
+  if (gpr_spinlock_trylock(&queue_lock_)) {
+    bool is_empty = false;
+    while (n < max) {
+      grpc_cq_completion* c =
+          reinterpret_cast<grpc_cq_completion*>(queue_.PopAndCheckEnd(&is_empty));
+      if (c == nullptr) break;
+      out[n++] = c;
+    }
+    gpr_spinlock_unlock(&queue_lock_);
+  }
+
+  if (n > 0) {
+    num_queue_items_.fetch_sub(n, std::memory_order_relaxed);
+  }
+
+  return n;
+}
+
 grpc_completion_queue* grpc_completion_queue_create_internal(
     grpc_cq_completion_type completion_type, grpc_cq_polling_type polling_type,
     grpc_completion_queue_functor* shutdown_callback) {
@@ -952,6 +983,154 @@ static void dump_pending_tags(grpc_completion_queue* cq) {
 static void dump_pending_tags(grpc_completion_queue* /*cq*/) {}
 #endif
 
+static grpc_event completion_to_event(grpc_cq_completion* c) {
+  grpc_event ev;
+  ev.type = GRPC_OP_COMPLETE;
+  ev.success = c->next & 1u;
+  ev.tag = c->tag;
+  c->done(c->done_arg, c);
+  return ev;
+}
+
+/* Number of completions popped per acquisition of the queue lock when
+   draining a batch */
+#define CQ_NEXT_BATCH_CHUNK 16
+
+/* Appends completions that are already queued to events[*num_events..] until
+   max_events are stored or the queue looks empty. Does not poll */
+static void drain_ready_events(cq_next_data* cqd, grpc_event* events,
+                               int* num_events, int max_events) {
+  grpc_cq_completion* chunk[CQ_NEXT_BATCH_CHUNK];
+  while (*num_events < max_events) {
+    size_t n = cqd->queue.PopMany(
+        chunk, std::min<size_t>(CQ_NEXT_BATCH_CHUNK,
+                                static_cast<size_t>(max_events - *num_events)));
+    if (n == 0) break;
+    for (size_t i = 0; i < n; i++) {
+      events[(*num_events)++] = completion_to_event(chunk[i]);
+    }
+  }
+}
+
+/* Implementation of grpc_completion_queue_next_batch: blocks like cq_next
+   until the first event, then returns it together with up to max_events - 1
+   events that are already queued. GRPC_QUEUE_TIMEOUT and GRPC_QUEUE_SHUTDOWN
+   are only ever returned alone. cq_next keeps its own single-pop loop so that
+   callers of grpc_completion_queue_next do not pay for the batch drain */
+static int cq_next_events(grpc_completion_queue* cq, grpc_event* events,
+                          int max_events, gpr_timespec deadline) {
+  int num_events = 0;
+  cq_next_data* cqd = static_cast<cq_next_data*> DATA_FROM_CQ(cq);
+
+  dump_pending_tags(cq);
+
+  GRPC_CQ_INTERNAL_REF(cq, "next");
+
+  grpc_core::Timestamp deadline_millis =
+      grpc_core::Timestamp::FromTimespecRoundUp(deadline);
+  cq_is_finished_arg is_finished_arg = {
+      cqd->things_queued_ever.load(std::memory_order_relaxed),
+      cq,
+      deadline_millis,
+      nullptr,
+      nullptr,
+      true};
+  ExecCtxNext exec_ctx(&is_finished_arg);
+  for (;;) {
+    grpc_core::Timestamp iteration_deadline = deadline_millis;
+
+    if (is_finished_arg.stolen_completion != nullptr) {
+      grpc_cq_completion* c = is_finished_arg.stolen_completion;
+      is_finished_arg.stolen_completion = nullptr;
+      events[num_events++] = completion_to_event(c);
+      drain_ready_events(cqd, events, &num_events, max_events);
+      break;
+    }
+
+    drain_ready_events(cqd, events, &num_events, max_events);
+
+    if (num_events > 0) {
+      break;
+    } else {
+      /* If nothing was popped it means either the queue is empty OR in an
+         transient inconsistent state. If it is the latter, we shold do a
+         0-timeout poll so that the thread comes back quickly from poll to make
+         a second attempt at popping. Not doing this can potentially deadlock
+         this thread forever (if the deadline is infinity) */
+      if (cqd->queue.num_items() > 0) {
+        iteration_deadline = grpc_core::Timestamp::ProcessEpoch();
+      }
+    }
+
+    if (cqd->pending_events.load(std::memory_order_acquire) == 0) {
+      /* Before returning, check if the queue has any items left over (since
+         MultiProducerSingleConsumerQueue::Pop() can sometimes return NULL
+         even if the queue is not empty. If so, keep retrying but do not
+         return GRPC_QUEUE_SHUTDOWN */
+      if (cqd->queue.num_items() > 0) {
+        /* Go to the beginning of the loop. No point doing a poll because
+           (cq->shutdown == true) is only possible when there is no pending
+           work (i.e cq->pending_events == 0) and any outstanding completion
+           events should have already been queued on this cq */
+        continue;
+      }
+
+      events[0].type = GRPC_QUEUE_SHUTDOWN;
+      events[0].success = 0;
+      num_events = 1;
+      break;
+    }
+
+    if (!is_finished_arg.first_loop &&
+        grpc_core::Timestamp::Now() >= deadline_millis) {
+      events[0].type = GRPC_QUEUE_TIMEOUT;
+      events[0].success = 0;
+      num_events = 1;
+      dump_pending_tags(cq);
+      break;
+    }
+
+    /* The main polling work happens in grpc_pollset_work */
+    gpr_mu_lock(cq->mu);
+    cq->num_polls++;
+    grpc_error_handle err = cq->poller_vtable->work(
+        POLLSET_FROM_CQ(cq), nullptr, iteration_deadline);
+    gpr_mu_unlock(cq->mu);
+
+    if (!GRPC_ERROR_IS_NONE(err)) {
+      gpr_log(GPR_ERROR, "Completion queue next failed: %s",
+              grpc_error_std_string(err).c_str());
+      GRPC_ERROR_UNREF(err);
+      if (err == GRPC_ERROR_CANCELLED) {
+        events[0].type = GRPC_QUEUE_SHUTDOWN;
+      } else {
+        events[0].type = GRPC_QUEUE_TIMEOUT;
+      }
+      events[0].success = 0;
+      num_events = 1;
+      dump_pending_tags(cq);
+      break;
+    }
+    is_finished_arg.first_loop = false;
+  }
+
+  if (cqd->queue.num_items() > 0 &&
+      cqd->pending_events.load(std::memory_order_acquire) > 0) {
+    gpr_mu_lock(cq->mu);
+    (void)cq->poller_vtable->kick(POLLSET_FROM_CQ(cq), nullptr);
+    gpr_mu_unlock(cq->mu);
+  }
+
+  for (int i = 0; i < num_events; i++) {
+    GRPC_SURFACE_TRACE_RETURNED_EVENT(cq, &events[i]);
+  }
+  GRPC_CQ_INTERNAL_UNREF(cq, "next");
+
+  GPR_ASSERT(is_finished_arg.stolen_completion == nullptr);
+
+  return num_events;
+}
+
 static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
                           void* reserved) {
   grpc_event ret;
@@ -1078,6 +1257,24 @@ static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
   return ret;
 }
 
+static int cq_next_batch(grpc_completion_queue* cq, grpc_event* events,
+                         int max_events, gpr_timespec deadline,
+                         void* reserved) {
+  GRPC_API_TRACE(
+      "grpc_completion_queue_next_batch("
+      "cq=%p, events=%p, max_events=%d, "
+      "deadline=gpr_timespec { tv_sec: %" PRId64
+      ", tv_nsec: %d, clock_type: %d }, "
+      "reserved=%p)",
+      7,
+      (cq, events, max_events, deadline.tv_sec, deadline.tv_nsec,
+       (int)deadline.clock_type, reserved));
+  GPR_ASSERT(!reserved);
+  GPR_ASSERT(max_events > 0);
+
+  return cq_next_events(cq, events, max_events, deadline);
+}
+
 /* Finishes the completion queue shutdown. This means that there are no more
    completion events / tags expected from the completion queue
    - Must be called under completion queue lock
@@ -1125,6 +1322,12 @@ grpc_event grpc_completion_queue_next(grpc_completion_queue* cq,
   return cq->vtable->next(cq, deadline, reserved);
 }
 
+int grpc_completion_queue_next_batch(grpc_completion_queue* cq,
+                                     grpc_event* events, int max_events,
+                                     gpr_timespec deadline, void* reserved) {
+  return cq->vtable->next_batch(cq, events, max_events, deadline, reserved);
+}
+
 static int add_plucker(grpc_completion_queue* cq, void* tag,
                        grpc_pollset_worker** worker) {
   cq_pluck_data* cqd = static_cast<cq_pluck_data*> DATA_FROM_CQ(cq);
@@ -198,7 +198,22 @@ class Server::RequestMatcherInterface {
 class Server::RealRequestMatcher : public RequestMatcherInterface {
  public:
   explicit RealRequestMatcher(Server* server)
-      : server_(server), requests_per_cq_(server->cqs_.size()) {}
+      : server_(server),
+        requests_per_cq_(server->cqs_.size()),
+        max_pending_(std::max(0, server->channel_args_
+                                     .GetInt(GRPC_ARG_SERVER_MAX_PENDING_CALLS)
+                                     .value_or(0))),
+        fail_expired_(server->channel_args_
+                          .GetBool(GRPC_ARG_SERVER_FAIL_EXPIRED_CALLS)
+                          .value_or(false)),
+        target_delay_(Duration::Milliseconds(std::max(
+            0, server->channel_args_
+                   .GetInt(GRPC_ARG_SERVER_PENDING_CALL_TARGET_DELAY_MS)
+                   .value_or(0)))),
+        interval_(Duration::Milliseconds(std::max(
+            1, server->channel_args_
+                   .GetInt(GRPC_ARG_SERVER_PENDING_CALL_INTERVAL_MS)
+                   .value_or(100)))) {}
 
   ~RealRequestMatcher() override {
     for (LockedMultiProducerSingleConsumerQueue& queue : requests_per_cq_) {
@@ -208,10 +223,11 @@ class Server::RealRequestMatcher : public RequestMatcherInterface {
 
   void ZombifyPending() override {
     while (!pending_.empty()) {
-      CallData* calld = pending_.front();
+      CallData* calld = pending_.front().calld;
       calld->SetState(CallData::CallState::ZOMBIED);
       calld->KillZombie();
       pending_.pop();
+      RecordPendingCallDequeued();
     }
   }
 
@@ -235,27 +251,31 @@ class Server::RealRequestMatcher : public RequestMatcherInterface {
     if (requests_per_cq_[request_queue_index].Push(&call->mpscq_node)) {
       /* this was the first queued request: we need to lock and start
          matching calls */
-      struct PendingCall {
+      struct NextPendingCall {
         RequestedCall* rc = nullptr;
         CallData* calld;
       };
-      auto pop_next_pending = [this, request_queue_index] {
-        PendingCall pending_call;
+      std::vector<ShedCall> shed;
+      auto pop_next_pending = [this, request_queue_index, &shed] {
+        NextPendingCall pending_call;
         {
           MutexLock lock(&server_->mu_call_);
+          ShedExpiredPendingLocked(&shed);
           if (!pending_.empty()) {
             pending_call.rc = reinterpret_cast<RequestedCall*>(
                 requests_per_cq_[request_queue_index].Pop());
             if (pending_call.rc != nullptr) {
-              pending_call.calld = pending_.front();
+              pending_call.calld = pending_.front().calld;
               pending_.pop();
+              RecordPendingCallDequeued();
             }
           }
         }
         return pending_call;
       };
       while (true) {
-        PendingCall next_pending = pop_next_pending();
+        NextPendingCall next_pending = pop_next_pending();
+        FailShedCalls(&shed);
         if (next_pending.rc == nullptr) break;
         if (!next_pending.calld->MaybeActivate()) {
           // Zombied Call
@@ -269,6 +289,10 @@ class Server::RealRequestMatcher : public RequestMatcherInterface {
 
   void MatchOrQueue(size_t start_request_queue_index,
                     CallData* calld) override {
+    if (fail_expired_ && calld->deadline() <= ExecCtx::Get()->Now()) {
+      ShedCall(calld, ShedReason::kDeadlineExceeded).Fail(server_);
+      return;
+    }
     for (size_t i = 0; i < requests_per_cq_.size(); i++) {
       size_t cq_idx = (start_request_queue_index + i) % requests_per_cq_.size();
       RequestedCall* rc =
@@ -298,11 +322,18 @@ class Server::RealRequestMatcher : public RequestMatcherInterface {
         }
       }
       if (rc == nullptr) {
-        calld->SetState(CallData::CallState::PENDING);
-        pending_.push(calld);
-        return;
+        if (max_pending_ == 0 || pending_.size() < max_pending_) {
+          calld->SetState(CallData::CallState::PENDING);
+          pending_.push(PendingCall{calld, ExecCtx::Get()->Now()});
+          RecordPendingCallQueued();
+          return;
+        }
       }
     }
+    if (rc == nullptr) {
+      ShedCall(calld, ShedReason::kQueueFull).Fail(server_);
+      return;
+    }
     calld->SetState(CallData::CallState::ACTIVATED);
     calld->Publish(cq_idx, rc);
   }
@@ -310,9 +341,126 @@ class Server::RealRequestMatcher : public RequestMatcherInterface {
   Server* server() const override { return server_; }
 
  private:
+  struct PendingCall {
+    CallData* calld;
+    Timestamp queued_at;
+  };
+
+  enum class ShedReason { kQueueFull, kDeadlineExceeded, kQueueDelay };
+
+  // A call refused by admission control. Collected under mu_call_ and failed
+  // once the lock is released, since cancelling a call may run closures
+  // inline.
+  struct ShedCall {
+    ShedCall(CallData* c, ShedReason r) : calld(c), reason(r) {}
+
+    void Fail(Server* server) {
+      channelz::ServerNode* channelz_node = server->channelz_node();
+      switch (reason) {
+        case ShedReason::kQueueFull:
+          if (channelz_node != nullptr) {
+            channelz_node->RecordCallShedQueueFull();
+          }
+          calld->Shed(GRPC_STATUS_RESOURCE_EXHAUSTED,
+                      "Server pending call queue is full");
+          break;
+        case ShedReason::kDeadlineExceeded:
+          if (channelz_node != nullptr) {
+            channelz_node->RecordCallShedDeadlineExceeded();
+          }
+          calld->Shed(GRPC_STATUS_DEADLINE_EXCEEDED,
+                      "Deadline exceeded before the call was dispatched");
+          break;
+        case ShedReason::kQueueDelay:
+          if (channelz_node != nullptr) {
+            channelz_node->RecordCallShedQueueDelay();
+          }
+          calld->Shed(GRPC_STATUS_RESOURCE_EXHAUSTED,
+                      "Server is overloaded: call waited too long to be "
+                      "dispatched");
+          break;
+      }
+    }
+
+    CallData* calld;
+    ShedReason reason;
+  };
+
+  // Pops calls from the head of the pending queue that should not be
+  // dispatched: those already past their deadline and, when delay-based
+  // shedding is enabled and the queue is persistently backed up, those that
+  // waited longer than twice the target delay.
+  void ShedExpiredPendingLocked(std::vector<ShedCall>* shed)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(server_->mu_call_) {
+    if (!fail_expired_ && target_delay_ == Duration::Zero()) return;
+    while (!pending_.empty()) {
+      const PendingCall& head = pending_.front();
+      Timestamp now = ExecCtx::Get()->Now();
+      ShedReason reason;
+      if (fail_expired_ && head.calld->deadline() <= now) {
+        reason = ShedReason::kDeadlineExceeded;
+      } else if (target_delay_ != Duration::Zero() &&
+                 OverloadedLocked(now, now - head.queued_at)) {
+        reason = ShedReason::kQueueDelay;
+      } else {
+        return;
+      }
+      shed->emplace_back(head.calld, reason);
+      pending_.pop();
+      RecordPendingCallDequeued();
+    }
+  }
+
+  // CoDel-style overload detection, as used by adaptive servers that shed
+  // at dequeue time: the queue is considered overloaded for the next
+  // interval if the smallest delay seen in the last one exceeded the target.
+  // While overloaded, calls that waited more than twice the target are shed.
+  bool OverloadedLocked(Timestamp now, Duration delay)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(server_->mu_call_) {
+    if (now > interval_end_) {
+      overloaded_ = min_delay_ > target_delay_;
+      interval_end_ = now + interval_;
+      min_delay_ = delay;
+    } else if (delay < min_delay_) {
+      min_delay_ = delay;
+    }
+    return overloaded_ && delay > target_delay_ * 2;
+  }
+
+  void FailShedCalls(std::vector<ShedCall>* shed) {
+    for (ShedCall& shed_call : *shed) {
+      if (!shed_call.calld->MaybeActivate()) {
+        // Zombied Call
+        shed_call.calld->KillZombie();
+      } else {
+        shed_call.Fail(server_);
+      }
+    }
+    shed->clear();
+  }
+
+  void RecordPendingCallQueued() {
+    channelz::ServerNode* channelz_node = server_->channelz_node();
+    if (channelz_node != nullptr) channelz_node->RecordPendingCallQueued();
+  }
+
+  void RecordPendingCallDequeued() {
+    channelz::ServerNode* channelz_node = server_->channelz_node();
+    if (channelz_node != nullptr) channelz_node->RecordPendingCallDequeued();
+  }
+
   Server* const server_;
-  std::queue<CallData*> pending_;
+  std::queue<PendingCall> pending_;
   std::vector<LockedMultiProducerSingleConsumerQueue> requests_per_cq_;
+  // Admission control, configured from the server's channel args.
+  const size_t max_pending_;
+  const bool fail_expired_;
+  const Duration target_delay_;
+  const Duration interval_;
+  Timestamp interval_end_ ABSL_GUARDED_BY(server_->mu_call_) =
+      Timestamp::InfPast();
+  Duration min_delay_ ABSL_GUARDED_BY(server_->mu_call_) = Duration::Zero();
+  bool overloaded_ ABSL_GUARDED_BY(server_->mu_call_) = false;
 };
 
 // AllocatingRequestMatchers don't allow the application to request an RPC in
@@ -1218,6 +1366,13 @@ void Server::CallData::FailCallCreation() {
   }
 }
 
+void Server::CallData::Shed(grpc_status_code status,
+                             const char* description) {
+  state_.store(CallState::ZOMBIED, std::memory_order_relaxed);
+  grpc_call_cancel_with_status(call_, status, description, nullptr);
+  KillZombie();
+}
+
 void Server::CallData::Start(grpc_call_element* elem) {
   grpc_op op;
   op.op = GRPC_OP_RECV_INITIAL_METADATA;
@@ -296,6 +296,12 @@ class Server : public InternallyRefCounted<Server>,
 
     void FailCallCreation();
 
+    // Fails a call that was refused by admission control with the given
+    // status instead of publishing it to the application.
+    void Shed(grpc_status_code status, const char* description);
+
+    Timestamp deadline() const { return deadline_; }
+
     // Filter vtable functions.
     static grpc_error_handle InitCallElement(
         grpc_call_element* elem, const grpc_call_element_args* args);
@@ -33,6 +33,7 @@
 #include <sys/socket.h>
 #endif
 
+#include <algorithm>
 #include <string>
 
 #include <openssl/bio.h>
@@ -55,11 +56,14 @@
 #include <grpc/support/sync.h>
 #include <grpc/support/thd_id.h>
 
+#include "src/core/lib/experiments/experiments.h"
 #include "src/core/lib/gpr/useful.h"
+#include "src/core/lib/slice/slice_internal.h"
 #include "src/core/tsi/ssl/key_logging/ssl_key_logging.h"
 #include "src/core/tsi/ssl/session_cache/ssl_session_cache.h"
 #include "src/core/tsi/ssl_types.h"
 #include "src/core/tsi/transport_security.h"
+#include "src/core/tsi/transport_security_grpc.h"
 
 /* --- Constants. ---*/
 
@@ -137,6 +141,18 @@ struct tsi_ssl_frame_protector {
   size_t buffer_size;
   size_t buffer_offset;
 };
+struct tsi_ssl_zero_copy_grpc_protector {
+  tsi_zero_copy_grpc_protector base;
+  SSL* ssl;
+  BIO* network_io;
+  /* Protect and unprotect may run concurrently but share ssl. */
+  gpr_mu mu;
+  /* Gathers a record's worth of data when it spans several input slices. */
+  unsigned char* buffer;
+  /* Maximum number of unprotected bytes sealed into one record. */
+  size_t buffer_size;
+  size_t max_protected_frame_size;
+};
 /* --- Library Initialization. ---*/
 
 static gpr_once g_init_openssl_once = GPR_ONCE_INIT;
@@ -1200,6 +1216,195 @@ static const tsi_frame_protector_vtable frame_protector_vtable = {
     ssl_protector_destroy,
 };
 
+/* --- tsi_zero_copy_grpc_protector methods implementation. ---*/
+
+/* Appends the slice under construction to sb, dropping its unused tail. */
+static void ssl_zero_copy_flush_slice(grpc_slice* slice, size_t* used,
+                                      grpc_slice_buffer* sb) {
+  if (*used > 0) {
+    grpc_slice_buffer_add(sb, grpc_slice_sub_no_ref(*slice, 0, *used));
+  } else {
+    grpc_slice_unref_internal(*slice);
+  }
+  *slice = grpc_empty_slice();
+  *used = 0;
+}
+
+/* Moves all pending protected bytes out of the network BIO into *slice,
+   starting a new slice if they do not fit in the remaining space. */
+static tsi_result ssl_zero_copy_read_network_io(BIO* network_io,
+                                                grpc_slice* slice,
+                                                size_t* used,
+                                                grpc_slice_buffer* sb) {
+  size_t pending = static_cast<size_t>(BIO_pending(network_io));
+  if (pending == 0) return TSI_OK;
+  if (GRPC_SLICE_LENGTH(*slice) - *used < pending) {
+    ssl_zero_copy_flush_slice(slice, used, sb);
+    *slice = GRPC_SLICE_MALLOC(pending);
+  }
+  GPR_ASSERT(pending <= INT_MAX);
+  int read_from_ssl = BIO_read(network_io, GRPC_SLICE_START_PTR(*slice) + *used,
+                               static_cast<int>(pending));
+  if (read_from_ssl < 0 || static_cast<size_t>(read_from_ssl) != pending) {
+    gpr_log(GPR_ERROR, "Could not read from BIO after SSL_write.");
+    return TSI_INTERNAL_ERROR;
+  }
+  *used += pending;
+  return TSI_OK;
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_protect(
+    tsi_zero_copy_grpc_protector* self, grpc_slice_buffer* unprotected_slices,
+    grpc_slice_buffer* protected_slices) {
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  size_t remaining = unprotected_slices->length;
+  size_t num_records = (remaining + impl->buffer_size - 1) / impl->buffer_size;
+  gpr_mu_lock(&impl->mu);
+  /* Size the output for every record up front so that, in the common case,
+     all of them are read out of the BIO into a single slice. */
+  grpc_slice out =
+      GRPC_SLICE_MALLOC(static_cast<size_t>(BIO_pending(impl->network_io)) +
+                        remaining +
+                        num_records * TSI_SSL_MAX_PROTECTION_OVERHEAD);
+  size_t out_used = 0;
+  /* Pick up anything SSL queued while unprotecting (e.g. alerts). */
+  tsi_result result = ssl_zero_copy_read_network_io(
+      impl->network_io, &out, &out_used, protected_slices);
+  size_t index = 0;
+  size_t offset = 0;
+  while (result == TSI_OK && remaining > 0) {
+    size_t record_size = std::min(remaining, impl->buffer_size);
+    grpc_slice* slice = &unprotected_slices->slices[index];
+    unsigned char* record;
+    if (GRPC_SLICE_LENGTH(*slice) - offset >= record_size) {
+      /* Seal directly out of the slice. */
+      record = GRPC_SLICE_START_PTR(*slice) + offset;
+      offset += record_size;
+      if (offset == GRPC_SLICE_LENGTH(*slice)) {
+        index++;
+        offset = 0;
+      }
+    } else {
+      record = impl->buffer;
+      for (size_t copied = 0; copied < record_size;) {
+        slice = &unprotected_slices->slices[index];
+        size_t n =
+            std::min(record_size - copied, GRPC_SLICE_LENGTH(*slice) - offset);
+        memcpy(impl->buffer + copied, GRPC_SLICE_START_PTR(*slice) + offset,
+               n);
+        copied += n;
+        offset += n;
+        if (offset == GRPC_SLICE_LENGTH(*slice)) {
+          index++;
+          offset = 0;
+        }
+      }
+    }
+    remaining -= record_size;
+    result = do_ssl_write(impl->ssl, record, record_size);
+    if (result == TSI_OK) {
+      result = ssl_zero_copy_read_network_io(impl->network_io, &out, &out_used,
+                                             protected_slices);
+    }
+  }
+  ssl_zero_copy_flush_slice(&out, &out_used, protected_slices);
+  gpr_mu_unlock(&impl->mu);
+  grpc_slice_buffer_reset_and_unref_internal(unprotected_slices);
+  return result;
+}
+
+/* Reads all unprotected bytes SSL can currently produce into *slice, starting
+   new record-sized slices as each one fills up. */
+static tsi_result ssl_zero_copy_read_ssl(SSL* ssl, grpc_slice* slice,
+                                         size_t* used, grpc_slice_buffer* sb) {
+  for (;;) {
+    if (*used == GRPC_SLICE_LENGTH(*slice)) {
+      ssl_zero_copy_flush_slice(slice, used, sb);
+      *slice = GRPC_SLICE_MALLOC(TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND);
+    }
+    size_t read_size = GRPC_SLICE_LENGTH(*slice) - *used;
+    tsi_result result =
+        do_ssl_read(ssl, GRPC_SLICE_START_PTR(*slice) + *used, &read_size);
+    if (result != TSI_OK || read_size == 0) return result;
+    *used += read_size;
+  }
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_unprotect(
+    tsi_zero_copy_grpc_protector* self, grpc_slice_buffer* protected_slices,
+    grpc_slice_buffer* unprotected_slices, int* min_progress_size) {
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  grpc_slice out = grpc_empty_slice();
+  size_t out_used = 0;
+  size_t index = 0;
+  size_t offset = 0;
+  tsi_result result = TSI_OK;
+  gpr_mu_lock(&impl->mu);
+  for (;;) {
+    /* Drain SSL first so that the BIO has room for the next write. */
+    result = ssl_zero_copy_read_ssl(impl->ssl, &out, &out_used,
+                                    unprotected_slices);
+    if (result != TSI_OK || index == protected_slices->count) break;
+    grpc_slice* slice = &protected_slices->slices[index];
+    size_t length = GRPC_SLICE_LENGTH(*slice) - offset;
+    if (length == 0) {
+      index++;
+      continue;
+    }
+    GPR_ASSERT(length <= INT_MAX);
+    int written_into_ssl =
+        BIO_write(impl->network_io, GRPC_SLICE_START_PTR(*slice) + offset,
+                  static_cast<int>(length));
+    if (written_into_ssl <= 0) {
+      gpr_log(GPR_ERROR, "Sending protected frame to ssl failed with %d",
+              written_into_ssl);
+      result = TSI_INTERNAL_ERROR;
+      break;
+    }
+    offset += static_cast<size_t>(written_into_ssl);
+    if (offset == GRPC_SLICE_LENGTH(*slice)) {
+      index++;
+      offset = 0;
+    }
+  }
+  ssl_zero_copy_flush_slice(&out, &out_used, unprotected_slices);
+  gpr_mu_unlock(&impl->mu);
+  grpc_slice_buffer_reset_and_unref_internal(protected_slices);
+  /* SSL keeps partial records internally, so the size of the next one is not
+     known here. */
+  if (min_progress_size != nullptr) *min_progress_size = 1;
+  return result;
+}
+
+static void ssl_zero_copy_grpc_protector_destroy(
+    tsi_zero_copy_grpc_protector* self) {
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  gpr_free(impl->buffer);
+  if (impl->ssl != nullptr) SSL_free(impl->ssl);
+  if (impl->network_io != nullptr) BIO_free(impl->network_io);
+  gpr_mu_destroy(&impl->mu);
+  gpr_free(self);
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_max_frame_size(
+    tsi_zero_copy_grpc_protector* self, size_t* max_frame_size) {
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  *max_frame_size = impl->max_protected_frame_size;
+  return TSI_OK;
+}
+
+static const tsi_zero_copy_grpc_protector_vtable
+    zero_copy_grpc_protector_vtable = {
+        ssl_zero_copy_grpc_protector_protect,
+        ssl_zero_copy_grpc_protector_unprotect,
+        ssl_zero_copy_grpc_protector_destroy,
+        ssl_zero_copy_grpc_protector_max_frame_size,
+};
+
 /* --- tsi_server_handshaker_factory methods implementation. --- */
 
 static void tsi_ssl_handshaker_factory_destroy(
@@ -1337,7 +1542,46 @@ static tsi_result ssl_handshaker_result_extract_peer(
 static tsi_result ssl_handshaker_result_get_frame_protector_type(
     const tsi_handshaker_result* /*self*/,
     tsi_frame_protector_type* frame_protector_type) {
-  *frame_protector_type = TSI_FRAME_PROTECTOR_NORMAL;
+  *frame_protector_type = grpc_core::IsSslZeroCopyProtectorEnabled()
+                              ? TSI_FRAME_PROTECTOR_NORMAL_OR_ZERO_COPY
+                              : TSI_FRAME_PROTECTOR_NORMAL;
+  return TSI_OK;
+}
+
+static tsi_result ssl_handshaker_result_create_zero_copy_grpc_protector(
+    const tsi_handshaker_result* self, size_t* max_output_protected_frame_size,
+    tsi_zero_copy_grpc_protector** protector) {
+  size_t actual_max_output_protected_frame_size =
+      TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND;
+  tsi_ssl_handshaker_result* impl =
+      reinterpret_cast<tsi_ssl_handshaker_result*>(
+          const_cast<tsi_handshaker_result*>(self));
+
+  if (max_output_protected_frame_size != nullptr) {
+    *max_output_protected_frame_size = grpc_core::Clamp<size_t>(
+        *max_output_protected_frame_size,
+        TSI_SSL_MAX_PROTECTED_FRAME_SIZE_LOWER_BOUND,
+        TSI_SSL_MAX_PROTECTED_FRAME_SIZE_UPPER_BOUND);
+    actual_max_output_protected_frame_size = *max_output_protected_frame_size;
+  }
+  tsi_ssl_zero_copy_grpc_protector* protector_impl =
+      static_cast<tsi_ssl_zero_copy_grpc_protector*>(
+          gpr_zalloc(sizeof(*protector_impl)));
+  protector_impl->max_protected_frame_size =
+      actual_max_output_protected_frame_size;
+  protector_impl->buffer_size =
+      actual_max_output_protected_frame_size - TSI_SSL_MAX_PROTECTION_OVERHEAD;
+  protector_impl->buffer =
+      static_cast<unsigned char*>(gpr_malloc(protector_impl->buffer_size));
+  gpr_mu_init(&protector_impl->mu);
+
+  /* Transfer ownership of ssl and network_io to the frame protector. */
+  protector_impl->ssl = impl->ssl;
+  impl->ssl = nullptr;
+  protector_impl->network_io = impl->network_io;
+  impl->network_io = nullptr;
+  protector_impl->base.vtable = &zero_copy_grpc_protector_vtable;
+  *protector = &protector_impl->base;
   return TSI_OK;
 }
 
@@ -1408,7 +1652,7 @@ static void ssl_handshaker_result_destroy(tsi_handshaker_result* self) {
 static const tsi_handshaker_result_vtable handshaker_result_vtable = {
     ssl_handshaker_result_extract_peer,
     ssl_handshaker_result_get_frame_protector_type,
-    nullptr, /* create_zero_copy_grpc_protector */
+    ssl_handshaker_result_create_zero_copy_grpc_protector,
     ssl_handshaker_result_create_frame_protector,
     ssl_handshaker_result_get_unused_bytes,
     ssl_handshaker_result_destroy,
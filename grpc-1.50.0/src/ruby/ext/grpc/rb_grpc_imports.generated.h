@@ -119,6 +119,9 @@ extern grpc_completion_queue_create_type grpc_completion_queue_create_import;
 typedef grpc_event(*grpc_completion_queue_next_type)(grpc_completion_queue* cq, gpr_timespec deadline, void* reserved);
 extern grpc_completion_queue_next_type grpc_completion_queue_next_import;
 #define grpc_completion_queue_next grpc_completion_queue_next_import
+typedef int(*grpc_completion_queue_next_batch_type)(grpc_completion_queue* cq, grpc_event* events, int max_events, gpr_timespec deadline, void* reserved);
+extern grpc_completion_queue_next_batch_type grpc_completion_queue_next_batch_import;
+#define grpc_completion_queue_next_batch grpc_completion_queue_next_batch_import
 typedef grpc_event(*grpc_completion_queue_pluck_type)(grpc_completion_queue* cq, void* tag, gpr_timespec deadline, void* reserved);
 extern grpc_completion_queue_pluck_type grpc_completion_queue_pluck_import;
 #define grpc_completion_queue_pluck grpc_completion_queue_pluck_import
@@ -305,6 +308,9 @@ extern grpc_channelz_get_subchannel_type grpc_channelz_get_subchannel_import;
 typedef char*(*grpc_channelz_get_socket_type)(intptr_t socket_id);
 extern grpc_channelz_get_socket_type grpc_channelz_get_socket_import;
 #define grpc_channelz_get_socket grpc_channelz_get_socket_import
+typedef char*(*grpc_channelz_get_call_metrics_type)(void);
+extern grpc_channelz_get_call_metrics_type grpc_channelz_get_call_metrics_import;
+#define grpc_channelz_get_call_metrics grpc_channelz_get_call_metrics_import
 typedef const grpc_arg_pointer_vtable*(*grpc_authorization_policy_provider_arg_vtable_type)(void);
 extern grpc_authorization_policy_provider_arg_vtable_type grpc_authorization_policy_provider_arg_vtable_import;
 #define grpc_authorization_policy_provider_arg_vtable grpc_authorization_policy_provider_arg_vtable_import
@@ -0,0 +1,998 @@
+#include <nokogiri.h>
+
+VALUE cNokogiriCssXPathVisitor;
+
+/*
+ * A native translation of CSS selectors to XPath, producing exactly the query
+ * that Nokogiri::CSS::Parser and XPathVisitor would build, without the AST.
+ *
+ * Only the selectors that make up nearly all real-world queries are handled
+ * here: type, universal, namespaced, id, class and attribute selectors,
+ * combinators, selector groups, the simple pseudo-classes, the nth family,
+ * :contains() and :not(). Anything else, including any selector that the Ruby
+ * parser would reject, makes the translation give up so that the caller falls
+ * back to the Ruby parser, which raises the appropriate error.
+ *
+ * Translations are shared by every visitor in the process, keyed by the
+ * selector, the prefix and the visitor configuration. Like the compiled
+ * expression cache in xml_xpath_context.c, the cache is a Hash kept in
+ * least-recently-used order and only touched with the GVL held. Selectors
+ * that can't be translated natively are cached too, as false.
+ */
+#define CSS_TRANSLATION_CACHE_SIZE 1024
+
+static VALUE css_translation_cache;
+
+static ID id_builtins, id_doctype, id_wildcard_namespaces;
+static VALUE sym_never, sym_html5;
+
+enum {
+  CSS_XMLNS = 1,
+  CSS_BUILTINS = 2,
+  CSS_HTML5 = 4
+};
+
+typedef enum {
+  CSS_EOF,
+  CSS_IDENT,
+  CSS_FUNCTION,
+  CSS_HASH,
+  CSS_STRING,
+  CSS_NUMBER,
+  CSS_S,
+  CSS_INCLUDES,
+  CSS_DASHMATCH,
+  CSS_PREFIXMATCH,
+  CSS_SUFFIXMATCH,
+  CSS_SUBSTRINGMATCH,
+  CSS_NOT_EQUAL,
+  CSS_EQUAL,
+  CSS_RPAREN,
+  CSS_LSQUARE,
+  CSS_RSQUARE,
+  CSS_PLUS,
+  CSS_GREATER,
+  CSS_COMMA,
+  CSS_TILDE,
+  CSS_NOT,
+  CSS_DOUBLESLASH,
+  CSS_SLASH,
+  CSS_CHAR,
+  CSS_UNSUPPORTED
+} css_token_type;
+
+typedef struct {
+  css_token_type type;
+  /* the text of the token; for FUNCTION, the name without the parenthesis */
+  const char *start;
+  long length;
+} css_token;
+
+typedef struct {
+  const char *cursor;
+  const char *end;
+  css_token token;
+  VALUE visitor;
+  int flags;
+} css_parser;
+
+/*
+ * Tokenizer. The rules are tried in the same order as in tokenizer.rex, and
+ * the first one that matches wins. Selectors containing backslashes are never
+ * tokenized, so escapes don't need to be handled.
+ */
+
+static int
+is_css_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static int
+is_css_nmstart(char c)
+{
+  return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (unsigned char)c >= 0x80;
+}
+
+static int
+is_css_nmchar(char c)
+{
+  return is_css_nmstart(c) || (c >= '0' && c <= '9') || c == '-';
+}
+
+static int
+is_css_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static const char *
+skip_css_space(const char *p, const char *end)
+{
+  while (p < end && is_css_space(*p)) { p++; }
+  return p;
+}
+
+static long
+css_ident_length(const char *p, const char *end)
+{
+  const char *q = p;
+
+  if (q < end && *q == '-') { q++; }
+  if (q == end || !is_css_nmstart(*q)) { return 0; }
+  while (q < end && is_css_nmchar(*q)) { q++; }
+  return q - p;
+}
+
+static long
+css_number_length(const char *p, const char *end)
+{
+  const char *q = p;
+
+  if (q < end && *q == '-') { q++; }
+  if (q < end && is_css_digit(*q)) {
+    while (q < end && is_css_digit(*q)) { q++; }
+    return q - p;
+  }
+  if (q + 1 < end && *q == '.' && is_css_digit(q[1])) {
+    q++;
+    while (q < end && is_css_digit(*q)) { q++; }
+    return q - p;
+  }
+  return 0;
+}
+
+static void
+set_token(css_parser *parser, css_token_type type, const char *start, long length, const char *cursor)
+{
+  parser->token.type = type;
+  parser->token.start = start;
+  parser->token.length = length;
+  parser->cursor = cursor;
+}
+
+static void
+next_token(css_parser *parser)
+{
+  const char *p = parser->cursor, *end = parser->end, *q, *close;
+  long length;
+
+  if (p == end) {
+    set_token(parser, CSS_EOF, p, 0, p);
+    return;
+  }
+
+  if (end - p >= 4 && memcmp(p, "has(", 4) == 0) {
+    set_token(parser, CSS_UNSUPPORTED, p, 4, p + 4);
+    return;
+  }
+
+  if ((length = css_ident_length(p, end)) > 0) {
+    if (p + length < end && p[length] == '(') {
+      set_token(parser, CSS_FUNCTION, p, length, skip_css_space(p + length + 1, end));
+    } else {
+      set_token(parser, CSS_IDENT, p, length, p + length);
+    }
+    return;
+  }
+
+  if (*p == '#') {
+    for (q = p + 1; q < end && is_css_nmchar(*q); q++) ;
+    if (q > p + 1) {
+      set_token(parser, CSS_HASH, p, q - p, q);
+      return;
+    }
+  }
+
+  /* operators that may be preceded by whitespace */
+  q = skip_css_space(p, end);
+  if (q < end) {
+    css_token_type type = CSS_EOF;
+    int width = 1;
+
+    if (q + 1 < end && q[1] == '=') {
+      width = 2;
+      switch (*q) {
+        case '~': type = CSS_INCLUDES; break;
+        case '|': type = CSS_DASHMATCH; break;
+        case '^': type = CSS_PREFIXMATCH; break;
+        case '$': type = CSS_SUFFIXMATCH; break;
+        case '*': type = CSS_SUBSTRINGMATCH; break;
+        case '!': type = CSS_NOT_EQUAL; break;
+        default: width = 1;
+      }
+    }
+    if (type == CSS_EOF) {
+      switch (*q) {
+        case '=': type = CSS_EQUAL; break;
+        case ')': type = CSS_RPAREN; break;
+        case ']': type = CSS_RSQUARE; break;
+        case '+': type = CSS_PLUS; break;
+        case '>': type = CSS_GREATER; break;
+        case ',': type = CSS_COMMA; break;
+        case '~': type = CSS_TILDE; break;
+        case '/':
+          if (q + 1 < end && q[1] == '/') {
+            type = CSS_DOUBLESLASH;
+            width = 2;
+          } else {
+            type = CSS_SLASH;
+          }
+          break;
+      }
+    }
+    if (type != CSS_EOF) {
+      q += width;
+      if (type != CSS_RPAREN && type != CSS_RSQUARE) {
+        q = skip_css_space(q, end);
+      }
+      set_token(parser, type, p, q - p, q);
+      return;
+    }
+  }
+
+  if (q > p) {
+    set_token(parser, CSS_S, p, q - p, q);
+    return;
+  }
+
+  if (*p == '[') {
+    set_token(parser, CSS_LSQUARE, p, 1, skip_css_space(p + 1, end));
+    return;
+  }
+
+  if (end - p >= 5 && memcmp(p, ":not(", 5) == 0) {
+    set_token(parser, CSS_NOT, p, 5, skip_css_space(p + 5, end));
+    return;
+  }
+
+  if ((length = css_number_length(p, end)) > 0) {
+    set_token(parser, CSS_NUMBER, p, length, p + length);
+    return;
+  }
+
+  if (*p == '"' || *p == '\'') {
+    close = memchr(p + 1, *p, (size_t)(end - p - 1));
+    if (close) {
+      set_token(parser, CSS_STRING, p, close + 1 - p, close + 1);
+      return;
+    }
+  }
+
+  set_token(parser, CSS_CHAR, p, 1, p + 1);
+}
+
+static int
+token_is_char(const css_token *token, char c)
+{
+  return token->type == CSS_CHAR && *token->start == c;
+}
+
+static int
+token_equals(const css_token *token, const char *text)
+{
+  long length = (long)strlen(text);
+  return token->length == length && memcmp(token->start, text, (size_t)length) == 0;
+}
+
+/*
+ * reads a NUMBER token as an integer. Only plain integers are accepted, the
+ * other forms are left to the Ruby parser.
+ */
+static int
+integer_value(const char *p, long length, long *value)
+{
+  int negative = 0;
+  long n = 0;
+
+  if (length > 0 && *p == '-') {
+    negative = 1;
+    p++;
+    length--;
+  }
+  if (length < 1 || length > 9) { return 0; }
+  while (length-- > 0) {
+    if (!is_css_digit(*p)) { return 0; }
+    n = n * 10 + (*p++ - '0');
+  }
+  *value = negative ? -n : n;
+  return 1;
+}
+
+/* true if the visitor has a custom +prefix+name+ method, which the translation would have to call */
+static int
+has_custom_visit(css_parser *parser, const char *prefix, const char *name, long length)
+{
+  VALUE method_name = rb_utf8_str_new_cstr(prefix);
+  ID id;
+
+  rb_str_cat(method_name, name, length);
+  id = rb_check_id(&method_name);
+  return id && rb_respond_to(parser->visitor, id);
+}
+
+/* matches /(nth|first|last|only)-of-type/, see XPathVisitor#is_of_type_pseudo_class? */
+static int
+is_of_type_name(const char *name, long length)
+{
+  static const char *prefixes[] = { "nth", "first", "last", "only" };
+  long j;
+  size_t k;
+
+  for (j = 0; j + 8 <= length; j++) {
+    if (memcmp(name + j, "-of-type", 8) != 0) { continue; }
+    for (k = 0; k < sizeof(prefixes) / sizeof(prefixes[0]); k++) {
+      long prefix_length = (long)strlen(prefixes[k]);
+      if (j >= prefix_length && memcmp(name + j - prefix_length, prefixes[k], (size_t)prefix_length) == 0) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+/*
+ * XPath generation, following XPathVisitor. Every parse_ function appends
+ * the translation of what it parsed to +out+ and returns 0 if the selector
+ * can't be translated natively.
+ */
+
+static int parse_conditions(css_parser *parser, VALUE out);
+
+static void
+append_css_class(css_parser *parser, VALUE out, VALUE hay, const char *needle, long needle_length)
+{
+  if (parser->flags & CSS_BUILTINS) {
+    rb_str_buf_cat2(out, "nokogiri-builtin:css-class(");
+    rb_str_buf_append(out, hay);
+    rb_str_buf_cat2(out, ",'");
+    rb_str_buf_cat(out, needle, needle_length);
+    rb_str_buf_cat2(out, "')");
+  } else {
+    rb_str_buf_cat2(out, "contains(concat(' ',normalize-space(");
+    rb_str_buf_append(out, hay);
+    rb_str_buf_cat2(out, "),' '),' ");
+    rb_str_buf_cat(out, needle, needle_length);
+    rb_str_buf_cat2(out, " ')");
+  }
+}
+
+static int
+starts_element_name(const css_token *token)
+{
+  return token->type == CSS_IDENT || token_is_char(token, '*') || token_is_char(token, '|');
+}
+
+static int
+starts_condition(const css_token *token)
+{
+  return token->type == CSS_HASH || token->type == CSS_LSQUARE || token->type == CSS_NOT
+         || token_is_char(token, '.') || token_is_char(token, ':');
+}
+
+static int
+parse_element_name(css_parser *parser, VALUE out)
+{
+  VALUE name = rb_utf8_str_new(0, 0);
+  css_token first = parser->token;
+
+  if (token_is_char(&first, '*')) {
+    next_token(parser);
+    rb_str_buf_cat2(out, "*");
+    return 1;
+  }
+
+  if (first.type == CSS_IDENT) {
+    next_token(parser);
+    if (token_is_char(&parser->token, '|')) {
+      rb_str_buf_cat(name, first.start, first.length);
+      rb_str_buf_cat2(name, ":");
+    } else {
+      if (parser->flags & CSS_XMLNS) { rb_str_buf_cat2(name, "xmlns:"); }
+      rb_str_buf_cat(name, first.start, first.length);
+    }
+  }
+  if (token_is_char(&parser->token, '|')) {
+    next_token(parser);
+    if (parser->token.type != CSS_IDENT) { return 0; }
+    rb_str_buf_cat(name, parser->token.start, parser->token.length);
+    next_token(parser);
+  }
+
+  if ((parser->flags & CSS_HTML5) && !memchr(RSTRING_PTR(name), ':', (size_t)RSTRING_LEN(name))) {
+    /* HTML5 has namespaces that should be ignored in CSS queries */
+    if (!(parser->flags & CSS_BUILTINS)) {
+      rb_str_buf_cat2(out, "*[local-name()='");
+      rb_str_buf_append(out, name);
+      rb_str_buf_cat2(out, "']");
+    } else if (RTEST(rb_const_get(cNokogiriCssXPathVisitor, id_wildcard_namespaces))) {
+      rb_str_buf_cat2(out, "*:");
+      rb_str_buf_append(out, name);
+    } else {
+      rb_str_buf_cat2(out, "*[nokogiri-builtin:local-name-is('");
+      rb_str_buf_append(out, name);
+      rb_str_buf_cat2(out, "')]");
+    }
+  } else {
+    rb_str_buf_append(out, name);
+  }
+  return 1;
+}
+
+static int
+parse_attribute(css_parser *parser, VALUE out)
+{
+  VALUE attribute, value;
+  css_token_type operator;
+  long n;
+
+  next_token(parser);
+
+  if (parser->token.type == CSS_NUMBER) {
+    if (!integer_value(parser->token.start, parser->token.length, &n)) { return 0; }
+    next_token(parser);
+    if (parser->token.type != CSS_RSQUARE) { return 0; }
+    next_token(parser);
+    rb_str_catf(out, "count(preceding-sibling::*)=%ld", n - 1);
+    return 1;
+  }
+
+  attribute = rb_utf8_str_new_cstr("@");
+  if (parser->token.type == CSS_IDENT) {
+    rb_str_buf_cat(attribute, parser->token.start, parser->token.length);
+    next_token(parser);
+    if (token_is_char(&parser->token, '|')) { rb_str_buf_cat2(attribute, ":"); }
+  }
+  if (token_is_char(&parser->token, '|')) {
+    next_token(parser);
+    if (parser->token.type != CSS_IDENT) { return 0; }
+    rb_str_buf_cat(attribute, parser->token.start, parser->token.length);
+    next_token(parser);
+  }
+  if (RSTRING_LEN(attribute) == 1) { return 0; }
+
+  if (parser->token.type == CSS_RSQUARE) {
+    next_token(parser);
+    rb_str_buf_append(out, attribute);
+    return 1;
+  }
+
+  operator = parser->token.type;
+  switch (operator) {
+    case CSS_EQUAL:
+    case CSS_PREFIXMATCH:
+    case CSS_SUFFIXMATCH:
+    case CSS_SUBSTRINGMATCH:
+    case CSS_NOT_EQUAL:
+    case CSS_INCLUDES:
+    case CSS_DASHMATCH:
+      break;
+    default:
+      return 0;
+  }
+  next_token(parser);
+
+  value = rb_utf8_str_new(0, 0);
+  switch (parser->token.type) {
+    case CSS_STRING:
+      rb_str_buf_cat(value, parser->token.start, parser->token.length);
+      break;
+    case CSS_IDENT:
+    case CSS_NUMBER:
+      rb_str_buf_cat2(value, "'");
+      rb_str_buf_cat(value, parser->token.start, parser->token.length);
+      rb_str_buf_cat2(value, "'");
+      break;
+    default:
+      return 0;
+  }
+  next_token(parser);
+  if (parser->token.type != CSS_RSQUARE) { return 0; }
+  next_token(parser);
+
+  switch (operator) {
+    case CSS_EQUAL:
+      rb_str_buf_append(out, attribute);
+      rb_str_buf_cat2(out, "=");
+      rb_str_buf_append(out, value);
+      break;
+    case CSS_NOT_EQUAL:
+      rb_str_buf_append(out, attribute);
+      rb_str_buf_cat2(out, "!=");
+      rb_str_buf_append(out, value);
+      break;
+    case CSS_SUBSTRINGMATCH:
+      rb_str_catf(out, "contains(%"PRIsVALUE",%"PRIsVALUE")", attribute, value);
+      break;
+    case CSS_PREFIXMATCH:
+      rb_str_catf(out, "starts-with(%"PRIsVALUE",%"PRIsVALUE")", attribute, value);
+      break;
+    case CSS_DASHMATCH:
+      rb_str_catf(out, "%"PRIsVALUE"=%"PRIsVALUE" or starts-with(%"PRIsVALUE",concat(%"PRIsVALUE",'-'))",
+                  attribute, value, attribute, value);
+      break;
+    case CSS_INCLUDES:
+      append_css_class(parser, out, attribute, RSTRING_PTR(value) + 1, RSTRING_LEN(value) - 2);
+      break;
+    case CSS_SUFFIXMATCH:
+      rb_str_catf(out,
+                  "substring(%"PRIsVALUE",string-length(%"PRIsVALUE")-string-length(%"PRIsVALUE")+1,string-length(%"PRIsVALUE"))=%"PRIsVALUE,
+                  attribute, attribute, value, value, value);
+      break;
+    default:
+      return 0;
+  }
+  return 1;
+}
+
+static const struct {
+  const char *name;
+  const char *xpath;
+} css_pseudo_classes[] = {
+  { "first", "position()=1" },
+  { "first-child", "count(preceding-sibling::*)=0" },
+  { "last", "position()=last()" },
+  { "last-child", "count(following-sibling::*)=0" },
+  { "first-of-type", "position()=1" },
+  { "last-of-type", "position()=last()" },
+  { "only-child", "count(preceding-sibling::*)=0 and count(following-sibling::*)=0" },
+  { "only-of-type", "last()=1" },
+  { "empty", "not(node())" },
+  { "parent", "node()" },
+  { "root", "not(parent::*)" },
+};
+
+typedef enum {
+  CSS_NTH,
+  CSS_NTH_CHILD,
+  CSS_NTH_LAST_CHILD,
+  CSS_NTH_OF_TYPE,
+  CSS_NTH_LAST_OF_TYPE,
+  CSS_CONTAINS
+} css_function;
+
+static void
+append_nth(VALUE out, css_function function, long a, long b)
+{
+  const char *position;
+
+  switch (function) {
+    case CSS_NTH_CHILD: position = "(count(preceding-sibling::*)+1)"; break;
+    case CSS_NTH_LAST_CHILD: position = "(count(following-sibling::*)+1)"; break;
+    case CSS_NTH_LAST_OF_TYPE: position = "(last()-position()+1)"; break;
+    default: position = "position()";
+  }
+
+  if (b == 0) {
+    rb_str_catf(out, "(%s mod %ld)=0", position, a);
+  } else if (a == 1 || a == -1) {
+    rb_str_catf(out, "%s%s%ld", position, a < 0 ? "<=" : ">=", b);
+  } else {
+    rb_str_catf(out, "(%s%s%ld) and (((%s-%ld) mod %ld)=0)",
+                position, a < 0 ? "<=" : ">=", b, position, b, a < 0 ? -a : a);
+  }
+}
+
+/* parses the argument of an nth function and the closing parenthesis */
+static int
+parse_nth_argument(css_parser *parser, VALUE out, css_function function)
+{
+  css_token first = parser->token, ident;
+  long a, b, n;
+
+  if (first.type == CSS_NUMBER) {
+    next_token(parser);
+    if (parser->token.type != CSS_IDENT) {
+      /* a plain index */
+      if (parser->token.type != CSS_RPAREN || !integer_value(first.start, first.length, &n)) { return 0; }
+      next_token(parser);
+      switch (function) {
+        case CSS_NTH_CHILD:
+          rb_str_catf(out, "count(preceding-sibling::*)=%ld", n - 1);
+          break;
+        case CSS_NTH_LAST_CHILD:
+          rb_str_catf(out, "count(following-sibling::*)=%ld", n - 1);
+          break;
+        case CSS_NTH_LAST_OF_TYPE:
+          if (n - 1 == 0) {
+            rb_str_buf_cat2(out, "position()=last()");
+          } else {
+            rb_str_catf(out, "position()=last()-%ld", n - 1);
+          }
+          break;
+        default:
+          rb_str_buf_cat2(out, "position()=");
+          rb_str_buf_cat(out, first.start, first.length);
+      }
+      return 1;
+    }
+
+    if (!integer_value(first.start, first.length, &a)) { return 0; }
+    ident = parser->token;
+    next_token(parser);
+    if (parser->token.type == CSS_PLUS) {
+      /* 5n+3 */
+      if (!token_equals(&ident, "n") || !token_equals(&parser->token, "+")) { return 0; }
+      next_token(parser);
+      if (parser->token.type != CSS_NUMBER || !integer_value(parser->token.start, parser->token.length, &b)) { return 0; }
+      next_token(parser);
+    } else if (token_equals(&ident, "n")) {
+      /* 5n */
+      b = 0;
+    } else if (ident.length > 2 && memcmp(ident.start, "n-", 2) == 0
+               && is_css_digit(ident.start[2]) && integer_value(ident.start + 2, ident.length - 2, &n)
+               && a != 0) {
+      /* 10n-1, where b is the floored modulo as in XPathVisitor#read_a_and_positive_b */
+      long r = n % a;
+      if (r != 0 && ((r < 0) != (a < 0))) { r += a; }
+      b = a - r;
+    } else {
+      return 0;
+    }
+  } else if (first.type == CSS_IDENT) {
+    next_token(parser);
+    if (parser->token.type == CSS_PLUS) {
+      /* n+3, -n+3 */
+      if (token_equals(&first, "n")) {
+        a = 1;
+      } else if (token_equals(&first, "-n")) {
+        a = -1;
+      } else {
+        return 0;
+      }
+      if (!token_equals(&parser->token, "+")) { return 0; }
+      next_token(parser);
+      if (parser->token.type != CSS_NUMBER || !integer_value(parser->token.start, parser->token.length, &b)) { return 0; }
+      next_token(parser);
+    } else if (token_equals(&first, "even")) {
+      a = 2;
+      b = 0;
+    } else if (token_equals(&first, "odd")) {
+      a = 2;
+      b = 1;
+    } else if (token_equals(&first, "n")) {
+      a = 1;
+      b = 0;
+    } else {
+      return 0;
+    }
+  } else {
+    return 0;
+  }
+
+  if (parser->token.type != CSS_RPAREN) { return 0; }
+  next_token(parser);
+  append_nth(out, function, a, b);
+  return 1;
+}
+
+static int
+parse_pseudo_class(css_parser *parser, VALUE out, int *of_type)
+{
+  css_token name;
+  css_function function;
+  size_t j;
+
+  next_token(parser);
+  name = parser->token;
+
+  if (name.type == CSS_IDENT) {
+    if (has_custom_visit(parser, "visit_pseudo_class_", name.start, name.length)) { return 0; }
+    next_token(parser);
+    *of_type = is_of_type_name(name.start, name.length);
+    for (j = 0; j < sizeof(css_pseudo_classes) / sizeof(css_pseudo_classes[0]); j++) {
+      if (token_equals(&name, css_pseudo_classes[j].name)) {
+        rb_str_buf_cat2(out, css_pseudo_classes[j].xpath);
+        return 1;
+      }
+    }
+    rb_str_buf_cat(out, name.start, name.length);
+    rb_str_buf_cat2(out, "(.)");
+    return 1;
+  }
+
+  if (name.type != CSS_FUNCTION) { return 0; }
+  if (token_equals(&name, "nth")) {
+    function = CSS_NTH;
+  } else if (token_equals(&name, "nth-child")) {
+    function = CSS_NTH_CHILD;
+  } else if (token_equals(&name, "nth-last-child")) {
+    function = CSS_NTH_LAST_CHILD;
+  } else if (token_equals(&name, "nth-of-type")) {
+    function = CSS_NTH_OF_TYPE;
+  } else if (token_equals(&name, "nth-last-of-type")) {
+    function = CSS_NTH_LAST_OF_TYPE;
+  } else if (token_equals(&name, "contains")) {
+    function = CSS_CONTAINS;
+  } else {
+    return 0;
+  }
+  if (has_custom_visit(parser, "visit_function_", name.start, name.length)) { return 0; }
+  next_token(parser);
+  *of_type = is_of_type_name(name.start, name.length);
+
+  if (function != CSS_CONTAINS) {
+    return parse_nth_argument(parser, out, function);
+  }
+
+  if (parser->token.type != CSS_STRING) { return 0; }
+  rb_str_buf_cat2(out, "contains(.,");
+  rb_str_buf_cat(out, parser->token.start, parser->token.length);
+  rb_str_buf_cat2(out, ")");
+  next_token(parser);
+  if (parser->token.type != CSS_RPAREN) { return 0; }
+  next_token(parser);
+  return 1;
+}
+
+static int
+parse_negation(css_parser *parser, VALUE out)
+{
+  next_token(parser);
+
+  if (starts_element_name(&parser->token)) {
+    rb_str_buf_cat2(out, "not(self::");
+    if (!parse_element_name(parser, out)) { return 0; }
+    /* conditions following the element name don't take part in the negation */
+    if (starts_condition(&parser->token) && !parse_conditions(parser, rb_utf8_str_new(0, 0))) { return 0; }
+  } else if (starts_condition(&parser->token)) {
+    rb_str_buf_cat2(out, "not(");
+    if (!parse_conditions(parser, out)) { return 0; }
+  } else {
+    return 0;
+  }
+
+  if (parser->token.type != CSS_RPAREN) { return 0; }
+  next_token(parser);
+  rb_str_buf_cat2(out, ")");
+  return 1;
+}
+
+/*
+ * parses a sequence of id, class, attribute, pseudo-class and negation
+ * conditions. They are joined with "and", except that a trailing of-type
+ * pseudo-class goes into its own predicate, as in XPathVisitor#visit_combinator.
+ */
+static int
+parse_conditions(css_parser *parser, VALUE out)
+{
+  long separator = -1;
+  int of_type = 0, first = 1;
+
+  do {
+    if (!first) {
+      separator = RSTRING_LEN(out);
+      rb_str_buf_cat2(out, " and ");
+    }
+    first = 0;
+    of_type = 0;
+
+    switch (parser->token.type) {
+      case CSS_HASH:
+        rb_str_buf_cat2(out, "@id='");
+        rb_str_buf_cat(out, parser->token.start + 1, parser->token.length - 1);
+        rb_str_buf_cat2(out, "'");
+        next_token(parser);
+        break;
+      case CSS_LSQUARE:
+        if (!parse_attribute(parser, out)) { return 0; }
+        break;
+      case CSS_NOT:
+        if (!parse_negation(parser, out)) { return 0; }
+        break;
+      default:
+        if (token_is_char(&parser->token, '.')) {
+          next_token(parser);
+          if (parser->token.type != CSS_IDENT) { return 0; }
+          append_css_class(parser, out, rb_utf8_str_new_cstr("@class"), parser->token.start, parser->token.length);
+          next_token(parser);
+        } else if (!parse_pseudo_class(parser, out, &of_type)) {
+          return 0;
+        }
+    }
+  } while (starts_condition(&parser->token));
+
+  if (of_type && separator >= 0) {
+    char *p;
+    long length = RSTRING_LEN(out);
+
+    rb_str_modify(out);
+    p = RSTRING_PTR(out);
+    memmove(p + separator + 2, p + separator + 5, (size_t)(length - separator - 5));
+    memcpy(p + separator, "][", 2);
+    rb_str_set_len(out, length - 3);
+  }
+  return 1;
+}
+
+static int
+parse_simple_selector(css_parser *parser, VALUE out)
+{
+  if (starts_element_name(&parser->token)) {
+    if (!parse_element_name(parser, out)) { return 0; }
+    if (!starts_condition(&parser->token)) { return 1; }
+  } else if (starts_condition(&parser->token)) {
+    rb_str_buf_cat2(out, "*");
+  } else {
+    return 0;
+  }
+
+  rb_str_buf_cat2(out, "[");
+  if (!parse_conditions(parser, out)) { return 0; }
+  rb_str_buf_cat2(out, "]");
+  return 1;
+}
+
+static int
+parse_selector(css_parser *parser, VALUE out)
+{
+  if (!parse_simple_selector(parser, out)) { return 0; }
+
+  for (;;) {
+    switch (parser->token.type) {
+      case CSS_S:
+      case CSS_DOUBLESLASH:
+        rb_str_buf_cat2(out, "//");
+        break;
+      case CSS_GREATER:
+      case CSS_SLASH:
+        rb_str_buf_cat2(out, "/");
+        break;
+      case CSS_PLUS:
+        rb_str_buf_cat2(out, "/following-sibling::*[1]/self::");
+        break;
+      case CSS_TILDE:
+        rb_str_buf_cat2(out, "/following-sibling::");
+        break;
+      default:
+        return 1;
+    }
+    next_token(parser);
+    if (!parse_simple_selector(parser, out)) { return 0; }
+  }
+}
+
+/* returns an Array with the XPath query for each selector in the group, or Qfalse */
+static VALUE
+translate(VALUE visitor, VALUE rb_selector, VALUE rb_prefix, int flags)
+{
+  css_parser parser;
+  VALUE xpaths = rb_ary_new(), xpath;
+
+  parser.cursor = RSTRING_PTR(rb_selector);
+  parser.end = parser.cursor + RSTRING_LEN(rb_selector);
+  parser.visitor = visitor;
+  parser.flags = flags;
+
+  next_token(&parser);
+  if (parser.token.type == CSS_S) { next_token(&parser); }
+
+  for (;;) {
+    xpath = rb_utf8_str_new(RSTRING_PTR(rb_prefix), RSTRING_LEN(rb_prefix));
+    if (!parse_selector(&parser, xpath)) { return Qfalse; }
+    rb_ary_push(xpaths, xpath);
+
+    if (parser.token.type == CSS_EOF) { break; }
+    if (parser.token.type != CSS_COMMA) { return Qfalse; }
+    next_token(&parser);
+  }
+
+  RB_GC_GUARD(rb_selector);
+  return xpaths;
+}
+
+/*
+ * true if the bytes of +rb_selector+ tokenize the same way its characters do
+ * in the Ruby tokenizer, and don't contain escapes
+ */
+static int
+translatable_selector(VALUE rb_selector)
+{
+  const char *p = RSTRING_PTR(rb_selector);
+  long length = RSTRING_LEN(rb_selector);
+  int coderange;
+
+  if (!rb_enc_asciicompat(rb_enc_get(rb_selector))) { return 0; }
+  coderange = rb_enc_str_coderange(rb_selector);
+  if (coderange != ENC_CODERANGE_7BIT
+      && !(coderange == ENC_CODERANGE_VALID && rb_enc_get(rb_selector) == rb_utf8_encoding())) {
+    return 0;
+  }
+  return !memchr(p, '\\', (size_t)length) && !memchr(p, '\0', (size_t)length);
+}
+
+static int
+oldest_translation_i(VALUE key, VALUE value, VALUE oldest)
+{
+  *(VALUE *)oldest = key;
+  return ST_STOP;
+}
+
+/*
+ * :nodoc:
+ *
+ * call-seq:
+ *   native_xpath_for(selector, prefix, xmlns, cache) → Array or nil
+ *
+ * Translate +selector+ the way Nokogiri::CSS::Parser#xpath_for would with this visitor, returning
+ * nil if the selector isn't one that can be translated natively. +xmlns+ is true if the namespaces
+ * of the query include a default namespace. +cache+ is false if the CSS cache is turned off.
+ */
+static VALUE
+rb_css_xpath_visitor_native_xpath_for(VALUE self, VALUE rb_selector, VALUE rb_prefix, VALUE rb_xmlns, VALUE rb_cache)
+{
+  VALUE key = Qnil, xpaths;
+  int flags = 0;
+  char flags_byte;
+
+  StringValue(rb_selector);
+  StringValue(rb_prefix);
+
+  if (!translatable_selector(rb_selector)) { return Qnil; }
+
+  if (RTEST(rb_xmlns)) { flags |= CSS_XMLNS; }
+  if (rb_ivar_get(self, id_builtins) != sym_never) { flags |= CSS_BUILTINS; }
+  if (rb_ivar_get(self, id_doctype) == sym_html5) { flags |= CSS_HTML5; }
+
+  if (RTEST(rb_cache)) {
+    /* the selector can't contain a NUL byte, so the keys can't collide */
+    flags_byte = (char)('0' + flags);
+    key = rb_str_buf_new(1 + RSTRING_LEN(rb_prefix) + 1 + RSTRING_LEN(rb_selector));
+    rb_str_buf_cat(key, &flags_byte, 1);
+    rb_str_buf_cat(key, RSTRING_PTR(rb_prefix), RSTRING_LEN(rb_prefix));
+    rb_str_buf_cat(key, "", 1);
+    rb_str_buf_cat(key, RSTRING_PTR(rb_selector), RSTRING_LEN(rb_selector));
+
+    xpaths = rb_hash_delete(css_translation_cache, key);
+    if (!NIL_P(xpaths)) {
+      rb_hash_aset(css_translation_cache, key, xpaths);
+      return RTEST(xpaths) ? xpaths : Qnil;
+    }
+  }
+
+  xpaths = translate(self, rb_selector, rb_prefix, flags);
+
+  if (RTEST(rb_cache)) {
+    if (RHASH_SIZE(css_translation_cache) >= CSS_TRANSLATION_CACHE_SIZE) {
+      VALUE oldest = Qnil;
+      rb_hash_foreach(css_translation_cache, oldest_translation_i, (VALUE)&oldest);
+      rb_hash_delete(css_translation_cache, oldest);
+    }
+    rb_hash_aset(css_translation_cache, key, xpaths);
+  }
+
+  return RTEST(xpaths) ? xpaths : Qnil;
+}
+
+/*
+ * :nodoc:
+ *
+ * call-seq:
+ *   clear_native_cache
+ *
+ * Drop every translation made by XPathVisitor#native_xpath_for.
+ */
+static VALUE
+rb_css_xpath_visitor_s_clear_native_cache(VALUE klass)
+{
+  rb_hash_clear(css_translation_cache);
+  return Qnil;
+}
+
+void
+noko_init_css_xpath_visitor(void)
+{
+  cNokogiriCssXPathVisitor = rb_define_class_under(mNokogiriCss, "XPathVisitor", rb_cObject);
+
+  css_translation_cache = rb_hash_new();
+  rb_gc_register_mark_object(css_translation_cache);
+
+  id_builtins = rb_intern("@builtins");
+  id_doctype = rb_intern("@doctype");
+  id_wildcard_namespaces = rb_intern("WILDCARD_NAMESPACES");
+  sym_never = ID2SYM(rb_intern("never"));
+  sym_html5 = ID2SYM(rb_intern("html5"));
+
+  rb_define_singleton_method(cNokogiriCssXPathVisitor, "clear_native_cache", rb_css_xpath_visitor_s_clear_native_cache, 0);
+  rb_define_method(cNokogiriCssXPathVisitor, "native_xpath_for", rb_css_xpath_visitor_native_xpath_for, 4);
+}
@@ -21,13 +21,16 @@
 //     def parse(utf8_string) # returns Nokogiri::HTML5::Document
 //   end
 //
-// Processing starts by calling gumbo_parse_with_options. The resulting document tree
-// is then walked, a parallel libxml2 tree is constructed, and the final document is
-// then wrapped using Nokogiri_wrap_xml_document. This approach reduces memory and CPU
-// requirements as Ruby objects are only built when necessary.
+// Processing starts by calling gumbo_parse_with_options. For documents, a libxml2
+// tree is built alongside Gumbo's own as the parser runs, with Gumbo freeing its
+// nodes as soon as they are no longer needed; for fragments, the resulting Gumbo
+// tree is walked afterwards and a parallel libxml2 tree is constructed. The final
+// document is then wrapped using Nokogiri_wrap_xml_document. This approach reduces
+// memory and CPU requirements as Ruby objects are only built when necessary.
 //
 
 #include <nokogiri.h>
+#include <ruby/thread.h>
 
 #include "gumbo.h"
 
@@ -65,37 +68,82 @@ rb_utf8_str_new_static(const char *str, long length)
 #include <libxml/tree.h>
 #include <libxml/HTMLtree.h>
 
-// URI = system id
-// external id = public id
 static xmlDocPtr
-new_html_doc(const char *dtd_name, const char *system, const char *public)
+new_html_doc(void)
 {
-  // These two libxml2 functions take the public and system ids in
-  // opposite orders.
   htmlDocPtr doc = htmlNewDocNoDtD(/* URI */ NULL, /* ExternalID */NULL);
   assert(doc);
-  if (dtd_name) {
-    xmlCreateIntSubset(doc, (const xmlChar *)dtd_name, (const xmlChar *)public, (const xmlChar *)system);
-  }
   return doc;
 }
 
+// URI = system id
+// external id = public id
+static void
+add_doctype(xmlDocPtr doc, const char *dtd_name, const char *system, const char *public)
+{
+  // The doctype always becomes the first child of an HTML document, even if
+  // the document already has children.
+  xmlCreateIntSubset(doc, (const xmlChar *)dtd_name, (const xmlChar *)public, (const xmlChar *)system);
+}
+
 static xmlNodePtr
 get_parent(xmlNodePtr node)
 {
   return node->parent;
 }
 
-static GumboOutput *
-perform_parse(const GumboOptions *options, VALUE input)
+// Inputs shorter than this are parsed while holding the GVL. Releasing and
+// reacquiring it costs more than parsing a small fragment.
+#define GVL_RELEASE_THRESHOLD 4096
+
+typedef struct {
+  const GumboOptions *options;
+  const char *buffer;
+  size_t length;
+  GumboOutput *output;
+} GumboParseArgs;
+
+static void *
+gumbo_parse_without_gvl(void *parse_args)
+{
+  GumboParseArgs *args = (GumboParseArgs *)parse_args;
+  args->output = gumbo_parse_with_options(args->options, args->buffer, args->length);
+  return NULL;
+}
+
+// Returns a frozen string sharing input's buffer. Gumbo runs without the GVL,
+// so the string it parses must not change while other threads run; the
+// returned string is also the one error messages should be built from.
+static VALUE
+pin_input(VALUE input)
 {
   assert(RTEST(input));
   Check_Type(input, T_STRING);
-  GumboOutput *output = gumbo_parse_with_options(
-                          options,
-                          RSTRING_PTR(input),
-                          RSTRING_LEN(input)
-                        );
+  return rb_str_new_frozen(input);
+}
+
+// input must have been returned by pin_input().
+static GumboOutput *
+perform_parse(const GumboOptions *options, VALUE input)
+{
+  GumboParseArgs args = {
+    .options = options,
+    .buffer = RSTRING_PTR(input),
+    .length = RSTRING_LEN(input),
+    .output = NULL,
+  };
+  // Gumbo is pure C and never calls into Ruby, so other threads can run while
+  // it tokenizes and builds its tree. That includes the libxml2 tree built by
+  // a tree sink: libxml2 allocates with ruby_xmalloc(), which may be called
+  // without the GVL and takes it by itself when it needs to run the GC. Only
+  // the error reporting below needs the GVL.
+  if (args.length < GVL_RELEASE_THRESHOLD) {
+    gumbo_parse_without_gvl(&args);
+  } else {
+    rb_thread_call_without_gvl(gumbo_parse_without_gvl, &args, NULL, NULL);
+  }
+  RB_GC_GUARD(input);
+  GumboOutput *output = args.output;
 
   const char *status_string = gumbo_status_to_string(output->status);
   switch (output->status) {
@@ -137,6 +185,97 @@ set_line(xmlNodePtr node, size_t line)
   }
 }
 
+static xmlAttrPtr
+add_xml_attribute(
+  xmlDocPtr doc,
+  xmlNodePtr xml_root,
+  xmlNodePtr xml_node,
+  const GumboAttribute *attr
+)
+{
+  xmlNsPtr ns;
+  switch (attr->attr_namespace) {
+    case GUMBO_ATTR_NAMESPACE_XLINK:
+      ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/1999/xlink", "xlink");
+      break;
+
+    case GUMBO_ATTR_NAMESPACE_XML:
+      ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/XML/1998/namespace", "xml");
+      break;
+
+    case GUMBO_ATTR_NAMESPACE_XMLNS:
+      ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/2000/xmlns/", "xmlns");
+      break;
+
+    default:
+      ns = NULL;
+  }
+  return xmlNewNsProp(xml_node, ns, (const xmlChar *)attr->name, (const xmlChar *)attr->value);
+}
+
+// Create an unlinked libxml2 node for gumbo_node. Namespaces are declared on
+// *xml_root, which is set to the new node if it is an element and *xml_root is
+// NULL.
+static xmlNodePtr
+new_xml_node(xmlDocPtr doc, xmlNodePtr *xml_root, const GumboNode *gumbo_node)
+{
+  xmlNodePtr xml_node;
+
+  switch (gumbo_node->type) {
+    case GUMBO_NODE_DOCUMENT:
+      abort(); // Bug in Gumbo.
+
+    case GUMBO_NODE_TEXT:
+    case GUMBO_NODE_WHITESPACE:
+      xml_node = xmlNewDocText(doc, (const xmlChar *)gumbo_node->v.text.text);
+      set_line(xml_node, gumbo_node->v.text.start_pos.line);
+      return xml_node;
+
+    case GUMBO_NODE_CDATA:
+      xml_node = xmlNewCDataBlock(doc, (const xmlChar *)gumbo_node->v.text.text,
+                                  (int) strlen(gumbo_node->v.text.text));
+      set_line(xml_node, gumbo_node->v.text.start_pos.line);
+      return xml_node;
+
+    case GUMBO_NODE_COMMENT:
+      xml_node = xmlNewDocComment(doc, (const xmlChar *)gumbo_node->v.text.text);
+      set_line(xml_node, gumbo_node->v.text.start_pos.line);
+      return xml_node;
+
+    case GUMBO_NODE_TEMPLATE:
+    // XXX: Should create a template element and a new DocumentFragment
+    case GUMBO_NODE_ELEMENT:
+      break;
+  }
+
+  xml_node = xmlNewDocNode(doc, NULL, (const xmlChar *)gumbo_node->v.element.name, NULL);
+  set_line(xml_node, gumbo_node->v.element.start_pos.line);
+  if (*xml_root == NULL) {
+    *xml_root = xml_node;
+  }
+  xmlNsPtr ns = NULL;
+  switch (gumbo_node->v.element.tag_namespace) {
+    case GUMBO_NAMESPACE_HTML:
+      break;
+    case GUMBO_NAMESPACE_SVG:
+      ns = lookup_or_add_ns(doc, *xml_root, "http://www.w3.org/2000/svg", "svg");
+      break;
+    case GUMBO_NAMESPACE_MATHML:
+      ns = lookup_or_add_ns(doc, *xml_root, "http://www.w3.org/1998/Math/MathML", "math");
+      break;
+  }
+  if (ns != NULL) {
+    xmlSetNs(xml_node, ns);
+  }
+
+  // Add the attributes.
+  const GumboVector *attrs = &gumbo_node->v.element.attributes;
+  for (size_t i = 0; i < attrs->length; i++) {
+    add_xml_attribute(doc, *xml_root, xml_node, attrs->data[i]);
+  }
+  return xml_node;
+}
+
 // Construct an XML tree rooted at xml_output_node from the Gumbo tree rooted
 // at gumbo_node.
 static void
@@ -173,84 +312,236 @@ build_tree(
       continue;
     }
     const GumboNode *gumbo_child = children->data[child_index++];
-    xmlNodePtr xml_child;
+    xmlNodePtr xml_child = new_xml_node(doc, &xml_root, gumbo_child);
+    xmlAddChild(xml_node, xml_child);
+
+    if (gumbo_child->type == GUMBO_NODE_ELEMENT || gumbo_child->type == GUMBO_NODE_TEMPLATE) {
+      // Add children for this element.
+      child_index = 0;
+      gumbo_node = gumbo_child;
+      xml_node = xml_child;
+    }
+  }
+}
 
-    switch (gumbo_child->type) {
-      case GUMBO_NODE_DOCUMENT:
-        abort(); // Bug in Gumbo.
+// Builds the libxml2 tree of a document while Gumbo parses it, mirroring every
+// change Gumbo makes to its own tree. The result is the tree build_tree()
+// would have built from Gumbo's finished tree, but Gumbo is free to discard
+// its nodes as it goes.
+typedef struct {
+  xmlDocPtr doc;
+  xmlNodePtr root;
+  // libxml2 registers the first of several identical IDs it sees, and nodes
+  // are not always created in document order. Set when an ID could not be
+  // registered, in which case the ID table has to be rebuilt at the end.
+  bool duplicate_ids;
+} TreeBuilder;
 
-      case GUMBO_NODE_TEXT:
-      case GUMBO_NODE_WHITESPACE:
-        xml_child = xmlNewDocText(doc, (const xmlChar *)gumbo_child->v.text.text);
-        set_line(xml_child, gumbo_child->v.text.start_pos.line);
-        xmlAddChild(xml_node, xml_child);
-        break;
+static void
+check_for_duplicate_id(TreeBuilder *builder, xmlNodePtr xml_node, xmlAttrPtr attr)
+{
+  if (attr->atype != XML_ATTRIBUTE_ID && xmlIsID(builder->doc, xml_node, attr)) {
+    builder->duplicate_ids = true;
+  }
+}
 
-      case GUMBO_NODE_CDATA:
-        xml_child = xmlNewCDataBlock(doc, (const xmlChar *)gumbo_child->v.text.text,
-                                     (int) strlen(gumbo_child->v.text.text));
-        set_line(xml_child, gumbo_child->v.text.start_pos.line);
-        xmlAddChild(xml_node, xml_child);
-        break;
+// Returns the libxml2 node for gumbo_node, creating it first if Gumbo has not
+// inserted gumbo_node yet. The adoption agency algorithm moves nodes into
+// clones before inserting the clones themselves.
+static xmlNodePtr
+xml_node_for(TreeBuilder *builder, GumboNode *gumbo_node)
+{
+  if (gumbo_node->type == GUMBO_NODE_DOCUMENT) {
+    return (xmlNodePtr)builder->doc;
+  }
+  if (gumbo_node->user_data == NULL) {
+    xmlNodePtr xml_node = new_xml_node(builder->doc, &builder->root, gumbo_node);
+    if (xml_node->type == XML_ELEMENT_NODE) {
+      for (xmlAttrPtr attr = xml_node->properties; attr != NULL; attr = attr->next) {
+        check_for_duplicate_id(builder, xml_node, attr);
+      }
+    }
+    gumbo_node->user_data = xml_node;
+  }
+  return gumbo_node->user_data;
+}
 
-      case GUMBO_NODE_COMMENT:
-        xml_child = xmlNewDocComment(doc, (const xmlChar *)gumbo_child->v.text.text);
-        set_line(xml_child, gumbo_child->v.text.start_pos.line);
-        xmlAddChild(xml_node, xml_child);
-        break;
+// Unlink xml_node. If that leaves two text nodes next to each other, merge
+// them, as xmlAddChild() in build_tree() would have.
+static void
+unlink_xml_node(xmlNodePtr xml_node)
+{
+  xmlNodePtr prev = xml_node->prev;
+  xmlNodePtr next = xml_node->next;
+  xmlUnlinkNode(xml_node);
+  if (prev != NULL && next != NULL
+      && prev->type == XML_TEXT_NODE && next->type == XML_TEXT_NODE) {
+    xmlTextMerge(prev, next);
+  }
+}
 
-      case GUMBO_NODE_TEMPLATE:
-      // XXX: Should create a template element and a new DocumentFragment
-      case GUMBO_NODE_ELEMENT: {
-        xml_child = xmlNewDocNode(doc, NULL, (const xmlChar *)gumbo_child->v.element.name, NULL);
-        set_line(xml_child, gumbo_child->v.element.start_pos.line);
-        if (xml_root == NULL) {
-          xml_root = xml_child;
-        }
-        xmlNsPtr ns = NULL;
-        switch (gumbo_child->v.element.tag_namespace) {
-          case GUMBO_NAMESPACE_HTML:
-            break;
-          case GUMBO_NAMESPACE_SVG:
-            ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/2000/svg", "svg");
-            break;
-          case GUMBO_NAMESPACE_MATHML:
-            ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/1998/Math/MathML", "math");
-            break;
-        }
-        if (ns != NULL) {
-          xmlSetNs(xml_child, ns);
-        }
-        xmlAddChild(xml_node, xml_child);
-
-        // Add the attributes.
-        const GumboVector *attrs = &gumbo_child->v.element.attributes;
-        for (size_t i = 0; i < attrs->length; i++) {
-          const GumboAttribute *attr = attrs->data[i];
-
-          switch (attr->attr_namespace) {
-            case GUMBO_ATTR_NAMESPACE_XLINK:
-              ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/1999/xlink", "xlink");
-              break;
-
-            case GUMBO_ATTR_NAMESPACE_XML:
-              ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/XML/1998/namespace", "xml");
-              break;
-
-            case GUMBO_ATTR_NAMESPACE_XMLNS:
-              ns = lookup_or_add_ns(doc, xml_root, "http://www.w3.org/2000/xmlns/", "xmlns");
-              break;
-
-            default:
-              ns = NULL;
-          }
-          xmlNewNsProp(xml_child, ns, (const xmlChar *)attr->name, (const xmlChar *)attr->value);
-        }
+static void
+tree_builder_insert_node(void *userdata, GumboNode *node, GumboNode *before)
+{
+  TreeBuilder *builder = userdata;
+  xmlNodePtr xml_node = xml_node_for(builder, node);
+  // These merge text into a preceding text node, like xmlAddChild() does in
+  // build_tree(), and return that node instead. Gumbo frees text nodes right
+  // after inserting them, so it never looks at the freed one.
+  // xmlAddPrevSibling() only merges with the node before the one passed in if
+  // both are text, so insert after that node when there is one.
+  if (before == NULL) {
+    node->user_data = xmlAddChild(xml_node_for(builder, node->parent), xml_node);
+  } else {
+    xmlNodePtr xml_before = xml_node_for(builder, before);
+    if (xml_before->prev != NULL) {
+      node->user_data = xmlAddNextSibling(xml_before->prev, xml_node);
+    } else {
+      node->user_data = xmlAddPrevSibling(xml_before, xml_node);
+    }
+  }
+}
+
+static void
+tree_builder_remove_node(void *userdata, GumboNode *node, GumboNode *parent)
+{
+  unlink_xml_node(xml_node_for(userdata, node));
+}
+
+static void
+tree_builder_move_children(void *userdata, GumboNode *from, GumboNode *to)
+{
+  xmlNodePtr xml_from = xml_node_for(userdata, from);
+  xmlNodePtr xml_to = xml_node_for(userdata, to);
+  assert(xml_to->children == NULL);
+  for (xmlNodePtr child = xml_from->children; child != NULL; child = child->next) {
+    child->parent = xml_to;
+  }
+  xml_to->children = xml_from->children;
+  xml_to->last = xml_from->last;
+  xml_from->children = NULL;
+  xml_from->last = NULL;
+}
+
+static void
+tree_builder_add_attribute(void *userdata, GumboNode *node, const GumboAttribute *attr)
+{
+  TreeBuilder *builder = userdata;
+  xmlNodePtr xml_node = xml_node_for(builder, node);
+  check_for_duplicate_id(builder, xml_node, add_xml_attribute(builder->doc, builder->root, xml_node, attr));
+}
+
+static void
+tree_builder_discard_node(void *userdata, GumboNode *node)
+{
+  xmlNodePtr xml_node = xml_node_for(userdata, node);
+  unlink_xml_node(xml_node);
+  xmlFreeNode(xml_node);
+}
 
-        // Add children for this element.
-        child_index = 0;
-        gumbo_node = gumbo_child;
-        xml_node = xml_child;
+static xmlNodePtr
+next_in_document_order(xmlNodePtr root, xmlNodePtr node)
+{
+  if (node->children != NULL) {
+    return node->children;
+  }
+  for (; node != root; node = node->parent) {
+    if (node->next != NULL) {
+      return node->next;
+    }
+  }
+  return NULL;
+}
+
+// Append ns to used if it is one of the count namespaces in defs and is not
+// in used already. Returns the new length of used.
+static size_t
+note_namespace_use(xmlNsPtr ns, xmlNsPtr *defs, size_t count, xmlNsPtr *used, size_t used_count)
+{
+  if (ns == NULL) {
+    return used_count;
+  }
+  for (size_t i = 0; i < used_count; i++) {
+    if (used[i] == ns) {
+      return used_count;
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (defs[i] == ns) {
+      used[used_count++] = ns;
+      break;
+    }
+  }
+  return used_count;
+}
+
+// The tree builder declares namespaces on the root element in the order Gumbo
+// first inserts nodes using them, which foster parenting and the adoption
+// agency algorithm make differ from document order, and a <frameset> can
+// discard the only nodes using one. Put the declarations in the order
+// build_tree() would have made them in, and drop unused ones.
+static void
+sort_namespace_definitions(xmlNodePtr root)
+{
+  // svg, math, xlink, and xmlns; the xml namespace is predeclared.
+  xmlNsPtr defs[4];
+  xmlNsPtr used[4];
+  size_t count = 0;
+  size_t used_count = 0;
+
+  for (xmlNsPtr ns = root->nsDef; ns != NULL; ns = ns->next) {
+    if (count == sizeof defs / sizeof defs[0]) {
+      return;
+    }
+    defs[count++] = ns;
+  }
+  for (xmlNodePtr node = root;
+       node != NULL && used_count < count;
+       node = next_in_document_order(root, node)) {
+    if (node->type != XML_ELEMENT_NODE) {
+      continue;
+    }
+    used_count = note_namespace_use(node->ns, defs, count, used, used_count);
+    for (xmlAttrPtr attr = node->properties; attr != NULL; attr = attr->next) {
+      used_count = note_namespace_use(attr->ns, defs, count, used, used_count);
+    }
+  }
+  for (size_t i = 0; i < count; i++) {
+    bool is_used = false;
+    for (size_t j = 0; j < used_count; j++) {
+      is_used = is_used || used[j] == defs[i];
+    }
+    if (!is_used) {
+      xmlFreeNs(defs[i]);
+    }
+  }
+  root->nsDef = NULL;
+  for (size_t i = used_count; i-- > 0;) {
+    used[i]->next = root->nsDef;
+    root->nsDef = used[i];
+  }
+}
+
+// Register IDs in document order, so that the first element with a given ID
+// is the one found by it, as with build_tree().
+static void
+rebuild_id_table(xmlDocPtr doc)
+{
+  xmlFreeIDTable(doc->ids);
+  doc->ids = NULL;
+  xmlNodePtr root = (xmlNodePtr)doc;
+  for (xmlNodePtr node = root; node != NULL; node = next_in_document_order(root, node)) {
+    if (node->type != XML_ELEMENT_NODE) {
+      continue;
+    }
+    for (xmlAttrPtr attr = node->properties; attr != NULL; attr = attr->next) {
+      if (attr->atype == XML_ATTRIBUTE_ID) {
+        attr->atype = 0;
+      }
+      if (xmlIsID(doc, node, attr)) {
+        xmlChar *value = xmlNodeListGetString(doc, attr->children, 1);
+        xmlAddID(NULL, doc, value, attr);
+        xmlFree(value);
       }
     }
   }
@@ -295,6 +586,7 @@ add_errors(const GumboOutput *output, VALUE rdoc, VALUE input, VALUE url)
 
 typedef struct {
   GumboOutput *output;
+  const GumboOptions *options;
   VALUE input;
   VALUE url_or_frag;
   xmlDocPtr doc;
@@ -304,7 +596,9 @@ static VALUE
 parse_cleanup(VALUE parse_args)
 {
   ParseArgs *args = (ParseArgs *)parse_args;
-  gumbo_destroy_output(args->output);
+  if (args->output != NULL) {
+    gumbo_destroy_output(args->output);
+  }
   // Make sure garbage collection doesn't mark the objects as being live based
   // on references from the ParseArgs. This may be unnecessary.
   args->input = Qnil;
@@ -328,9 +622,10 @@ parse(VALUE self, VALUE input, VALUE url, VALUE max_attributes, VALUE max_errors
   options.max_errors = NUM2INT(max_errors);
   options.max_tree_depth = NUM2INT(max_depth);
 
-  GumboOutput *output = perform_parse(&options, input);
+  input = pin_input(input);
   ParseArgs args = {
-    .output = output,
+    .output = NULL,
+    .options = &options,
     .input = input,
     .url_or_frag = url,
     .doc = NULL,
@@ -343,20 +638,40 @@ static VALUE
 parse_continue(VALUE parse_args)
 {
   ParseArgs *args = (ParseArgs *)parse_args;
+  TreeBuilder builder = {
+    .doc = new_html_doc(),
+    .root = NULL,
+    .duplicate_ids = false,
+  };
+  const GumboTreeSink sink = {
+    .userdata = &builder,
+    .insert_node = tree_builder_insert_node,
+    .remove_node = tree_builder_remove_node,
+    .move_children = tree_builder_move_children,
+    .add_attribute = tree_builder_add_attribute,
+    .discard_node = tree_builder_discard_node,
+  };
+  GumboOptions options = *args->options;
+  options.tree_sink = &sink;
+
+  xmlDocPtr doc = builder.doc;
+  args->doc = doc; // Make sure doc gets cleaned up if an error is thrown.
+  args->output = perform_parse(&options, args->input);
   GumboOutput *output = args->output;
-  xmlDocPtr doc;
   if (output->document->v.document.has_doctype) {
     const char *name   = output->document->v.document.name;
     const char *public = output->document->v.document.public_identifier;
     const char *system = output->document->v.document.system_identifier;
     public = public[0] ? public : NULL;
     system = system[0] ? system : NULL;
-    doc = new_html_doc(name, system, public);
-  } else {
-    doc = new_html_doc(NULL, NULL, NULL);
+    add_doctype(doc, name, system, public);
+  }
+  if (builder.root != NULL) {
+    sort_namespace_definitions(builder.root);
+  }
+  if (builder.duplicate_ids) {
+    rebuild_id_table(doc);
   }
-  args->doc = doc; // Make sure doc gets cleaned up if an error is thrown.
-  build_tree(doc, (xmlNodePtr)doc, output->document);
   VALUE rdoc = Nokogiri_wrap_xml_document(cNokogiriHtml5Document, doc);
   args->doc = NULL; // The Ruby runtime now owns doc so don't delete it.
   add_errors(output, rdoc, args->input, args->url_or_frag);
@@ -427,14 +742,19 @@ fragment(
   GumboQuirksModeEnum quirks_mode;
   bool form = false;
   const char *encoding = NULL;
+  // Frozen strings backing ctx_tag and encoding, kept alive until Gumbo is
+  // done. Gumbo reads them without the GVL, like the input; see pin_input().
+  VALUE ctx_tag_str = Qnil;
+  VALUE encoding_str = Qnil;
 
   if (NIL_P(ctx)) {
     ctx_tag = "body";
     ctx_ns = GUMBO_NAMESPACE_HTML;
   } else if (TYPE(ctx) == T_STRING) {
-    ctx_tag = StringValueCStr(ctx);
+    ctx_tag_str = rb_str_new_frozen(ctx);
+    ctx_tag = StringValueCStr(ctx_tag_str);
     ctx_ns = GUMBO_NAMESPACE_HTML;
-    size_t len = RSTRING_LEN(ctx);
+    size_t len = RSTRING_LEN(ctx_tag_str);
     const char *colon = memchr(ctx_tag, ':', len);
     if (colon) {
       switch (colon - ctx_tag) {
@@ -476,7 +796,8 @@ error:
     VALUE tag_name = rb_funcall(ctx, name, 0);
     assert(RTEST(tag_name));
     Check_Type(tag_name, T_STRING);
-    ctx_tag = StringValueCStr(tag_name);
+    ctx_tag_str = rb_str_new_frozen(tag_name);
+    ctx_tag = StringValueCStr(ctx_tag_str);
 
     // Context fragment namespace.
     ctx_ns = lookup_namespace(ctx, true);
@@ -498,13 +819,14 @@ error:
     }
 
     // Encoding.
-    if (RSTRING_LEN(tag_name) == 14
+    if (RSTRING_LEN(ctx_tag_str) == 14
         && !st_strcasecmp(ctx_tag, "annotation-xml")) {
-      VALUE enc = rb_funcall(ctx, rb_intern_const("[]"),
+      VALUE enc = rb_funcall(ctx, rb_intern_const("[]"), 1,
                              rb_utf8_str_new_static("encoding", 8));
       if (RTEST(enc)) {
         Check_Type(enc, T_STRING);
-        encoding = StringValueCStr(enc);
+        encoding_str = rb_str_new_frozen(enc);
+        encoding = StringValueCStr(encoding_str);
       }
     }
   }
@@ -538,7 +860,10 @@ error:
   options.quirks_mode = quirks_mode;
   options.fragment_context_has_form_ancestor = form;
 
+  tags = pin_input(tags);
   GumboOutput *output = perform_parse(&options, tags);
+  RB_GC_GUARD(ctx_tag_str);
+  RB_GC_GUARD(encoding_str);
   ParseArgs args = {
     .output = output,
     .input = tags,
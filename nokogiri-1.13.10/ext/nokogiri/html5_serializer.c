@@ -0,0 +1,374 @@
+#include <nokogiri.h>
+
+/*
+ * A native version of Nokogiri::HTML5.serialize_node_internal, the HTML
+ * fragment serialization algorithm, for output in UTF-8.
+ *
+ * The output is built in a string buffer and handed to the IO with #<< in
+ * chunks, always between two of the strings that the Ruby version writes, so
+ * the IO sees the same bytes. Like the Ruby version, it raises ArgumentError
+ * for text or attribute values that aren't valid UTF-8, and RuntimeError for
+ * nodes it can't serialize, after writing out everything before them.
+ */
+#define HTML5_SERIALIZER_CHUNK_SIZE 65536
+
+#define HTML_NAMESPACE "http://www.w3.org/1999/xhtml"
+#define MATHML_NAMESPACE "http://www.w3.org/1998/Math/MathML"
+#define SVG_NAMESPACE "http://www.w3.org/2000/svg"
+#define XLINK_NAMESPACE "http://www.w3.org/1999/xlink"
+#define XML_NAMESPACE "http://www.w3.org/XML/1998/namespace"
+#define XMLNS_NAMESPACE "http://www.w3.org/2000/xmlns/"
+
+static ID id_shovel;
+
+static const char *const void_elements[] = {
+  "area", "base", "basefont", "bgsound", "br", "col", "embed", "frame", "hr", "img", "input",
+  "keygen", "link", "meta", "param", "source", "track", "wbr", NULL
+};
+
+static const char *const raw_text_elements[] = {
+  "style", "script", "xmp", "iframe", "noembed", "noframes", "plaintext", "noscript", NULL
+};
+
+static const char *const newline_elements[] = {
+  "pre", "textarea", "listing", NULL
+};
+
+typedef struct {
+  VALUE io;
+  VALUE buffer;
+  int preserve_newline;
+} Serializer;
+
+static int
+name_in(const xmlChar *name, const char *const *names)
+{
+  if (!name) { return 0; }
+  for (; *names; names++) {
+    if (xmlStrEqual(name, (const xmlChar *)*names)) { return 1; }
+  }
+  return 0;
+}
+
+static void
+flush(Serializer *s)
+{
+  if (RSTRING_LEN(s->buffer) == 0) { return; }
+  rb_funcall(s->io, id_shovel, 1, s->buffer);
+  s->buffer = rb_utf8_str_new(NULL, 0);
+}
+
+static void
+append(Serializer *s, const char *str, long length)
+{
+  rb_str_buf_cat(s->buffer, str, length);
+}
+
+static void
+append_cstr(Serializer *s, const xmlChar *str)
+{
+  if (str) { rb_str_buf_cat2(s->buffer, (const char *)str); }
+}
+
+/* length of the valid UTF-8 sequence at p, or 0, following Ruby's rules for String#valid_encoding? */
+static long
+utf8_sequence_length(const unsigned char *p, const unsigned char *end)
+{
+  unsigned char lo = 0x80, hi = 0xbf;
+  long length, j;
+
+  if (p[0] < 0xc2) { return 0; }
+  if (p[0] < 0xe0) {
+    length = 2;
+  } else if (p[0] < 0xf0) {
+    length = 3;
+    if (p[0] == 0xe0) { lo = 0xa0; }
+    if (p[0] == 0xed) { hi = 0x9f; }
+  } else if (p[0] < 0xf5) {
+    length = 4;
+    if (p[0] == 0xf0) { lo = 0x90; }
+    if (p[0] == 0xf4) { hi = 0x8f; }
+  } else {
+    return 0;
+  }
+
+  if (end - p < length || p[1] < lo || p[1] > hi) { return 0; }
+  for (j = 2; j < length; j++) {
+    if (p[j] < 0x80 || p[j] > 0xbf) { return 0; }
+  }
+  return length;
+}
+
+/* Nokogiri::HTML5.escape_text */
+static void
+append_escaped(Serializer *s, const xmlChar *text, int attribute_mode)
+{
+  const unsigned char *run, *p, *end;
+  const char *replacement;
+  long length, start = RSTRING_LEN(s->buffer);
+
+  if (!text) { return; }
+
+  run = p = text;
+  end = p + xmlStrlen(text);
+  while (p < end) {
+    replacement = NULL;
+    length = 1;
+    switch (*p) {
+      case '&':
+        replacement = "&amp;";
+        break;
+      case '"':
+        if (attribute_mode) { replacement = "&quot;"; }
+        break;
+      case '<':
+        if (!attribute_mode) { replacement = "&lt;"; }
+        break;
+      case '>':
+        if (!attribute_mode) { replacement = "&gt;"; }
+        break;
+      default:
+        if (*p >= 0x80) {
+          length = utf8_sequence_length(p, end);
+          if (length == 0) {
+            /* the Ruby version raises before writing any of the text */
+            rb_str_set_len(s->buffer, start);
+            flush(s);
+            rb_raise(rb_eArgError, "invalid byte sequence in UTF-8");
+          }
+          if (length == 2 && p[0] == 0xc2 && p[1] == 0xa0) { replacement = "&nbsp;"; }
+        }
+    }
+    if (replacement) {
+      append(s, (const char *)run, p - run);
+      append(s, replacement, (long)strlen(replacement));
+      run = p + length;
+    }
+    p += length;
+  }
+  append(s, (const char *)run, p - run);
+}
+
+/* Node#content for text-like nodes and attributes */
+static void
+append_content(Serializer *s, xmlNodePtr node, int escape, int attribute_mode)
+{
+  xmlChar *content;
+
+  if (node->type == XML_ATTRIBUTE_NODE) {
+    if (node->children && !node->children->next && node->children->type == XML_TEXT_NODE) {
+      node = node->children;
+    } else {
+      content = xmlNodeGetContent(node);
+      if (escape) {
+        append_escaped(s, content, attribute_mode);
+      } else {
+        append_cstr(s, content);
+      }
+      xmlFree(content);
+      return;
+    }
+  }
+
+  if (escape) {
+    append_escaped(s, node->content, attribute_mode);
+  } else {
+    append_cstr(s, node->content);
+  }
+}
+
+/* everything after the colon in +name+, or all of it */
+static const xmlChar *
+local_part(const xmlChar *name)
+{
+  const xmlChar *colon = xmlStrchr(name, ':');
+  return colon ? colon + 1 : name;
+}
+
+static void
+append_tag_name(Serializer *s, xmlNodePtr node)
+{
+  const xmlChar *href = node->ns ? node->ns->href : NULL;
+
+  if (href
+      && !xmlStrEqual(href, (const xmlChar *)HTML_NAMESPACE)
+      && !xmlStrEqual(href, (const xmlChar *)MATHML_NAMESPACE)
+      && !xmlStrEqual(href, (const xmlChar *)SVG_NAMESPACE)) {
+    append_cstr(s, node->ns->prefix);
+    append(s, ":", 1);
+  }
+  append_cstr(s, node->name);
+}
+
+static void
+append_attribute(Serializer *s, xmlAttrPtr attr)
+{
+  const xmlChar *href = attr->ns ? attr->ns->href : NULL;
+
+  append(s, " ", 1);
+  if (!attr->ns) {
+    append_cstr(s, attr->name);
+  } else if (xmlStrEqual(href, (const xmlChar *)XML_NAMESPACE)) {
+    append(s, "xml:", 4);
+    append_cstr(s, local_part(attr->name));
+  } else if (xmlStrEqual(href, (const xmlChar *)XMLNS_NAMESPACE)) {
+    if (xmlStrEqual(local_part(attr->name), (const xmlChar *)"xmlns")) {
+      append(s, "xmlns", 5);
+    } else {
+      append(s, "xmlns:", 6);
+      append_cstr(s, local_part(attr->name));
+    }
+  } else if (xmlStrEqual(href, (const xmlChar *)XLINK_NAMESPACE)) {
+    append(s, "xlink:", 6);
+    append_cstr(s, local_part(attr->name));
+  } else {
+    append_cstr(s, attr->ns->prefix);
+    append(s, ":", 1);
+    append_cstr(s, attr->name);
+  }
+  append(s, "=\"", 2);
+  append_content(s, (xmlNodePtr)attr, 1, 1);
+  append(s, "\"", 1);
+}
+
+/* Nokogiri::HTML5.prepend_newline? */
+static int
+prepend_newline_p(xmlNodePtr node)
+{
+  return name_in(node->name, newline_elements)
+         && node->children
+         && node->children->type == XML_TEXT_NODE
+         && node->children->content
+         && node->children->content[0] == '\n';
+}
+
+/*
+ * writes everything up to the children of +node+, and returns whether its children are to be
+ * serialized
+ */
+static int
+open_node(Serializer *s, xmlNodePtr node)
+{
+  xmlAttrPtr attr;
+
+  if (RSTRING_LEN(s->buffer) >= HTML5_SERIALIZER_CHUNK_SIZE) {
+    flush(s);
+  }
+
+  switch (node->type) {
+    case XML_ELEMENT_NODE:
+      append(s, "<", 1);
+      append_tag_name(s, node);
+      for (attr = node->properties; attr; attr = attr->next) {
+        append_attribute(s, attr);
+      }
+      append(s, ">", 1);
+      if (name_in(node->name, void_elements)) {
+        return 0;
+      }
+      if (s->preserve_newline && prepend_newline_p(node)) {
+        append(s, "\n", 1);
+      }
+      return 1;
+
+    case XML_TEXT_NODE:
+      append_content(s, node, !(node->parent && node->parent->type == XML_ELEMENT_NODE
+                                && name_in(node->parent->name, raw_text_elements)), 0);
+      return 0;
+
+    case XML_CDATA_SECTION_NODE:
+      append(s, "<![CDATA[", 9);
+      append_content(s, node, 0, 0);
+      append(s, "]]>", 3);
+      return 0;
+
+    case XML_COMMENT_NODE:
+      append(s, "<!--", 4);
+      append_content(s, node, 0, 0);
+      append(s, "-->", 3);
+      return 0;
+
+    case XML_PI_NODE:
+      append(s, "<?", 2);
+      append_content(s, node, 0, 0);
+      append(s, ">", 1);
+      return 0;
+
+    case XML_DOCUMENT_TYPE_NODE:
+    case XML_DTD_NODE:
+      append(s, "<!DOCTYPE ", 10);
+      append_cstr(s, node->name);
+      append(s, ">", 1);
+      return 0;
+
+    case XML_HTML_DOCUMENT_NODE:
+    case XML_DOCUMENT_FRAG_NODE:
+      return 1;
+
+    default:
+      flush(s);
+      rb_raise(rb_eRuntimeError, "Unexpected node '%s' of type %d",
+               node->name ? (const char *)node->name : "", (int)node->type);
+  }
+}
+
+static void
+close_node(Serializer *s, xmlNodePtr node)
+{
+  if (node->type == XML_ELEMENT_NODE && !name_in(node->name, void_elements)) {
+    append(s, "</", 2);
+    append_tag_name(s, node);
+    append(s, ">", 1);
+  }
+}
+
+/*
+ * :call-seq:
+ *   serialize_node_native(node, io, preserve_newline)
+ *
+ * Serialize +node+ to +io+ in UTF-8, exactly like
+ * <tt>serialize_node_internal(node, io, Encoding::UTF_8, preserve_newline: preserve_newline)</tt>.
+ * +node+ must not be a text node without a parent.
+ */
+static VALUE
+rb_html5_serialize_node_native(VALUE self, VALUE rb_node, VALUE rb_io, VALUE rb_preserve_newline)
+{
+  Serializer s;
+  xmlNodePtr top, node;
+
+  Noko_Node_Get_Struct(rb_node, xmlNode, top);
+
+  s.io = rb_io;
+  s.buffer = rb_utf8_str_new(NULL, 0);
+  s.preserve_newline = RTEST(rb_preserve_newline);
+
+  /* walk the tree without recursing, so that deep trees can't overflow the C stack */
+  node = top;
+  for (;;) {
+    if (open_node(&s, node) && node->children) {
+      node = node->children;
+      continue;
+    }
+    for (;;) {
+      close_node(&s, node);
+      if (node == top) {
+        flush(&s);
+        RB_GC_GUARD(rb_node);
+        return rb_io;
+      }
+      if (node->next) {
+        node = node->next;
+        break;
+      }
+      node = node->parent;
+    }
+  }
+}
+
+void
+noko_init_html5_serializer(void)
+{
+  rb_define_singleton_method(mNokogiriHtml5, "serialize_node_native", rb_html5_serialize_node_native, 3);
+
+  id_shovel = rb_intern("<<");
+}
@@ -1,6 +1,7 @@
 #include <nokogiri.h>
 
 VALUE mNokogiri ;
+VALUE mNokogiriCss ;
 VALUE mNokogiriGumbo ;
 VALUE mNokogiriHtml4 ;
 VALUE mNokogiriHtml4Sax ;
@@ -15,6 +16,7 @@ VALUE cNokogiriXmlCharacterData;
 VALUE cNokogiriXmlElement;
 VALUE cNokogiriXmlXpathSyntaxError;
 
+void noko_init_css_xpath_visitor(void);
 void noko_init_xml_attr(void);
 void noko_init_xml_attribute_decl(void);
 void noko_init_xml_cdata(void);
@@ -47,6 +49,7 @@ void noko_init_html_entity_lookup(void);
 void noko_init_html_sax_parser_context(void);
 void noko_init_html_sax_push_parser(void);
 void noko_init_gumbo(void);
+void noko_init_html5_serializer(void);
 void noko_init_test_global_handlers(void);
 
 static ID id_read, id_write;
@@ -155,6 +158,7 @@ void
 Init_nokogiri()
 {
   mNokogiri         = rb_define_module("Nokogiri");
+  mNokogiriCss      = rb_define_module_under(mNokogiri, "CSS");
   mNokogiriGumbo    = rb_define_module_under(mNokogiri, "Gumbo");
   mNokogiriHtml4     = rb_define_module_under(mNokogiri, "HTML4");
   mNokogiriHtml4Sax  = rb_define_module_under(mNokogiriHtml4, "SAX");
@@ -238,6 +242,7 @@ Init_nokogiri()
   noko_init_xml_reader();
   noko_init_xml_sax_parser();
   noko_init_xml_xpath_context();
+  noko_init_css_xpath_visitor();
   noko_init_xslt_stylesheet();
   noko_init_html_element_description();
   noko_init_html_entity_lookup();
@@ -270,6 +275,7 @@ Init_nokogiri()
   noko_init_xml_document();
   noko_init_html_document();
   noko_init_gumbo();
+  noko_init_html5_serializer();
 
   noko_init_test_global_handlers();
 
@@ -36,6 +36,7 @@
 #include <libxml/entities.h>
 #include <libxml/xpath.h>
 #include <libxml/xmlreader.h>
+#include <libxml/pattern.h>
 #include <libxml/xmlsave.h>
 #include <libxml/xmlschemas.h>
 #include <libxml/HTMLparser.h>
@@ -93,6 +94,7 @@ xmlNodePtr xmlLastElementChild(xmlNodePtr parent);
 
 
 NOKOPUBVAR VALUE mNokogiri ;
+NOKOPUBVAR VALUE mNokogiriCss ;
 NOKOPUBVAR VALUE mNokogiriGumbo ;
 NOKOPUBVAR VALUE mNokogiriHtml4 ;
 NOKOPUBVAR VALUE mNokogiriHtml4Sax ;
@@ -102,6 +104,7 @@ NOKOPUBVAR VALUE mNokogiriXmlSax ;
 NOKOPUBVAR VALUE mNokogiriXmlXpath ;
 NOKOPUBVAR VALUE mNokogiriXslt ;
 
+NOKOPUBVAR VALUE cNokogiriCssXPathVisitor;
 NOKOPUBVAR VALUE cNokogiriEncodingHandler;
 NOKOPUBVAR VALUE cNokogiriSyntaxError;
 NOKOPUBVAR VALUE cNokogiriXmlAttr;
@@ -143,6 +146,9 @@ typedef struct _nokogiriTuple {
   VALUE         doc;
   st_table     *unlinkedNodes;
   VALUE         node_cache;
+  VALUE         weak_node_cache;
+  int           wrap_nodes_weakly;
+  VALUE         xpath_context;
 } nokogiriTuple;
 typedef nokogiriTuple *nokogiriTuplePtr;
 
@@ -176,6 +182,7 @@ int noko_io_close(void *ctx);
 VALUE noko_xml_node_wrap(VALUE klass, xmlNodePtr node) ;
 VALUE noko_xml_node_wrap_node_set_result(xmlNodePtr node, VALUE node_set) ;
 VALUE noko_xml_node_attrs(xmlNodePtr node) ;
+VALUE noko_xml_node_attribute_value(xmlNodePtr node, VALUE rattribute) ;
 
 VALUE noko_xml_namespace_wrap(xmlNsPtr node, xmlDocPtr doc);
 VALUE noko_xml_namespace_wrap_xpath_copy(xmlNsPtr node);
@@ -193,6 +200,7 @@ NOKOPUBFUN VALUE Nokogiri_wrap_xml_document(VALUE klass,
 #define DOC_RUBY_OBJECT(x) (((nokogiriTuplePtr)(x->_private))->doc)
 #define DOC_UNLINKED_NODE_HASH(x) (((nokogiriTuplePtr)(x->_private))->unlinkedNodes)
 #define DOC_NODE_CACHE(x) (((nokogiriTuplePtr)(x->_private))->node_cache)
+#define DOC_WEAK_NODE_CACHE(x) (((nokogiriTuplePtr)(x->_private))->weak_node_cache)
 #define NOKOGIRI_NAMESPACE_EH(node) ((node)->type == XML_NAMESPACE_DECL)
 
 #define NOKOGIRI_SAX_SELF(_ctxt) ((nokogiriSAXTuplePtr)(_ctxt))->self
@@ -57,6 +57,8 @@ mark(xmlDocPtr doc)
   if (tuple) {
     rb_gc_mark(tuple->doc);
     rb_gc_mark(tuple->node_cache);
+    rb_gc_mark(tuple->weak_node_cache);
+    rb_gc_mark(tuple->xpath_context);
   }
 }
 
@@ -453,6 +455,61 @@ remove_namespaces_bang(VALUE self)
   return self;
 }
 
+/*
+ *  call-seq:
+ *    weak_node_cache = true
+ *
+ *  By default, the Ruby object for a node lives as long as its document does, so that
+ *  accessing the node always returns the same object. A large document that has been
+ *  traversed once keeps all of those objects alive, and every major GC has to mark them.
+ *
+ *  After <tt>weak_node_cache = true</tt>, the nodes wrapped from then on are only kept
+ *  alive by references from Ruby. Once collected, a node is wrapped in a new object the
+ *  next time it is accessed, so its object_id changes and any instance variables set on
+ *  the old object are lost. Setting it back to +false+ only affects nodes wrapped
+ *  afterwards.
+ *
+ *  Requires Ruby 2.7 or later.
+ */
+static VALUE
+set_weak_node_cache(VALUE self, VALUE rb_weak_eh)
+{
+  xmlDocPtr c_document;
+  nokogiriTuplePtr tuple;
+
+  Data_Get_Struct(self, xmlDoc, c_document);
+  tuple = (nokogiriTuplePtr)c_document->_private;
+
+  if (RTEST(rb_weak_eh) && NIL_P(tuple->weak_node_cache)) {
+#if RUBY_API_VERSION_CODE < 20700
+    rb_raise(rb_eNotImpError, "a weak node cache requires Ruby 2.7 or later");
+#else
+    /* ObjectSpace::WeakMap accepts integer keys since Ruby 2.7 */
+    tuple->weak_node_cache = rb_class_new_instance(0, NULL,
+                             rb_const_get(rb_const_get(rb_cObject, rb_intern("ObjectSpace")), rb_intern("WeakMap")));
+#endif
+  }
+  tuple->wrap_nodes_weakly = RTEST(rb_weak_eh);
+
+  return rb_weak_eh;
+}
+
+/*
+ *  call-seq:
+ *    weak_node_cache? → Boolean
+ *
+ *  Whether nodes wrapped from now on are only kept alive by references from Ruby. See
+ *  #weak_node_cache=.
+ */
+static VALUE
+weak_node_cache_eh(VALUE self)
+{
+  xmlDocPtr c_document;
+
+  Data_Get_Struct(self, xmlDoc, c_document);
+  return ((nokogiriTuplePtr)c_document->_private)->wrap_nodes_weakly ? Qtrue : Qfalse;
+}
+
 /* call-seq: doc.create_entity(name, type, external_id, system_id, content)
  *
  * Create a new entity named +name+.
@@ -608,6 +665,9 @@ noko_xml_document_wrap_with_init_args(VALUE klass, xmlDocPtr c_document, int arg
   tuple->doc = rb_document;
   tuple->unlinkedNodes = st_init_numtable_with_size(128);
   tuple->node_cache = rb_ary_new();
+  tuple->weak_node_cache = Qnil;
+  tuple->wrap_nodes_weakly = 0;
+  tuple->xpath_context = Qnil;
 
   c_document->_private = tuple ;
 
@@ -681,4 +741,6 @@ noko_init_xml_document()
   rb_define_method(cNokogiriXmlDocument, "url", url, 0);
   rb_define_method(cNokogiriXmlDocument, "create_entity", create_entity, -1);
   rb_define_method(cNokogiriXmlDocument, "remove_namespaces!", remove_namespaces_bang, 0);
+  rb_define_method(cNokogiriXmlDocument, "weak_node_cache=", set_weak_node_cache, 1);
+  rb_define_method(cNokogiriXmlDocument, "weak_node_cache?", weak_node_cache_eh, 0);
 }
@@ -3,7 +3,7 @@
 // :stopdoc:
 
 VALUE cNokogiriXmlNode ;
-static ID id_decorate, id_decorate_bang;
+static ID id_decorate, id_decorate_bang, id_aref, id_aset;
 
 typedef xmlNodePtr(*pivot_reparentee_func)(xmlNodePtr, xmlNodePtr);
 
@@ -47,6 +47,29 @@ _xml_node_update_references(xmlNodePtr node)
 
 typedef void (*gc_callback_t)(void *);
 
+/*
+ *  nodes of a document with a weak node cache (see Document#weak_node_cache=) don't keep their
+ *  ruby object in _private, where it would be left dangling once the object is collected.
+ *  instead the objects are looked up by node address in an ObjectSpace::WeakMap.
+ *
+ *  the key is the whole address: long is 32 bits on LLP64, so it can't hold it. user-space
+ *  addresses fit in a Fixnum, so the key is an immediate and WeakMap's identity lookup matches.
+ */
+static VALUE
+weak_node_cache_key(xmlNodePtr c_node)
+{
+  return ULL2NUM((uintptr_t)c_node);
+}
+
+static VALUE
+weakly_cached_ruby_object(xmlNodePtr c_node)
+{
+  if (!c_node->doc || !DOC_RUBY_OBJECT_TEST(c_node->doc) || NIL_P(DOC_WEAK_NODE_CACHE(c_node->doc))) {
+    return Qnil;
+  }
+  return rb_funcall(DOC_WEAK_NODE_CACHE(c_node->doc), id_aref, 1, weak_node_cache_key(c_node));
+}
+
 static const rb_data_type_t nokogiri_node_type = {
   "Nokogiri/XMLNode",
   {
@@ -1263,6 +1286,7 @@ set(VALUE self, VALUE property, VALUE value)
 {
   xmlNodePtr node, cur;
   xmlAttrPtr prop;
+  int weak;
   Noko_Node_Get_Struct(self, xmlNode, node);
 
   /* If a matching attribute node already exists, then xmlSetProp will destroy
@@ -1270,14 +1294,18 @@ set(VALUE self, VALUE property, VALUE value)
    * pointing to one of those children, we are left with a broken reference.
    *
    * We can avoid this by unlinking these nodes first.
+   *
+   * Nodes wrapped weakly may be in a NodeSet whose objects have been collected,
+   * so in a document with a weak node cache every child is unlinked.
    */
   if (node->type != XML_ELEMENT_NODE) {
     return (Qnil);
   }
+  weak = node->doc && DOC_RUBY_OBJECT_TEST(node->doc) && !NIL_P(DOC_WEAK_NODE_CACHE(node->doc));
   prop = xmlHasProp(node, (xmlChar *)StringValueCStr(property));
   if (prop && prop->children) {
     for (cur = prop->children; cur; cur = cur->next) {
-      if (cur->_private) {
+      if (cur->_private || weak) {
         noko_xml_document_pin_node(cur);
         xmlUnlinkNode(cur);
       }
@@ -1300,15 +1328,26 @@ static VALUE
 get(VALUE self, VALUE rattribute)
 {
   xmlNodePtr node;
+
+  if (NIL_P(rattribute)) { return Qnil; }
+
+  Noko_Node_Get_Struct(self, xmlNode, node);
+  return noko_xml_node_attribute_value(node, rattribute);
+}
+
+/*
+ * the value of +node+'s attribute named +rattribute+ as Node#[] returns it, where a "prefix:name"
+ * attribute is looked up in the namespace bound to the prefix, if there is one
+ */
+VALUE
+noko_xml_node_attribute_value(xmlNodePtr node, VALUE rattribute)
+{
   xmlChar *value = 0;
   VALUE rvalue;
   xmlChar *colon;
   xmlChar *attribute, *attr_name, *prefix;
   xmlNsPtr ns;
 
-  if (NIL_P(rattribute)) { return Qnil; }
-
-  Noko_Node_Get_Struct(self, xmlNode, node);
   attribute = xmlCharStrdup(StringValueCStr(rattribute));
 
   colon = DISCARD_CONST_QUAL_XMLCHAR(xmlStrchr(attribute, (const xmlChar)':'));
@@ -2023,6 +2062,10 @@ noko_xml_node_wrap(VALUE rb_class, xmlNodePtr c_node)
     return (VALUE)c_node->_private;
   }
 
+  if (node_has_a_document && !NIL_P(rb_node = weakly_cached_ruby_object(c_node))) {
+    return rb_node;
+  }
+
   if (!RTEST(rb_class)) {
     switch (c_node->type) {
       case XML_ELEMENT_NODE:
@@ -2067,12 +2110,19 @@ noko_xml_node_wrap(VALUE rb_class, xmlNodePtr c_node)
   }
 
   rb_node = TypedData_Wrap_Struct(rb_class, &nokogiri_node_type, c_node) ;
-  c_node->_private = (void *)rb_node;
+
+  if (node_has_a_document && node_has_a_document->wrap_nodes_weakly) {
+    rb_funcall(DOC_WEAK_NODE_CACHE(c_doc), id_aset, 2, weak_node_cache_key(c_node), rb_node);
+  } else {
+    c_node->_private = (void *)rb_node;
+  }
 
   if (node_has_a_document) {
     rb_document = DOC_RUBY_OBJECT(c_doc);
-    rb_node_cache = DOC_NODE_CACHE(c_doc);
-    rb_ary_push(rb_node_cache, rb_node);
+    if (!node_has_a_document->wrap_nodes_weakly) {
+      rb_node_cache = DOC_NODE_CACHE(c_doc);
+      rb_ary_push(rb_node_cache, rb_node);
+    }
     rb_funcall(rb_document, id_decorate, 1, rb_node);
   }
 
@@ -2160,6 +2210,8 @@ noko_init_xml_node()
   rb_define_private_method(cNokogiriXmlNode, "set", set, 2);
   rb_define_private_method(cNokogiriXmlNode, "set_namespace", set_namespace, 1);
 
+  id_aref          = rb_intern("[]");
+  id_aset          = rb_intern("[]=");
   id_decorate      = rb_intern("decorate");
   id_decorate_bang = rb_intern("decorate!");
 }
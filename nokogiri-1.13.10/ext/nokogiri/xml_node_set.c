@@ -3,6 +3,7 @@
 VALUE cNokogiriXmlNodeSet ;
 
 static ID decorate ;
+static ID id_aref, id_find, id_inner_html, id_outer_html, id_text, id_to_html;
 
 static void
 Check_Node_Set_Node_Type(VALUE node)
@@ -42,12 +43,17 @@ static void
 mark(xmlNodeSetPtr node_set)
 {
   VALUE rb_node;
+  xmlNodePtr c_node;
   int jnode;
 
   for (jnode = 0; jnode < node_set->nodeNr; jnode++) {
-    rb_node = ruby_object_get(node_set->nodeTab[jnode]);
+    c_node = node_set->nodeTab[jnode];
+    rb_node = ruby_object_get(c_node);
     if (rb_node) {
       rb_gc_mark(rb_node);
+    } else if (!NOKOGIRI_NAMESPACE_EH(c_node) && c_node->doc && DOC_RUBY_OBJECT_TEST(c_node->doc)) {
+      /* nodes wrapped weakly (see Document#weak_node_cache=) are kept alive by their document */
+      rb_gc_mark(DOC_RUBY_OBJECT(c_node->doc));
     }
   }
 }
@@ -409,6 +415,191 @@ to_array(VALUE self)
   return list;
 }
 
+/*
+ * calls +method+ on the ruby object for +c_node+, for the nodes that the bulk readers below can't
+ * read directly
+ */
+static VALUE
+node_funcall(VALUE rb_node_set, xmlNodePtr c_node, ID method, int argc, const VALUE *argv)
+{
+  return rb_funcallv(noko_xml_node_wrap_node_set_result(c_node, rb_node_set), method, argc, argv);
+}
+
+/*
+ * :call-seq:
+ *   texts() → Array<String>
+ *
+ * [Returns] The text content of each node in this set, like <tt>map(&:text)</tt> but read
+ * straight from the underlying nodes instead of calling Node#text on each one.
+ *
+ *   doc = Nokogiri::XML('<xml><a><d>foo</d><d>bar</d></a></xml>')
+ *   doc.css('d').texts # => ["foo", "bar"]
+ */
+static VALUE
+rb_xml_node_set_texts(VALUE rb_node_set)
+{
+  xmlNodeSetPtr c_node_set;
+  xmlNodePtr c_node;
+  xmlChar *content;
+  VALUE rb_texts;
+  int j;
+
+  Data_Get_Struct(rb_node_set, xmlNodeSet, c_node_set);
+
+  rb_texts = rb_ary_new2(c_node_set->nodeNr);
+  for (j = 0; j < c_node_set->nodeNr; j++) {
+    c_node = c_node_set->nodeTab[j];
+    if (NOKOGIRI_NAMESPACE_EH(c_node)) {
+      rb_ary_push(rb_texts, node_funcall(rb_node_set, c_node, id_text, 0, NULL));
+      continue;
+    }
+    content = xmlNodeGetContent(c_node);
+    if (content) {
+      rb_ary_push(rb_texts, NOKOGIRI_STR_NEW2(content));
+      xmlFree(content);
+    } else {
+      rb_ary_push(rb_texts, Qnil);
+    }
+  }
+
+  return rb_texts;
+}
+
+/*
+ * :call-seq:
+ *   attribute_values(name) → Array<String, nil>
+ *
+ * [Returns] The value of the attribute +name+ of each node in this set, or nil for the nodes that
+ * don't have it, like <tt>map { |node| node[name] }</tt> but read straight from the underlying
+ * nodes instead of calling Node#[] on each one.
+ *
+ *   doc = Nokogiri::HTML('<a href="/one">1</a><a>2</a><a href="/three">3</a>')
+ *   doc.css('a').attribute_values('href') # => ["/one", nil, "/three"]
+ */
+static VALUE
+rb_xml_node_set_attribute_values(VALUE rb_node_set, VALUE rb_name)
+{
+  xmlNodeSetPtr c_node_set;
+  xmlNodePtr c_node;
+  VALUE rb_values;
+  int j;
+
+  Data_Get_Struct(rb_node_set, xmlNodeSet, c_node_set);
+  rb_name = rb_obj_as_string(rb_name);
+
+  rb_values = rb_ary_new2(c_node_set->nodeNr);
+  for (j = 0; j < c_node_set->nodeNr; j++) {
+    c_node = c_node_set->nodeTab[j];
+    if (NOKOGIRI_NAMESPACE_EH(c_node)) {
+      rb_ary_push(rb_values, node_funcall(rb_node_set, c_node, id_aref, 1, &rb_name));
+    } else {
+      rb_ary_push(rb_values, noko_xml_node_attribute_value(c_node, rb_name));
+    }
+  }
+
+  return rb_values;
+}
+
+/*
+ * appends +c_node+ serialized the way Node#to_html does it by default to +rb_string+
+ */
+static void
+append_html(VALUE rb_string, xmlNodePtr c_node)
+{
+  xmlBufferPtr buffer;
+  xmlSaveCtxtPtr savectx;
+  const char *before_indent;
+
+  buffer = xmlBufferCreate();
+
+  xmlIndentTreeOutput = 1;
+  before_indent = xmlTreeIndentString;
+  xmlTreeIndentString = "  ";
+
+  savectx = xmlSaveToBuffer(buffer, (const char *)c_node->doc->encoding,
+                            XML_SAVE_FORMAT | XML_SAVE_NO_DECL | XML_SAVE_NO_EMPTY | XML_SAVE_AS_HTML);
+  if (savectx) {
+    xmlSaveTree(savectx, c_node);
+    xmlSaveClose(savectx);
+  }
+
+  xmlTreeIndentString = before_indent;
+
+  rb_str_buf_cat(rb_string, (const char *)xmlBufferContent(buffer), xmlBufferLength(buffer));
+  xmlBufferFree(buffer);
+}
+
+/*
+ * :call-seq:
+ *   to_strings(:outer_html) → Array<String>
+ *   to_strings(:inner_html) → Array<String>
+ *
+ * [Returns]
+ *   The HTML of each node in this set, like <tt>map(&:to_html)</tt> for +:outer_html+ or
+ *   <tt>map(&:inner_html)</tt> for +:inner_html+, but serialized straight from the underlying
+ *   nodes, without creating a Node object for any of their children.
+ *
+ *   doc = Nokogiri::HTML('<p>one <b>1</b></p><p>two</p>')
+ *   doc.css('p').to_strings(:inner_html) # => ["one <b>1</b>", "two"]
+ */
+static VALUE
+rb_xml_node_set_to_strings(VALUE rb_node_set, VALUE rb_kind)
+{
+  xmlNodeSetPtr c_node_set;
+  xmlNodePtr c_node, c_child;
+  xmlDocPtr c_encoding_doc = NULL;
+  rb_encoding *encoding = NULL;
+  VALUE rb_strings, rb_string;
+  ID method;
+  int j;
+
+  if (rb_kind == ID2SYM(id_outer_html)) {
+    method = id_to_html;
+  } else if (rb_kind == ID2SYM(id_inner_html)) {
+    method = id_inner_html;
+  } else {
+    rb_raise(rb_eArgError, "expected :outer_html or :inner_html, got %"PRIsVALUE, rb_inspect(rb_kind));
+  }
+
+  Data_Get_Struct(rb_node_set, xmlNodeSet, c_node_set);
+
+  rb_strings = rb_ary_new2(c_node_set->nodeNr);
+  for (j = 0; j < c_node_set->nodeNr; j++) {
+    c_node = c_node_set->nodeTab[j];
+    if (NOKOGIRI_NAMESPACE_EH(c_node)
+        || !DOC_RUBY_OBJECT_TEST(c_node->doc)
+        || rb_obj_is_kind_of(DOC_RUBY_OBJECT(c_node->doc), cNokogiriHtml5Document)) {
+      /* HTML5 documents have their own serializer */
+      rb_ary_push(rb_strings, node_funcall(rb_node_set, c_node, method, 0, NULL));
+      continue;
+    }
+
+    /* the strings are in the document's encoding, as in Node#serialize */
+    if (c_node->doc != c_encoding_doc) {
+      c_encoding_doc = c_node->doc;
+      encoding = c_encoding_doc->encoding
+                 ? rb_to_encoding(rb_funcall(rb_cEncoding, id_find, 1, NOKOGIRI_STR_NEW2(c_encoding_doc->encoding)))
+                 : rb_utf8_encoding();
+    }
+
+    if (method == id_to_html) {
+      rb_string = rb_enc_str_new(NULL, 0, encoding);
+      append_html(rb_string, c_node);
+    } else if (c_node->children) {
+      /* Node#inner_html serializes each child separately and joins the results */
+      rb_string = rb_enc_str_new(NULL, 0, encoding);
+      for (c_child = c_node->children; c_child; c_child = c_child->next) {
+        append_html(rb_string, c_child);
+      }
+    } else {
+      rb_string = rb_usascii_str_new(NULL, 0);
+    }
+    rb_ary_push(rb_strings, rb_string);
+  }
+
+  return rb_strings;
+}
+
 /*
  *  call-seq:
  *    unlink
@@ -493,6 +684,15 @@ noko_init_xml_node_set(void)
   rb_define_method(cNokogiriXmlNodeSet, "delete", delete, 1);
   rb_define_method(cNokogiriXmlNodeSet, "&", intersection, 1);
   rb_define_method(cNokogiriXmlNodeSet, "include?", include_eh, 1);
+  rb_define_method(cNokogiriXmlNodeSet, "texts", rb_xml_node_set_texts, 0);
+  rb_define_method(cNokogiriXmlNodeSet, "attribute_values", rb_xml_node_set_attribute_values, 1);
+  rb_define_method(cNokogiriXmlNodeSet, "to_strings", rb_xml_node_set_to_strings, 1);
 
   decorate = rb_intern("decorate");
+  id_aref = rb_intern("[]");
+  id_find = rb_intern("find");
+  id_inner_html = rb_intern("inner_html");
+  id_outer_html = rb_intern("outer_html");
+  id_text = rb_intern("text");
+  id_to_html = rb_intern("to_html");
 }
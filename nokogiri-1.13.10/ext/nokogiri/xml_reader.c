@@ -2,6 +2,13 @@
 
 VALUE cNokogiriXmlReader;
 
+/*
+ *  set when #each_element leaves the reader on a node that it hasn't looked at yet, because the
+ *  block broke out after the reader had moved past a match. the next #each_element starts there
+ *  instead of reading past it, and #read clears it.
+ */
+static const char *UNVISITED_IVAR = "@each_element_unvisited";
+
 static void
 dealloc(xmlTextReaderPtr reader)
 {
@@ -515,6 +522,18 @@ node_type(VALUE self)
   return INT2NUM((long)xmlTextReaderNodeType(reader));
 }
 
+static VALUE
+read_error(int ret)
+{
+  xmlErrorPtr error;
+
+  error = xmlGetLastError();
+  if (error) {
+    return Nokogiri_wrap_xml_syntax_error(error);
+  }
+  return rb_exc_new_str(rb_eRuntimeError, rb_sprintf("Error pulling: %d", ret));
+}
+
 /*
  * call-seq:
  *   read
@@ -525,12 +544,15 @@ static VALUE
 read_more(VALUE self)
 {
   xmlTextReaderPtr reader;
-  xmlErrorPtr error;
   VALUE error_list;
   int ret;
 
   Data_Get_Struct(self, xmlTextReader, reader);
 
+  if (RTEST(rb_iv_get(self, UNVISITED_IVAR))) {
+    rb_iv_set(self, UNVISITED_IVAR, Qfalse);
+  }
+
   error_list = rb_funcall(self, rb_intern("errors"), 0);
 
   xmlSetStructuredErrorFunc((void *)error_list, Nokogiri_error_array_pusher);
@@ -540,16 +562,182 @@ read_more(VALUE self)
   if (ret == 1) { return self; }
   if (ret == 0) { return Qnil; }
 
-  error = xmlGetLastError();
-  if (error) {
-    rb_exc_raise(Nokogiri_wrap_xml_syntax_error(error));
+  rb_exc_raise(read_error(ret));
+
+  return Qnil;
+}
+
+/*
+ * moves the reader with +step+, collecting errors into +error_list+ like #read does. on failure,
+ * the error to raise is stored in +rb_error+ if it's given, and raised otherwise.
+ */
+static int
+reader_step(xmlTextReaderPtr reader, VALUE error_list, int (*step)(xmlTextReaderPtr), VALUE *rb_error)
+{
+  int ret;
+
+  xmlSetStructuredErrorFunc((void *)error_list, Nokogiri_error_array_pusher);
+  ret = step(reader);
+  xmlSetStructuredErrorFunc(NULL, NULL);
+
+  if (ret < 0) {
+    if (!rb_error) { rb_exc_raise(read_error(ret)); }
+    *rb_error = read_error(ret);
+  }
+  return ret;
+}
+
+static int
+reader_expand(xmlTextReaderPtr reader)
+{
+  return xmlTextReaderExpand(reader) ? 1 : -1;
+}
+
+typedef struct {
+  VALUE rb_reader;
+  xmlTextReaderPtr c_reader;
+  const xmlChar *c_name;
+  xmlPatternPtr c_pattern;
+  /* whether the reader is on a node that hasn't been matched against the pattern yet */
+  int unvisited;
+} EachElementArgs;
+
+static int
+element_matches_p(EachElementArgs *args)
+{
+  if (xmlTextReaderNodeType(args->c_reader) != XML_READER_TYPE_ELEMENT) { return 0; }
+  if (args->c_name) {
+    return xmlStrEqual(xmlTextReaderConstName(args->c_reader), args->c_name);
+  }
+  return xmlPatternMatch(args->c_pattern, xmlTextReaderCurrentNode(args->c_reader)) == 1;
+}
+
+/* a detached copy of the reader's current node, in a new document */
+static VALUE
+copy_current_node(xmlTextReaderPtr c_reader)
+{
+  VALUE rb_document, rb_copy;
+  xmlDocPtr c_document;
+  xmlNodePtr c_copy;
+  const xmlChar *c_encoding;
+
+  c_document = xmlNewDoc((const xmlChar *)"1.0");
+  c_encoding = xmlTextReaderConstEncoding(c_reader);
+  if (c_encoding) {
+    c_document->encoding = xmlStrdup(c_encoding);
+  }
+
+  c_copy = xmlDocCopyNode(xmlTextReaderCurrentNode(c_reader), c_document, 1);
+  if (c_copy == NULL) {
+    xmlFreeDoc(c_document);
+    rb_raise(rb_eRuntimeError, "Could not copy element (xmlDocCopyNode)");
+  }
+  xmlDocSetRootElement(c_document, c_copy);
+
+  rb_document = noko_xml_document_wrap(cNokogiriXmlDocument, c_document);
+  rb_copy = noko_xml_node_wrap(Qnil, c_copy);
+  RB_GC_GUARD(rb_document);
+
+  return rb_copy;
+}
+
+static VALUE
+each_element(VALUE data)
+{
+  EachElementArgs *args = (EachElementArgs *)data;
+  VALUE error_list, rb_element, rb_error = Qnil;
+  int ret;
+
+  error_list = rb_funcall(args->rb_reader, rb_intern("errors"), 0);
+
+  if (args->unvisited) {
+    /* an earlier call broke out of its block with the reader already past its match */
+    args->unvisited = 0;
+    ret = 1;
   } else {
-    rb_raise(rb_eRuntimeError, "Error pulling: %d", ret);
+    ret = reader_step(args->c_reader, error_list, xmlTextReaderRead, NULL);
   }
+  while (ret == 1) {
+    if (!element_matches_p(args)) {
+      ret = reader_step(args->c_reader, error_list, xmlTextReaderRead, NULL);
+      continue;
+    }
 
+    reader_step(args->c_reader, error_list, reader_expand, NULL);
+    rb_element = copy_current_node(args->c_reader);
+
+    /*
+     * a match's descendants are skipped, matching or not. the reader moves past them before the
+     * block runs, so that it's in the right place if the block breaks out, and an error in what
+     * follows is raised after the block has seen the match.
+     */
+    ret = reader_step(args->c_reader, error_list, xmlTextReaderNext, &rb_error);
+    args->unvisited = (ret == 1);
+    rb_yield(rb_element);
+    args->unvisited = 0;
+    if (!NIL_P(rb_error)) { rb_exc_raise(rb_error); }
+  }
+
+  return args->rb_reader;
+}
+
+static VALUE
+each_element_cleanup(VALUE data)
+{
+  EachElementArgs *args = (EachElementArgs *)data;
+
+  rb_iv_set(args->rb_reader, UNVISITED_IVAR, args->unvisited ? Qtrue : Qfalse);
+  if (args->c_pattern) {
+    xmlFreePattern(args->c_pattern);
+  }
   return Qnil;
 }
 
+/*
+ * call-seq:
+ *   native_each_element(pattern, namespace_list) { |element| ... }
+ *
+ * Read through the rest of the document, yielding a copy of each element that matches +pattern+,
+ * which is either an element's qualified name or a pattern for xmlPatterncompile().
+ * +namespace_list+ is a flat array of URI and prefix pairs for the prefixes in the pattern.
+ *
+ * Each match is expanded, copied into a new document and then skipped with xmlTextReaderNext(),
+ * so the reader only ever holds one match in memory. Everything else is read without leaving C.
+ */
+static VALUE
+rb_xml_reader_native_each_element(VALUE rb_reader, VALUE rb_pattern, VALUE rb_namespace_list)
+{
+  EachElementArgs args;
+  const xmlChar **c_namespaces;
+  long j;
+
+  args.rb_reader = rb_reader;
+  Data_Get_Struct(rb_reader, xmlTextReader, args.c_reader);
+  args.c_name = NULL;
+  args.c_pattern = NULL;
+  args.unvisited = RTEST(rb_iv_get(rb_reader, UNVISITED_IVAR));
+
+  StringValueCStr(rb_pattern);
+  Check_Type(rb_namespace_list, T_ARRAY);
+
+  if (strpbrk(RSTRING_PTR(rb_pattern), "/[]@*|() ") == NULL) {
+    args.c_name = (const xmlChar *)RSTRING_PTR(rb_pattern);
+  } else {
+    c_namespaces = ALLOCA_N(const xmlChar *, RARRAY_LEN(rb_namespace_list) + 2);
+    for (j = 0; j < RARRAY_LEN(rb_namespace_list); j++) {
+      c_namespaces[j] = (const xmlChar *)StringValueCStr(RARRAY_PTR(rb_namespace_list)[j]);
+    }
+    c_namespaces[j] = c_namespaces[j + 1] = NULL;
+
+    args.c_pattern = xmlPatterncompile((const xmlChar *)RSTRING_PTR(rb_pattern), NULL, 0, c_namespaces);
+    if (args.c_pattern == NULL) {
+      rb_raise(rb_eArgError, "invalid element pattern: %"PRIsVALUE, rb_pattern);
+    }
+  }
+
+  return rb_ensure(each_element, (VALUE)&args, each_element_cleanup, (VALUE)&args);
+}
+
 /*
  * call-seq:
  *   inner_xml
@@ -771,4 +959,6 @@ noko_init_xml_reader()
   rb_define_method(cNokogiriXmlReader, "value", value, 0);
   rb_define_method(cNokogiriXmlReader, "value?", value_eh, 0);
   rb_define_method(cNokogiriXmlReader, "xml_version", xml_version, 0);
+
+  rb_define_private_method(cNokogiriXmlReader, "native_each_element", rb_xml_reader_native_each_element, 2);
 }
@@ -9,12 +9,56 @@ VALUE cNokogiriXmlXpathContext;
 static const xmlChar *NOKOGIRI_BUILTIN_PREFIX = (const xmlChar *)"nokogiri-builtin";
 static const xmlChar *NOKOGIRI_BUILTIN_URI = (const xmlChar *)"https://www.nokogiri.org/default_ns/ruby/builtins";
 
+/*
+ * Compiled expressions are shared by every context in the process, keyed by
+ * the expression and the namespace bindings it was evaluated with. The cache
+ * is a Hash kept in least-recently-used order: a hit moves its entry to the
+ * end, and the entry at the front is dropped once the cache is full.
+ *
+ * The cache is only touched with the GVL held. A cached expression is only
+ * evaluated when no custom function handler is registered, so evaluation
+ * never calls back into Ruby and another thread can't use the same
+ * expression concurrently. Entries are Ruby objects, so an expression that is
+ * evicted while being evaluated is kept alive by the evaluating frame.
+ */
+#define XPATH_EXPRESSION_CACHE_SIZE 256
+
+static VALUE xpath_expression_cache;
+
 static void
-deallocate(xmlXPathContextPtr ctx)
+xml_xpath_comp_expr_dealloc(void *comp)
 {
-  NOKOGIRI_DEBUG_START(ctx);
-  xmlXPathFreeContext(ctx);
-  NOKOGIRI_DEBUG_END(ctx);
+  xmlXPathFreeCompExpr((xmlXPathCompExprPtr)comp);
+}
+
+static const rb_data_type_t xml_xpath_comp_expr_type = {
+  "Nokogiri/XMLXPathCompExpr",
+  {0, xml_xpath_comp_expr_dealloc, 0},
+  0, 0,
+#ifdef RUBY_TYPED_FREE_IMMEDIATELY
+  RUBY_TYPED_FREE_IMMEDIATELY,
+#endif
+};
+
+typedef struct _nokogiriXPathContext {
+  xmlXPathContextPtr ctx;
+  /* prefix and URI of every register_ns call, each followed by a NUL byte */
+  VALUE namespaces;
+} nokogiriXPathContext;
+
+static void
+mark(nokogiriXPathContext *wrapper)
+{
+  rb_gc_mark(wrapper->namespaces);
+}
+
+static void
+deallocate(nokogiriXPathContext *wrapper)
+{
+  NOKOGIRI_DEBUG_START(wrapper->ctx);
+  xmlXPathFreeContext(wrapper->ctx);
+  NOKOGIRI_DEBUG_END(wrapper->ctx);
+  free(wrapper);
 }
 
 /* find a CSS class in an HTML element's `class` attribute */
@@ -115,13 +159,20 @@ xpath_builtin_local_name_is(xmlXPathParserContextPtr ctxt, int nargs)
 static VALUE
 register_ns(VALUE self, VALUE prefix, VALUE uri)
 {
-  xmlXPathContextPtr ctx;
-  Data_Get_Struct(self, xmlXPathContext, ctx);
+  nokogiriXPathContext *wrapper;
+  Data_Get_Struct(self, nokogiriXPathContext, wrapper);
 
-  xmlXPathRegisterNs(ctx,
+  xmlXPathRegisterNs(wrapper->ctx,
                      (const xmlChar *)StringValueCStr(prefix),
                      (const xmlChar *)StringValueCStr(uri)
                     );
+
+  if (NIL_P(wrapper->namespaces)) {
+    wrapper->namespaces = rb_str_buf_new(0);
+  }
+  rb_str_buf_cat(wrapper->namespaces, RSTRING_PTR(prefix), RSTRING_LEN(prefix) + 1);
+  rb_str_buf_cat(wrapper->namespaces, RSTRING_PTR(uri), RSTRING_LEN(uri) + 1);
+
   return self;
 }
 
@@ -136,7 +187,9 @@ register_variable(VALUE self, VALUE name, VALUE value)
 {
   xmlXPathContextPtr ctx;
   xmlXPathObjectPtr xmlValue;
-  Data_Get_Struct(self, xmlXPathContext, ctx);
+  nokogiriXPathContext *wrapper;
+  Data_Get_Struct(self, nokogiriXPathContext, wrapper);
+  ctx = wrapper->ctx;
 
   xmlValue = xmlXPathNewCString(StringValueCStr(value));
 
@@ -303,6 +356,76 @@ xpath_generic_exception_handler(void *ctx, const char *msg, ...)
   rb_raise(rb_eRuntimeError, "%s", message);
 }
 
+/*
+ *  errors from evaluating a compiled expression don't carry the expression
+ *  the way errors from xmlXPathEvalExpression do, so fill it in from
+ *  +search_path+.
+ */
+static VALUE
+compiled_eval_error(xmlErrorPtr error, VALUE search_path)
+{
+  VALUE exception = Nokogiri_wrap_xml_syntax_error(error);
+
+  if (error && error->domain == XML_FROM_XPATH && error->str1 == NULL) {
+    rb_iv_set(exception, "@str1", search_path);
+    rb_iv_set(exception, "@int1", LONG2NUM(RSTRING_LEN(search_path)));
+  }
+  return exception;
+}
+
+NORETURN(static void compiled_eval_error_raise(void *ctx, xmlErrorPtr error));
+static void
+compiled_eval_error_raise(void *ctx, xmlErrorPtr error)
+{
+  rb_exc_raise(compiled_eval_error(error, (VALUE)ctx));
+}
+
+static int
+oldest_expression_i(VALUE key, VALUE value, VALUE oldest)
+{
+  *(VALUE *)oldest = key;
+  return ST_STOP;
+}
+
+/*
+ *  returns the cached compilation of +search_path+ under the namespace
+ *  bindings +namespaces+, compiling and caching it on a miss.
+ *  returns Qnil if the expression could not be compiled.
+ */
+static VALUE
+compiled_expression(VALUE search_path, VALUE namespaces, xmlXPathContextPtr ctx)
+{
+  VALUE key, rb_comp;
+  xmlXPathCompExprPtr comp;
+
+  /* the bindings contain NUL bytes and the expression can't, so the keys can't collide */
+  if (NIL_P(namespaces)) {
+    key = search_path;
+  } else {
+    key = rb_str_dup(namespaces);
+    rb_str_buf_cat(key, RSTRING_PTR(search_path), RSTRING_LEN(search_path));
+  }
+
+  rb_comp = rb_hash_delete(xpath_expression_cache, key);
+  if (NIL_P(rb_comp)) {
+    comp = xmlXPathCtxtCompile(ctx, (const xmlChar *)StringValueCStr(search_path));
+    if (comp == NULL) {
+      return Qnil;
+    }
+    /* hidden, like the cache itself, so Ruby code never sees the expression */
+    rb_comp = TypedData_Wrap_Struct(0, &xml_xpath_comp_expr_type, comp);
+
+    if (RHASH_SIZE(xpath_expression_cache) >= XPATH_EXPRESSION_CACHE_SIZE) {
+      VALUE oldest = Qnil;
+      rb_hash_foreach(xpath_expression_cache, oldest_expression_i, (VALUE)&oldest);
+      rb_hash_delete(xpath_expression_cache, oldest);
+    }
+  }
+  rb_hash_aset(xpath_expression_cache, key, rb_comp);
+
+  return rb_comp;
+}
+
 /*
  * call-seq:
  *  evaluate(search_path, handler = nil)
@@ -314,11 +437,15 @@ evaluate(int argc, VALUE *argv, VALUE self)
 {
   VALUE search_path, xpath_handler;
   VALUE retval = Qnil;
+  VALUE rb_comp = Qnil;
+  nokogiriXPathContext *wrapper;
   xmlXPathContextPtr ctx;
+  xmlXPathCompExprPtr comp;
   xmlXPathObjectPtr xpath;
   xmlChar *query;
 
-  Data_Get_Struct(self, xmlXPathContext, ctx);
+  Data_Get_Struct(self, nokogiriXPathContext, wrapper);
+  ctx = wrapper->ctx;
 
   if (rb_scan_args(argc, argv, "11", &search_path, &xpath_handler) == 1) {
     xpath_handler = Qnil;
@@ -339,13 +466,31 @@ evaluate(int argc, VALUE *argv, VALUE self)
   /* when there is a non existent function. */
   xmlSetGenericErrorFunc(NULL, xpath_generic_exception_handler);
 
-  xpath = xmlXPathEvalExpression(query, ctx);
+  if (ctx->funcLookupFunc == NULL) {
+    /*
+     * libxml2 remembers the function each call resolves to in the compiled
+     * expression, so expressions are only shared while the functions come
+     * from the builtins, which are the same in every context.
+     */
+    rb_comp = compiled_expression(search_path, wrapper->namespaces, ctx);
+    if (NIL_P(rb_comp)) {
+      xpath = NULL;
+    } else {
+      TypedData_Get_Struct(rb_comp, xmlXPathCompExpr, &xml_xpath_comp_expr_type, comp);
+      xmlSetStructuredErrorFunc((void *)search_path, compiled_eval_error_raise);
+      xpath = xmlXPathCompiledEval(comp, ctx);
+    }
+  } else {
+    xpath = xmlXPathEvalExpression(query, ctx);
+  }
+  RB_GC_GUARD(rb_comp);
+
   xmlSetStructuredErrorFunc(NULL, NULL);
   xmlSetGenericErrorFunc(NULL, NULL);
 
   if (xpath == NULL) {
     xmlErrorPtr error = xmlGetLastError();
-    rb_exc_raise(Nokogiri_wrap_xml_syntax_error(error));
+    rb_exc_raise(compiled_eval_error(error, search_path));
   }
 
   retval = xpath2ruby(xpath, ctx);
@@ -358,20 +503,11 @@ evaluate(int argc, VALUE *argv, VALUE self)
   return retval;
 }
 
-/*
- * call-seq:
- *  new(node)
- *
- * Create a new XPathContext with +node+ as the reference point.
- */
 static VALUE
-new (VALUE klass, VALUE nodeobj)
+xpath_context_new(VALUE klass, xmlNodePtr node)
 {
-  xmlNodePtr node;
+  nokogiriXPathContext *wrapper;
   xmlXPathContextPtr ctx;
-  VALUE self;
-
-  Noko_Node_Get_Struct(nodeobj, xmlNode, node);
 
 #if LIBXML_VERSION < 21000
   /* deprecated in 40483d0 */
@@ -387,10 +523,97 @@ new (VALUE klass, VALUE nodeobj)
   xmlXPathRegisterFuncNS(ctx, (const xmlChar *)"local-name-is", NOKOGIRI_BUILTIN_URI,
                          xpath_builtin_local_name_is);
 
-  self = Data_Wrap_Struct(klass, 0, deallocate, ctx);
+  wrapper = (nokogiriXPathContext *)malloc(sizeof(nokogiriXPathContext));
+  wrapper->ctx = ctx;
+  wrapper->namespaces = Qnil;
+
+  return Data_Wrap_Struct(klass, mark, deallocate, wrapper);
+}
+
+/*
+ * call-seq:
+ *  new(node)
+ *
+ * Create a new XPathContext with +node+ as the reference point.
+ */
+static VALUE
+new (VALUE klass, VALUE nodeobj)
+{
+  xmlNodePtr node;
+
+  Noko_Node_Get_Struct(nodeobj, xmlNode, node);
+
+  return xpath_context_new(klass, node);
+}
+
+/*
+ * call-seq:
+ *  acquire(node)
+ *
+ * Take the context that +node+'s document keeps for reuse, with +node+ as the
+ * reference point, or create a new one if another search is using it. Hand it
+ * back with #release when the search is done.
+ */
+static VALUE
+acquire(VALUE klass, VALUE nodeobj)
+{
+  xmlNodePtr node;
+  nokogiriTuplePtr tuple;
+  nokogiriXPathContext *wrapper;
+  VALUE self;
+
+  Noko_Node_Get_Struct(nodeobj, xmlNode, node);
+
+  tuple = (nokogiriTuplePtr)node->doc->_private;
+  self = tuple->xpath_context;
+  if (NIL_P(self)) {
+    return xpath_context_new(klass, node);
+  }
+  tuple->xpath_context = Qnil;
+
+  Data_Get_Struct(self, nokogiriXPathContext, wrapper);
+  wrapper->ctx->node = node;
+
   return self;
 }
 
+/*
+ * call-seq:
+ *  release
+ *
+ * Forget the namespaces, variables and handler registered on this context and
+ * keep it with its document for the next #acquire, unless the document
+ * already keeps one.
+ */
+static VALUE
+release(VALUE self)
+{
+  nokogiriXPathContext *wrapper;
+  xmlXPathContextPtr ctx;
+  nokogiriTuplePtr tuple;
+
+  Data_Get_Struct(self, nokogiriXPathContext, wrapper);
+  ctx = wrapper->ctx;
+
+  tuple = (nokogiriTuplePtr)ctx->doc->_private;
+  if (!NIL_P(tuple->xpath_context)) {
+    return Qnil;
+  }
+
+  if (!NIL_P(wrapper->namespaces)) {
+    xmlXPathRegisteredNsCleanup(ctx);
+    xmlXPathRegisterNs(ctx, NOKOGIRI_BUILTIN_PREFIX, NOKOGIRI_BUILTIN_URI);
+    wrapper->namespaces = Qnil;
+  }
+  xmlXPathRegisteredVariablesCleanup(ctx);
+  xmlXPathRegisterFuncLookup(ctx, NULL, NULL);
+  ctx->userData = NULL;
+
+  tuple->xpath_context = self;
+
+  return Qnil;
+}
+
 void
 noko_init_xml_xpath_context(void)
 {
@@ -401,9 +624,14 @@ noko_init_xml_xpath_context(void)
 
   rb_undef_alloc_func(cNokogiriXmlXpathContext);
 
+  xpath_expression_cache = rb_obj_hide(rb_hash_new());
+  rb_gc_register_mark_object(xpath_expression_cache);
+
   rb_define_singleton_method(cNokogiriXmlXpathContext, "new", new, 1);
+  rb_define_singleton_method(cNokogiriXmlXpathContext, "acquire", acquire, 1);
 
   rb_define_method(cNokogiriXmlXpathContext, "evaluate", evaluate, -1);
   rb_define_method(cNokogiriXmlXpathContext, "register_variable", register_variable, 2);
   rb_define_method(cNokogiriXmlXpathContext, "register_ns", register_ns, 2);
+  rb_define_method(cNokogiriXmlXpathContext, "release", release, 0);
 }
@@ -0,0 +1,227 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "macros.h"
+
+// Blocks are handed out in multiples of this many bytes, which is also their
+// alignment. None of the parser's structures need more than 8.
+#define GRANULE ((size_t) 8)
+
+// Blocks up to this size are carved out of chunks and recycled through a free
+// list per multiple of GRANULE. That covers nodes, attributes, errors and
+// nearly all strings and vectors; anything bigger is rare enough to leave to
+// malloc(3).
+#define MAX_SMALL_SIZE ((size_t) 512)
+#define NUM_SIZE_CLASSES (MAX_SMALL_SIZE / GRANULE)
+
+// Chunks start out sized from the input and double up to this size.
+#define MIN_CHUNK_SIZE ((size_t) 4096)
+#define MAX_CHUNK_SIZE ((size_t) 1 << 20)
+
+// Every block is preceded by the index of its size class, so that free and
+// realloc know how big it is. Blocks from malloc(3) use size class 0.
+typedef union {
+  size_t size_class;
+  uint64_t align;
+} BlockHeader;
+
+// Header of a block that is too big for the chunks. These are kept on a
+// circular list so that they can be freed with the arena.
+typedef struct LargeBlock {
+  struct LargeBlock* prev;
+  struct LargeBlock* next;
+  BlockHeader header;
+} LargeBlock;
+
+typedef union Chunk {
+  union Chunk* next;
+  uint64_t align;
+} Chunk;
+
+struct GumboInternalArena {
+  // Unused part of the most recent chunk.
+  char* free_start;
+  char* free_end;
+
+  Chunk* chunks;
+  size_t next_chunk_size;
+
+  // Sentinel of the list of large blocks.
+  LargeBlock large_blocks;
+
+  // Freed blocks of each size class, linked through their first word.
+  void* free_lists[NUM_SIZE_CLASSES + 1];
+};
+
+static THREAD_LOCAL GumboArena* current_arena;
+
+static size_t size_class_for(size_t size) {
+  return size <= GRANULE ? 1 : (size + GRANULE - 1) / GRANULE;
+}
+
+static BlockHeader* header_of(void* ptr) {
+  return (BlockHeader*) ptr - 1;
+}
+
+GumboArena* gumbo_arena_create(size_t input_length) {
+  GumboArena* arena = malloc(sizeof(GumboArena));
+  if (unlikely(arena == NULL)) {
+    perror(__func__);
+    abort();
+  }
+  arena->free_start = NULL;
+  arena->free_end = NULL;
+  arena->chunks = NULL;
+  // The tree for a document takes a few times the size of the input, so a
+  // chunk of half the input is a reasonable first guess for short documents
+  // that stays cheap to throw away for fragments.
+  size_t chunk_size = input_length / 2;
+  if (chunk_size < MIN_CHUNK_SIZE)
+    chunk_size = MIN_CHUNK_SIZE;
+  if (chunk_size > MAX_CHUNK_SIZE)
+    chunk_size = MAX_CHUNK_SIZE;
+  arena->next_chunk_size = chunk_size;
+  arena->large_blocks.prev = &arena->large_blocks;
+  arena->large_blocks.next = &arena->large_blocks;
+  memset(arena->free_lists, 0, sizeof(arena->free_lists));
+  return arena;
+}
+
+void gumbo_arena_destroy(GumboArena* arena) {
+  Chunk* chunk = arena->chunks;
+  while (chunk) {
+    Chunk* next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  LargeBlock* block = arena->large_blocks.next;
+  while (block != &arena->large_blocks) {
+    LargeBlock* next = block->next;
+    free(block);
+    block = next;
+  }
+  free(arena);
+}
+
+GumboArena* gumbo_arena_current(void) {
+  return current_arena;
+}
+
+GumboArena* gumbo_arena_set_current(GumboArena* arena) {
+  GumboArena* previous = current_arena;
+  current_arena = arena;
+  return previous;
+}
+
+// Puts the unused tail of the current chunk on a free list, so that it isn't
+// wasted when a new chunk is started.
+static void retire_free_space(GumboArena* arena) {
+  size_t remaining = arena->free_end - arena->free_start;
+  if (remaining < sizeof(BlockHeader) + GRANULE)
+    return;
+  size_t size_class = (remaining - sizeof(BlockHeader)) / GRANULE;
+  if (size_class > NUM_SIZE_CLASSES)
+    size_class = NUM_SIZE_CLASSES;
+  BlockHeader* header = (BlockHeader*) arena->free_start;
+  header->size_class = size_class;
+  void* ptr = header + 1;
+  *(void**) ptr = arena->free_lists[size_class];
+  arena->free_lists[size_class] = ptr;
+}
+
+static bool add_chunk(GumboArena* arena, size_t min_size) {
+  size_t size = arena->next_chunk_size;
+  if (size < sizeof(Chunk) + min_size)
+    size = sizeof(Chunk) + min_size;
+  Chunk* chunk = malloc(size);
+  if (unlikely(chunk == NULL))
+    return false;
+  retire_free_space(arena);
+  chunk->next = arena->chunks;
+  arena->chunks = chunk;
+  arena->free_start = (char*) (chunk + 1);
+  arena->free_end = (char*) chunk + size;
+  if (arena->next_chunk_size < MAX_CHUNK_SIZE)
+    arena->next_chunk_size *= 2;
+  return true;
+}
+
+static void* alloc_large(GumboArena* arena, size_t size) {
+  LargeBlock* block = malloc(sizeof(LargeBlock) + size);
+  if (unlikely(block == NULL))
+    return NULL;
+  block->prev = &arena->large_blocks;
+  block->next = arena->large_blocks.next;
+  block->prev->next = block;
+  block->next->prev = block;
+  block->header.size_class = 0;
+  return block + 1;
+}
+
+void* gumbo_arena_alloc(GumboArena* arena, size_t size) {
+  if (size > MAX_SMALL_SIZE)
+    return alloc_large(arena, size);
+
+  size_t size_class = size_class_for(size);
+  void* ptr = arena->free_lists[size_class];
+  if (ptr) {
+    arena->free_lists[size_class] = *(void**) ptr;
+    return ptr;
+  }
+
+  size_t block_size = sizeof(BlockHeader) + size_class * GRANULE;
+  if ((size_t) (arena->free_end - arena->free_start) < block_size) {
+    if (!add_chunk(arena, block_size))
+      return NULL;
+  }
+  BlockHeader* header = (BlockHeader*) arena->free_start;
+  arena->free_start += block_size;
+  header->size_class = size_class;
+  return header + 1;
+}
+
+void* gumbo_arena_realloc(GumboArena* arena, void* ptr, size_t size) {
+  if (ptr == NULL)
+    return gumbo_arena_alloc(arena, size);
+
+  size_t size_class = header_of(ptr)->size_class;
+  if (size_class == 0) {
+    LargeBlock* block = (LargeBlock*) ptr - 1;
+    block = realloc(block, sizeof(LargeBlock) + size);
+    if (unlikely(block == NULL))
+      return NULL;
+    block->prev->next = block;
+    block->next->prev = block;
+    return block + 1;
+  }
+
+  size_t capacity = size_class * GRANULE;
+  if (size <= capacity)
+    return ptr;
+  void* new_ptr = gumbo_arena_alloc(arena, size);
+  if (unlikely(new_ptr == NULL))
+    return NULL;
+  memcpy(new_ptr, ptr, capacity);
+  gumbo_arena_free(arena, ptr);
+  return new_ptr;
+}
+
+void gumbo_arena_free(GumboArena* arena, void* ptr) {
+  if (ptr == NULL)
+    return;
+  size_t size_class = header_of(ptr)->size_class;
+  if (size_class == 0) {
+    LargeBlock* block = (LargeBlock*) ptr - 1;
+    block->prev->next = block->next;
+    block->next->prev = block->prev;
+    free(block);
+    return;
+  }
+  assert(size_class <= NUM_SIZE_CLASSES);
+  *(void**) ptr = arena->free_lists[size_class];
+  arena->free_lists[size_class] = ptr;
+}
@@ -0,0 +1,46 @@
+#ifndef GUMBO_ARENA_H_
+#define GUMBO_ARENA_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A per-parse memory arena. Every allocation made by the parser goes through
+// gumbo_alloc(), which serves it from the arena of the parse running on the
+// calling thread, if there is one. The arena carves small blocks out of large
+// chunks and recycles freed blocks through per-size free lists, so the nodes
+// that are released during a parse are reused by later nodes. Blocks too
+// large for a free list come from malloc(3) but are still owned by the arena.
+// Destroying the arena releases everything it handed out in one pass over its
+// chunks, without walking the parse tree.
+typedef struct GumboInternalArena GumboArena;
+
+// Creates an empty arena for parsing input_length bytes of input. The length
+// is only used to pick the size of the chunks.
+GumboArena* gumbo_arena_create(size_t input_length);
+
+// Releases the arena and every block allocated from it.
+void gumbo_arena_destroy(GumboArena* arena);
+
+// Returns the arena that gumbo_alloc() uses on the calling thread, or NULL if
+// it uses malloc(3).
+GumboArena* gumbo_arena_current(void);
+
+// Makes gumbo_alloc() use arena on the calling thread, or malloc(3) if arena
+// is NULL, and returns the arena that was in use before.
+GumboArena* gumbo_arena_set_current(GumboArena* arena);
+
+// Allocation functions with the semantics of malloc(3), realloc(3) and
+// free(3). ptr must have been allocated from the same arena. The allocation
+// functions return NULL only if the system allocator does.
+void* gumbo_arena_alloc(GumboArena* arena, size_t size);
+void* gumbo_arena_realloc(GumboArena* arena, void* ptr, size_t size);
+void gumbo_arena_free(GumboArena* arena, void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GUMBO_ARENA_H_
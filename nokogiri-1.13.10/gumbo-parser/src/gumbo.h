@@ -679,6 +679,13 @@ struct GumboInternalNode {
    */
   GumboParseFlags parse_flags;
 
+  /**
+   * Data attached to this node by a `GumboTreeSink`. `NULL` until the
+   * sink's `insert_node` callback sets it, and always `NULL` when no sink
+   * is in use.
+   */
+  void* user_data;
+
   /** The actual node data. */
   union {
     GumboDocument document;  // For GUMBO_NODE_DOCUMENT.
@@ -687,6 +694,56 @@ struct GumboInternalNode {
   } v;
 };
 
+/**
+ * Callbacks for building a tree of the caller's own while the parser runs,
+ * instead of walking the finished `GumboNode` tree afterwards.
+ *
+ * Every change the parser makes to its tree is reported to the sink as it
+ * happens, so the sink's tree always mirrors the parser's. In return, the
+ * parser frees nodes it will never look at again as soon as the sink has
+ * them: text and comment nodes right after they are inserted, and elements
+ * once they have been closed and their parent has been popped off the stack
+ * of open elements. The tree left in `GumboOutput` is then incomplete;
+ * only the document node (including its doctype fields), the root element,
+ * and elements the parser still referenced are guaranteed to remain.
+ *
+ * The sink is ignored when parsing fragments.
+ */
+typedef struct GumboInternalTreeSink {
+  /** Opaque pointer passed to every callback. */
+  void* userdata;
+
+  /**
+   * Called after `node` has been inserted into `node->parent`, in front of
+   * `before`, or as the last child if `before` is `NULL`. The first time a
+   * node is inserted, its `user_data` is `NULL` and the callback should store
+   * its own node there. Adjacent text nodes are never merged by the parser.
+   */
+  void (*insert_node)(void* userdata, GumboNode* node, GumboNode* before);
+
+  /** Called after `node` has been removed from `parent`. */
+  void (*remove_node)(void* userdata, GumboNode* node, GumboNode* parent);
+
+  /**
+   * Called after all of the children of `from` have been moved, in order, to
+   * the element `to`, which had no children.
+   */
+  void (*move_children)(void* userdata, GumboNode* from, GumboNode* to);
+
+  /** Called after `attr` has been appended to the attributes of `node`. */
+  void (*add_attribute) (
+    void* userdata,
+    GumboNode* node,
+    const GumboAttribute* attr
+  );
+
+  /**
+   * Called before `node`, which has been removed from its parent, is
+   * destroyed together with its subtree.
+   */
+  void (*discard_node)(void* userdata, GumboNode* node);
+} GumboTreeSink;
+
 /**
  * Input struct containing configuration options for the parser.
  * These let you specify alternate memory managers, provide different
@@ -779,6 +836,14 @@ typedef struct GumboInternalOptions {
    * Default: `false`.
    */
   bool fragment_context_has_form_ancestor;
+
+  /**
+   * Callbacks for building a separate tree during the parse. See
+   * `GumboTreeSink`. Ignored for fragments.
+   *
+   * Default: `NULL`.
+   */
+  const GumboTreeSink* tree_sink;
 } GumboOptions;
 
 /** Default options struct; use this with gumbo_parse_with_options. */
@@ -852,6 +917,12 @@ typedef struct GumboInternalOutput {
    * stopped mid-document due to exceptional circumstances.
    */
   GumboOutputStatus status;
+
+  /**
+   * The memory arena holding the parse tree, the errors and this struct.
+   * Internal; it is released by `gumbo_destroy_output`.
+   */
+  struct GumboInternalArena* arena;
 } GumboOutput;
 
 /**
@@ -886,7 +957,10 @@ GumboQuirksModeEnum gumbo_compute_quirks_mode (
 /** Convert a `GumboOutputStatus` code into a readable description. */
 const char* gumbo_status_to_string(GumboOutputStatus status);
 
-/** Release the memory used for the parse tree and parse errors. */
+/**
+ * Release the memory used for the parse tree and parse errors. This frees
+ * the parse's arena as a whole; it does not visit the nodes.
+ */
 void gumbo_destroy_output(GumboOutput* output);
 
 /** Opaque GumboError type */
@@ -88,4 +88,12 @@
 
 #define XMALLOC MALLOC RETURNS_NONNULL
 
+#if defined(_MSC_VER)
+    #define THREAD_LOCAL __declspec(thread)
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+    #define THREAD_LOCAL _Thread_local
+#else
+    #define THREAD_LOCAL __thread
+#endif
+
 #endif // ndef MACROS_H
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "arena.h"
 #include "ascii.h"
 #include "attribute.h"
 #include "error.h"
@@ -56,6 +57,7 @@ const GumboOptions kGumboDefaultOptions = {
   .fragment_encoding = NULL,
   .quirks_mode = GUMBO_DOCTYPE_NO_QUIRKS,
   .fragment_context_has_form_ancestor = false,
+  .tree_sink = NULL,
 };
 
 #define STRING(s) {.data = s, .length = sizeof(s) - 1}
@@ -314,6 +316,7 @@ static GumboNode* create_node(GumboNodeType type) {
   node->index_within_parent = -1;
   node->type = type;
   node->parse_flags = GUMBO_INSERTION_NORMAL;
+  node->user_data = NULL;
   return node;
 }
 
@@ -463,6 +466,15 @@ static bool is_fragment_parser(const GumboParser* parser) {
   return !!parser->_parser_state->_fragment_ctx;
 }
 
+// Returns the tree sink to report changes to, or NULL if there is none. The
+// sink is only used for full documents.
+static const GumboTreeSink* get_tree_sink(const GumboParser* parser) {
+  if (is_fragment_parser(parser)) {
+    return NULL;
+  }
+  return parser->_options->tree_sink;
+}
+
 // Returns the node at the bottom of the stack of open elements, or NULL if no
 // elements have been added yet.
 static GumboNode* get_current_node(const GumboParser* parser) {
@@ -874,7 +886,11 @@ static InsertionLocation get_appropriate_insertion_location (
 
 // Appends a node to the end of its parent, setting the "parent" and
 // "index_within_parent" fields appropriately.
-static void append_node(GumboNode* parent, GumboNode* node) {
+static void append_node(
+  GumboParser* parser,
+  GumboNode* parent,
+  GumboNode* node
+) {
   assert(node->parent == NULL);
   assert(node->index_within_parent == (unsigned int) -1);
   GumboVector* children;
@@ -891,12 +907,20 @@ static void append_node(GumboNode* parent, GumboNode* node) {
   node->index_within_parent = children->length;
   gumbo_vector_add((void*) node, children);
   assert(node->index_within_parent < children->length);
+  const GumboTreeSink* sink = get_tree_sink(parser);
+  if (sink) {
+    sink->insert_node(sink->userdata, node, NULL);
+  }
 }
 
 // Inserts a node at the specified InsertionLocation, updating the
 // "parent" and "index_within_parent" fields of it and all its siblings.
 // If the index of the location is -1, this calls append_node.
-static void insert_node(GumboNode* node, InsertionLocation location) {
+static void insert_node(
+  GumboParser* parser,
+  GumboNode* node,
+  InsertionLocation location
+) {
   assert(node->parent == NULL);
   assert(node->index_within_parent == (unsigned int) -1);
   GumboNode* parent = location.target;
@@ -926,11 +950,39 @@ static void insert_node(GumboNode* node, InsertionLocation location) {
       sibling->index_within_parent = i;
       assert(sibling->index_within_parent < children->length);
     }
+    const GumboTreeSink* sink = get_tree_sink(parser);
+    if (sink) {
+      sink->insert_node(sink->userdata, node, children->data[index + 1]);
+    }
   } else {
-    append_node(parent, node);
+    append_node(parser, parent, node);
   }
 }
 
+// Frees a text or comment node that has been handed to the tree sink. The
+// parser never looks at those again once they are inserted, so there is no
+// reason to keep them around.
+static void release_leaf_node(GumboNode* node) {
+  assert(
+    node->type != GUMBO_NODE_ELEMENT
+    && node->type != GUMBO_NODE_TEMPLATE
+  );
+  GumboNode* parent = node->parent;
+  GumboVector* children = (parent->type == GUMBO_NODE_DOCUMENT)
+    ? &parent->v.document.children
+    : &parent->v.element.children
+  ;
+  unsigned int index = node->index_within_parent;
+  assert(index < children->length && children->data[index] == node);
+  gumbo_vector_remove_at(index, children);
+  for (unsigned int i = index; i < children->length; ++i) {
+    GumboNode* sibling = children->data[i];
+    sibling->index_within_parent = i;
+  }
+  node->parent = NULL;
+  destroy_node(node);
+}
+
 static void maybe_flush_text_node_buffer(GumboParser* parser) {
   GumboParserState* state = parser->_parser_state;
   TextNodeBufferState* buffer_state = &state->_text_node;
@@ -964,7 +1016,10 @@ static void maybe_flush_text_node_buffer(GumboParser* parser) {
     // spec, they are dropped on the floor.
     destroy_node(text_node);
   } else {
-    insert_node(text_node, location);
+    insert_node(parser, text_node, location);
+    if (get_tree_sink(parser)) {
+      release_leaf_node(text_node);
+    }
   }
 
   gumbo_string_buffer_clear(&buffer_state->_buffer);
@@ -983,6 +1038,41 @@ static void record_end_of_element (
       : kGumboEmptyString;
 }
 
+static bool is_open_element(const GumboParser* parser, const GumboNode* node);
+
+// Frees the children of a node that has just been popped off the stack of open
+// elements, once the tree sink has them, as long as nothing in the parser can
+// still refer to them: they must be closed, have no children of their own
+// left, and not be in the list of active formatting elements or be the head
+// or form element. Anything else is kept until the end of the parse. Text
+// and comment children were already freed when they were inserted.
+static void release_finished_children(GumboParser* parser, GumboNode* node) {
+  GumboParserState* state = parser->_parser_state;
+  GumboVector* children = &node->v.element.children;
+  unsigned int kept = 0;
+  for (unsigned int i = 0; i < children->length; ++i) {
+    GumboNode* child = children->data[i];
+    assert(
+      child->type == GUMBO_NODE_ELEMENT
+      || child->type == GUMBO_NODE_TEMPLATE
+    );
+    if (
+      child->v.element.children.length == 0
+      && child != state->_head_element
+      && child != state->_form_element
+      && !is_open_element(parser, child)
+      && gumbo_vector_index_of(&state->_active_formatting_elements, child) == -1
+    ) {
+      child->parent = NULL;
+      destroy_node(child);
+      continue;
+    }
+    child->index_within_parent = kept;
+    children->data[kept++] = child;
+  }
+  children->length = kept;
+}
+
 static GumboNode* pop_current_node(GumboParser* parser) {
   GumboParserState* state = parser->_parser_state;
   maybe_flush_text_node_buffer(parser);
@@ -1028,6 +1118,9 @@ static GumboNode* pop_current_node(GumboParser* parser) {
   if (!is_closed_body_or_html_tag) {
     record_end_of_element(state->_current_token, &current_node->v.element);
   }
+  if (get_tree_sink(parser)) {
+    release_finished_children(parser, current_node);
+  }
   return current_node;
 }
 
@@ -1043,7 +1136,10 @@ static void append_comment_node (
   comment->v.text.text = token->v.text;
   comment->v.text.original_text = token->original_text;
   comment->v.text.start_pos = token->position;
-  append_node(node, comment);
+  append_node(parser, node, comment);
+  if (get_tree_sink(parser)) {
+    release_leaf_node(comment);
+  }
 }
 
 // https://html.spec.whatwg.org/multipage/parsing.html#clear-the-stack-back-to-a-table-row-context
@@ -1154,7 +1250,7 @@ static void insert_element (
     maybe_flush_text_node_buffer(parser);
   }
   InsertionLocation location = get_appropriate_insertion_location(parser, NULL);
-  insert_node(node, location);
+  insert_node(parser, node, location);
   gumbo_vector_add((void*) node, &state->_open_elements);
 }
 
@@ -1377,6 +1473,7 @@ static GumboNode* clone_node (
   *new_node = *node;
   new_node->parent = NULL;
   new_node->index_within_parent = -1;
+  new_node->user_data = NULL;
   // Clear the GUMBO_INSERTION_IMPLICIT_END_TAG flag, as the cloned node may
   // have a separate end tag.
   new_node->parse_flags &= ~GUMBO_INSERTION_IMPLICIT_END_TAG;
@@ -1451,7 +1548,7 @@ static void reconstruct_active_formatting_elements(GumboParser* parser) {
     // Step 9.
     InsertionLocation location =
         get_appropriate_insertion_location(parser, NULL);
-    insert_node(clone, location);
+    insert_node(parser, clone, location);
     gumbo_vector_add (
       (void*) clone,
       &parser->_parser_state->_open_elements
@@ -1912,6 +2009,7 @@ static void maybe_implicitly_close_list_tag (
 }
 
 static void merge_attributes (
+  GumboParser* parser,
   GumboToken* token,
   GumboNode* node
 ) {
@@ -1919,6 +2017,7 @@ static void merge_attributes (
   assert(node->type == GUMBO_NODE_ELEMENT);
   const GumboVector* token_attr = &token->v.start_tag.attributes;
   GumboVector* node_attr = &node->v.element.attributes;
+  const GumboTreeSink* sink = get_tree_sink(parser);
 
   for (unsigned int i = 0; i < token_attr->length; ++i) {
     GumboAttribute* attr = token_attr->data[i];
@@ -1928,6 +2027,9 @@ static void merge_attributes (
       // double-deleted.
       gumbo_vector_add(attr, node_attr);
       token_attr->data[i] = NULL;
+      if (sink) {
+        sink->add_attribute(sink->userdata, node, attr);
+      }
     }
   }
   // When attributes are merged, it means the token has been ignored and merged
@@ -2042,7 +2144,7 @@ static void maybe_add_doctype_error (
   }
 }
 
-static void remove_from_parent(GumboNode* node) {
+static void remove_from_parent(GumboParser* parser, GumboNode* node) {
   if (!node->parent) {
     // The node may not have a parent if, for example, it is a newly-cloned copy
     // of an active formatting element. DOM manipulations continue with the
@@ -2051,7 +2153,8 @@ static void remove_from_parent(GumboNode* node) {
     return;
   }
   assert(node->parent->type == GUMBO_NODE_ELEMENT);
-  GumboVector* children = &node->parent->v.element.children;
+  GumboNode* parent = node->parent;
+  GumboVector* children = &parent->v.element.children;
   int index = gumbo_vector_index_of(children, node);
   assert(index != -1);
 
@@ -2062,6 +2165,10 @@ static void remove_from_parent(GumboNode* node) {
     GumboNode* child = children->data[i];
     child->index_within_parent = i;
   }
+  const GumboTreeSink* sink = get_tree_sink(parser);
+  if (sink) {
+    sink->remove_node(sink->userdata, node, parent);
+  }
 }
 
 // This is here to clean up memory when the spec says "Ignore current token."
@@ -2337,8 +2444,8 @@ static void adoption_agency_algorithm(GumboParser* parser, GumboToken* token)
       }
       // Step 14.9.
       last_node->parse_flags |= GUMBO_INSERTION_ADOPTION_AGENCY_MOVED;
-      remove_from_parent(last_node);
-      append_node(node, last_node);
+      remove_from_parent(parser, last_node);
+      append_node(parser, node, last_node);
       // Step 14.10.
       last_node = node;
     }  // Step 14.11.
@@ -2348,7 +2455,7 @@ static void adoption_agency_algorithm(GumboParser* parser, GumboToken* token)
       "Removing %s node from parent ",
       gumbo_normalized_tagname(last_node->v.element.tag)
     );
-    remove_from_parent(last_node);
+    remove_from_parent(parser, last_node);
     last_node->parse_flags |= GUMBO_INSERTION_ADOPTION_AGENCY_MOVED;
     InsertionLocation location = get_appropriate_insertion_location (
       parser,
@@ -2358,7 +2465,7 @@ static void adoption_agency_algorithm(GumboParser* parser, GumboToken* token)
       "and inserting it into %s.\n",
       gumbo_normalized_tagname(location.target->v.element.tag)
     );
-    insert_node(last_node, location);
+    insert_node(parser, last_node, location);
 
     // Step 16.
     GumboNode* new_formatting_node = clone_node (
@@ -2380,9 +2487,13 @@ static void adoption_agency_algorithm(GumboParser* parser, GumboToken* token)
       GumboNode* child = temp.data[i];
       child->parent = new_formatting_node;
     }
+    const GumboTreeSink* sink = get_tree_sink(parser);
+    if (sink) {
+      sink->move_children(sink->userdata, furthest_block, new_formatting_node);
+    }
 
     // Step 18.
-    append_node(furthest_block, new_formatting_node);
+    append_node(parser, furthest_block, new_formatting_node);
 
     // Step 19.
     // If the formatting node was before the bookmark, it may shift over all
@@ -2828,7 +2939,7 @@ static void handle_in_body(GumboParser* parser, GumboToken* token) {
     }
     assert(parser->_output->root != NULL);
     assert(parser->_output->root->type == GUMBO_NODE_ELEMENT);
-    merge_attributes(token, parser->_output->root);
+    merge_attributes(parser, token, parser->_output->root);
     return;
   }
   if (
@@ -2852,7 +2963,7 @@ static void handle_in_body(GumboParser* parser, GumboToken* token) {
       ignore_token(parser);
     } else {
       set_frameset_not_ok(parser);
-      merge_attributes(token, state->_open_elements.data[1]);
+      merge_attributes(parser, token, state->_open_elements.data[1]);
     }
     return;
   }
@@ -2882,14 +2993,11 @@ static void handle_in_body(GumboParser* parser, GumboToken* token) {
     // follows the </frameset>.
     clear_active_formatting_elements(parser);
 
-    // Remove the body node. We may want to factor this out into a generic
-    // helper, but right now this is the only code that needs to do this.
-    GumboVector* children = &parser->_output->root->v.element.children;
-    for (unsigned int i = 0; i < children->length; ++i) {
-      if (children->data[i] == body_node) {
-        gumbo_vector_remove_at(i, children);
-        break;
-      }
+    // Remove the body node.
+    remove_from_parent(parser, body_node);
+    const GumboTreeSink* sink = get_tree_sink(parser);
+    if (sink) {
+      sink->discard_node(sink->userdata, body_node);
     }
     destroy_node(body_node);
 
@@ -4552,6 +4660,46 @@ static void handle_token(GumboParser* parser, GumboToken* token) {
   }
 }
 
+// Called after a character or whitespace token has been handled. When it was
+// simply added to the text node buffer in the "in body" or "text" insertion
+// mode, every plain character that follows it would be handled the same way,
+// so this has the tokenizer hand over the whole run of them at once instead of
+// emitting a token for each.
+static void append_text_run(GumboParser* parser, const GumboToken* token) {
+  GumboParserState* state = parser->_parser_state;
+  TextNodeBufferState* buffer_state = &state->_text_node;
+  if (
+    (token->type != GUMBO_TOKEN_CHARACTER
+     && token->type != GUMBO_TOKEN_WHITESPACE)
+    || state->_reprocess_current_token
+    || (state->_insertion_mode != GUMBO_INSERTION_MODE_IN_BODY
+        && state->_insertion_mode != GUMBO_INSERTION_MODE_TEXT)
+    || buffer_state->_buffer.length == 0
+    || get_adjusted_current_node(parser)->v.element.tag_namespace
+         != GUMBO_NAMESPACE_HTML
+  ) {
+    return;
+  }
+  GumboStringPiece run;
+  if (!gumbo_lex_text_run(parser, &run))
+    return;
+  gumbo_string_buffer_append_string(&run, &buffer_state->_buffer);
+  bool in_body = state->_insertion_mode == GUMBO_INSERTION_MODE_IN_BODY;
+  if (
+    buffer_state->_type == GUMBO_NODE_WHITESPACE
+    || (in_body && state->_frameset_ok)
+  ) {
+    for (size_t i = 0; i < run.length; ++i) {
+      if (run.data[i] != ' ' && run.data[i] != '\n') {
+        buffer_state->_type = GUMBO_NODE_TEXT;
+        if (in_body)
+          set_frameset_not_ok(parser);
+        break;
+      }
+    }
+  }
+}
+
 static GumboNode* create_fragment_ctx_element (
   const char* tag_name,
   GumboNamespaceEnum ns,
@@ -4715,7 +4863,12 @@ GumboOutput* gumbo_parse_with_options (
 ) {
   GumboParser parser;
   parser._options = options;
+  // Everything the parse allocates, including the output, lives in the arena
+  // until gumbo_destroy_output().
+  GumboArena* arena = gumbo_arena_create(length);
+  GumboArena* previous_arena = gumbo_arena_set_current(arena);
   output_init(&parser);
+  parser._output->arena = arena;
   gumbo_tokenizer_state_init(&parser, buffer, length);
   parser_state_init(&parser);
 
@@ -4781,6 +4934,7 @@ GumboOutput* gumbo_parse_with_options (
     state->_self_closing_flag_acknowledged = false;
 
     handle_token(&parser, &token);
+    append_text_run(&parser, &token);
 
     // Check for memory leaks when ownership is transferred from start tag
     // tokens to nodes.
@@ -4843,6 +4997,7 @@ GumboOutput* gumbo_parse_with_options (
 
   parser_state_destroy(&parser);
   gumbo_tokenizer_state_destroy(&parser);
+  gumbo_arena_set_current(previous_arena);
   return parser._output;
 }
 
@@ -4866,10 +5021,6 @@ void gumbo_destroy_node(GumboNode* node) {
 }
 
 void gumbo_destroy_output(GumboOutput* output) {
-  destroy_node(output->document);
-  for (unsigned int i = 0; i < output->errors.length; ++i) {
-    gumbo_error_destroy(output->errors.data[i]);
-  }
-  gumbo_vector_destroy(&output->errors);
-  gumbo_free(output);
+  // The output struct itself is in the arena too.
+  gumbo_arena_destroy(output->arena);
 }
@@ -484,7 +484,6 @@ static StateResult emit_current_tag(GumboParser* parser, GumboToken* output) {
     gumbo_debug(
         "Emitted end tag %s.\n", gumbo_normalized_tagname(tag_state->_tag));
   }
-  gumbo_string_buffer_destroy(&tag_state->_buffer);
   finish_token(parser, output);
   gumbo_debug (
     "Original text = %.*s.\n",
@@ -508,7 +507,6 @@ static void abandon_current_tag(GumboParser* parser) {
   }
   gumbo_free(tag_state->_attributes.data);
   mark_tag_state_as_empty(tag_state);
-  gumbo_string_buffer_destroy(&tag_state->_buffer);
   gumbo_debug("Abandoning current tag.\n");
 }
 
@@ -597,13 +595,35 @@ static void append_string_to_tag_buffer (
   gumbo_string_buffer_append_string(str, buffer);
 }
 
+// Appends the current character of a quoted attribute value to the tag buffer,
+// along with the rest of the run of plain text that follows it. The character
+// after the run is left to be consumed in the same state.
+static void append_value_run_to_tag_buffer (
+  GumboParser* parser,
+  int c,
+  char quote
+) {
+  GumboTokenizerState* tokenizer = parser->_tokenizer_state;
+  GumboStringPiece run;
+  run.data = utf8iterator_get_char_pointer(&tokenizer->_input);
+  run.length = utf8iterator_skip_ascii_run(&tokenizer->_input, quote, '&');
+  if (run.length == 0) {
+    append_char_to_tag_buffer(parser, c, false);
+    return;
+  }
+  append_string_to_tag_buffer(parser, &run, false);
+  tokenizer->_reconsume_current_input = true;
+}
+
 // (Re-)initialize the tag buffer. This also resets the original_text pointer
-// and _start_pos field to point to the current position.
+// and _start_pos field to point to the current position. The buffer itself is
+// kept for the whole parse, so after the first few tags it is big enough for
+// the names and values in the document and never needs to grow again.
 static void initialize_tag_buffer(GumboParser* parser) {
   GumboTokenizerState* tokenizer = parser->_tokenizer_state;
   GumboTagState* tag_state = &tokenizer->_tag_state;
 
-  gumbo_string_buffer_init(&tag_state->_buffer);
+  gumbo_string_buffer_clear(&tag_state->_buffer);
   reset_tag_buffer_start_point(parser);
 }
 
@@ -736,9 +756,8 @@ static void copy_over_original_tag_text (
   utf8iterator_get_position(&tokenizer->_input, end_pos);
 }
 
-// Releases and then re-initializes the tag buffer.
+// Clears the tag buffer for the next name or value.
 static void reinitialize_tag_buffer(GumboParser* parser) {
-  gumbo_free(parser->_tokenizer_state->_tag_state._buffer.data);
   initialize_tag_buffer(parser);
 }
 
@@ -883,6 +902,7 @@ void gumbo_tokenizer_state_init (
   tokenizer->_is_in_cdata = false;
   tokenizer->_tag_state._last_start_tag = GUMBO_TAG_LAST;
   tokenizer->_tag_state._name = NULL;
+  gumbo_string_buffer_init(&tokenizer->_tag_state._buffer);
 
   tokenizer->_buffered_emit_char = kGumboNoChar;
   gumbo_string_buffer_init(&tokenizer->_temporary_buffer);
@@ -902,6 +922,7 @@ void gumbo_tokenizer_state_destroy(GumboParser* parser) {
   assert(tokenizer->_doc_type_state.public_identifier == NULL);
   assert(tokenizer->_doc_type_state.system_identifier == NULL);
   gumbo_string_buffer_destroy(&tokenizer->_temporary_buffer);
+  gumbo_string_buffer_destroy(&tokenizer->_tag_state._buffer);
   assert(tokenizer->_tag_state._name == NULL);
   assert(tokenizer->_tag_state._attributes.data == NULL);
   gumbo_free(tokenizer);
@@ -1883,7 +1904,7 @@ static StateResult handle_attr_value_double_quoted_state (
       abandon_current_tag(parser);
       return emit_eof(parser, output);
     default:
-      append_char_to_tag_buffer(parser, c, false);
+      append_value_run_to_tag_buffer(parser, c, '"');
       return CONTINUE;
   }
 }
@@ -1913,7 +1934,7 @@ static StateResult handle_attr_value_single_quoted_state (
       abandon_current_tag(parser);
       return emit_eof(parser, output);
     default:
-      append_char_to_tag_buffer(parser, c, false);
+      append_value_run_to_tag_buffer(parser, c, '\'');
       return CONTINUE;
   }
 }
@@ -3425,6 +3446,37 @@ void gumbo_lex(GumboParser* parser, GumboToken* output) {
   }
 }
 
+bool gumbo_lex_text_run(GumboParser* parser, GumboStringPiece* output) {
+  GumboTokenizerState* tokenizer = parser->_tokenizer_state;
+  char stop;
+  switch (tokenizer->_state) {
+    case GUMBO_LEX_DATA:
+    case GUMBO_LEX_RCDATA:
+      stop = '&';
+      break;
+    case GUMBO_LEX_RAWTEXT:
+    case GUMBO_LEX_SCRIPT_DATA:
+      stop = '<';
+      break;
+    default:
+      return false;
+  }
+  if (
+    tokenizer->_buffered_emit_char != kGumboNoChar
+    || tokenizer->_resume_pos
+    || tokenizer->_reconsume_current_input
+  ) {
+    return false;
+  }
+  output->data = utf8iterator_get_char_pointer(&tokenizer->_input);
+  output->length = utf8iterator_skip_ascii_run(&tokenizer->_input, '<', stop);
+  if (output->length == 0)
+    return false;
+  reset_token_start_point(tokenizer);
+  gumbo_debug("Lexed text run %.*s.\n", (int) output->length, output->data);
+  return true;
+}
+
 void gumbo_token_destroy(GumboToken* token) {
   if (!token) return;
 
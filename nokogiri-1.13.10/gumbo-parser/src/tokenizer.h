@@ -96,6 +96,14 @@ void gumbo_tokenizer_set_is_adjusted_current_node_foreign (
 // parsed GumboToken data structure.
 void gumbo_lex(struct GumboInternalParser* parser, GumboToken* output);
 
+// Consumes the run of plain ASCII text at the current input position that
+// would otherwise be lexed as one character or whitespace token per
+// character, and points output at it. This is only done in the data, RCDATA,
+// RAWTEXT and script data states, between tokens; the parser uses it when it
+// knows it would just append each of those characters to the current text
+// node. Returns false, consuming nothing, if there is no such run.
+bool gumbo_lex_text_run(struct GumboInternalParser* parser, GumboStringPiece* output);
+
 // Frees the internally-allocated pointers within a GumboToken. Note that this
 // doesn't free the token itself, since oftentimes it will be allocated on the
 // stack.
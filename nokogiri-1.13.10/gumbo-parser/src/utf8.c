@@ -21,6 +21,11 @@
 #include <stdint.h>
 #include <string.h>
 
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define HAVE_SSE2_RUN_SCAN 1
+#endif
+
 #include "error.h"
 #include "gumbo.h"
 #include "parser.h"
@@ -208,6 +213,85 @@ void utf8iterator_next(Utf8Iterator* iter) {
   read_char(iter);
 }
 
+// Returns true if c is a byte that read_char() decodes to itself without an
+// error and that update_position() advances over in the simplest way: a
+// printable ASCII character or a line feed. Carriage returns and tabs are left
+// to the decoder.
+static inline bool is_plain_ascii(unsigned char c, char stop1, char stop2) {
+  return
+    ((c >= 0x20 && c < 0x7F) || c == '\n')
+    && c != (unsigned char) stop1
+    && c != (unsigned char) stop2;
+}
+
+// Returns the length of the run of plain ASCII bytes at the start of text,
+// stopping at stop1, stop2 or end.
+static size_t plain_ascii_run_length (
+  const char* text,
+  const char* end,
+  char stop1,
+  char stop2
+) {
+  const char* c = text;
+#ifdef HAVE_SSE2_RUN_SCAN
+  // Check 16 bytes at a time. A signed comparison against 0x20 picks out both
+  // the control characters and every byte of a multi-byte sequence.
+  const __m128i space = _mm_set1_epi8(0x20);
+  const __m128i del = _mm_set1_epi8(0x7F);
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i s1 = _mm_set1_epi8(stop1);
+  const __m128i s2 = _mm_set1_epi8(stop2);
+  while (end - c >= 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*) c);
+    __m128i special = _mm_or_si128 (
+      _mm_andnot_si128 (
+        _mm_cmpeq_epi8(bytes, newline),
+        _mm_cmplt_epi8(bytes, space)
+      ),
+      _mm_or_si128 (
+        _mm_cmpeq_epi8(bytes, del),
+        _mm_or_si128(_mm_cmpeq_epi8(bytes, s1), _mm_cmpeq_epi8(bytes, s2))
+      )
+    );
+    int mask = _mm_movemask_epi8(special);
+    if (mask)
+      return c - text + __builtin_ctz(mask);
+    c += 16;
+  }
+#endif
+  while (c < end && is_plain_ascii(*c, stop1, stop2))
+    ++c;
+  return c - text;
+}
+
+size_t utf8iterator_skip_ascii_run(Utf8Iterator* iter, char stop1, char stop2) {
+  const char* start = iter->_start;
+  if (
+    iter->_width != 1
+    || !is_plain_ascii(*start, stop1, stop2)
+  ) {
+    return 0;
+  }
+  size_t length = plain_ascii_run_length(start, iter->_end, stop1, stop2);
+
+  // Apply what update_position() would have done for each character.
+  const char* end = start + length;
+  const char* last_newline = NULL;
+  for (const char* c = start; (c = memchr(c, '\n', end - c)); ++c) {
+    ++iter->_pos.line;
+    last_newline = c;
+  }
+  if (last_newline)
+    iter->_pos.column = 1 + (end - last_newline - 1);
+  else
+    iter->_pos.column += length;
+  iter->_pos.offset += length;
+
+  iter->_start = end;
+  read_char(iter);
+  return length;
+}
+
 bool utf8iterator_maybe_consume_match (
   Utf8Iterator* iter,
   const char* prefix,
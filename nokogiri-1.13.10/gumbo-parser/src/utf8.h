@@ -135,6 +135,15 @@ static inline const char* utf8iterator_get_mark_pointer(const Utf8Iterator* iter
   return iter->_mark;
 }
 
+// Advances past the run of printable ASCII characters and line feeds that
+// starts at the current code point, stopping before stop1 or stop2, and
+// returns its length in bytes (0 if the current code point doesn't qualify).
+// The skipped text starts at the char pointer from before the call. These
+// characters decode to themselves and are never parse errors, so this finds
+// the end of the run a block of bytes at a time instead of decoding it; the
+// source position is updated exactly as if each character had been read.
+size_t utf8iterator_skip_ascii_run(Utf8Iterator* iter, char stop1, char stop2);
+
 // If the upcoming text in the buffer matches the specified prefix (which has
 // length 'length'), consume it and return true. Otherwise, return false with
 // no other effects. If the length of the string would overflow the buffer,
@@ -19,10 +19,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include "util.h"
+#include "arena.h"
 #include "gumbo.h"
 
+// During a parse, memory comes from the parse's arena (see arena.h).
+// Allocations made outside of a parse, such as the message returned by
+// gumbo_caret_diagnostic_to_string(), come from malloc(3) so that callers can
+// free(3) them.
+
 void* gumbo_alloc(size_t size) {
-  void* ptr = malloc(size);
+  GumboArena* arena = gumbo_arena_current();
+  void* ptr = arena ? gumbo_arena_alloc(arena, size) : malloc(size);
   if (unlikely(ptr == NULL)) {
     perror(__func__);
     abort();
@@ -31,7 +38,8 @@ void* gumbo_alloc(size_t size) {
 }
 
 void* gumbo_realloc(void* ptr, size_t size) {
-  ptr = realloc(ptr, size);
+  GumboArena* arena = gumbo_arena_current();
+  ptr = arena ? gumbo_arena_realloc(arena, ptr, size) : realloc(ptr, size);
   if (unlikely(ptr == NULL)) {
     perror(__func__);
     abort();
@@ -40,7 +48,11 @@ void* gumbo_realloc(void* ptr, size_t size) {
 }
 
 void gumbo_free(void* ptr) {
-  free(ptr);
+  GumboArena* arena = gumbo_arena_current();
+  if (arena)
+    gumbo_arena_free(arena, ptr);
+  else
+    free(ptr);
 }
 
 char* gumbo_strdup(const char* str) {
@@ -7,6 +7,9 @@ module Nokogiri
     class Parser < Racc::Parser # :nodoc:
       CACHE_SWITCH_NAME = :nokogiri_css_parser_cache_is_off
 
+      # The number of translations kept in the cache. The oldest one is dropped when it is full.
+      CACHE_SIZE = 1024
+
       @cache = {}
       @mutex = Mutex.new
 
@@ -32,11 +35,15 @@ module Nokogiri
         def []=(string, value)
           return value unless cache_on?
 
-          @mutex.synchronize { @cache[string] = value }
+          @mutex.synchronize do
+            @cache.shift if @cache.size >= CACHE_SIZE
+            @cache[string] = value
+          end
         end
 
         # Clear the cache
         def clear_cache(create_new_object = false)
+          XPathVisitor.clear_native_cache if Nokogiri.uses_libxml?
           @mutex.synchronize do
             if create_new_object
               @cache = {}
@@ -74,6 +81,12 @@ module Nokogiri
 
       # Get the xpath for +string+ using +options+
       def xpath_for(string, prefix, visitor)
+        if Nokogiri.uses_libxml? && visitor.instance_of?(XPathVisitor)
+          # common selectors are translated without building an AST, and cached without locking
+          xpaths = visitor.native_xpath_for(string, prefix, @namespaces&.key?("xmlns"), self.class.cache_on?)
+          return xpaths if xpaths
+        end
+
         key = cache_key(string, prefix, visitor)
         self.class[key] ||= parse(string).map do |ast|
           ast.to_xpath(prefix, visitor)
@@ -60,7 +60,11 @@ module Nokogiri
           internal_ops = {
             preserve_newline: options[:preserve_newline] || false,
           }
-          HTML5.serialize_node_internal(self, io, encoding, internal_ops)
+          if (Encoding.find(encoding) rescue nil) == Encoding::UTF_8 && !(text? && parent.nil?)
+            HTML5.serialize_node_native(self, io, internal_ops[:preserve_newline])
+          else
+            HTML5.serialize_node_internal(self, io, encoding, internal_ops)
+          end
         end
       end
 
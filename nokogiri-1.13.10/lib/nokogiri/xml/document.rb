@@ -405,6 +405,14 @@ module Nokogiri
         Nokogiri::CSS::XPathVisitor::DoctypeConfig::XML
       end
 
+      if Nokogiri.jruby?
+        attr_writer :weak_node_cache # :nodoc:
+
+        def weak_node_cache? # :nodoc:
+          !!@weak_node_cache
+        end
+      end
+
       private
 
       def self.empty_doc?(string_or_io)
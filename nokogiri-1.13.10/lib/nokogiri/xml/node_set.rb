@@ -297,6 +297,24 @@ module Nokogiri
         map { |x| x.to_xml(*args) }.join
       end
 
+      if Nokogiri.jruby?
+        def texts # :nodoc:
+          map(&:text)
+        end
+
+        def attribute_values(name) # :nodoc:
+          map { |node| node[name] }
+        end
+
+        def to_strings(kind) # :nodoc:
+          case kind
+          when :outer_html then map(&:to_html)
+          when :inner_html then map(&:inner_html)
+          else raise ArgumentError, "expected :outer_html or :inner_html, got #{kind.inspect}"
+          end
+        end
+      end
+
       alias_method :size, :length
       alias_method :to_ary, :to_a
 
@@ -100,6 +100,37 @@ module Nokogiri
           yield cursor
         end
       end
+
+      # :call-seq:
+      #   each_element(pattern, namespaces = {}) { |element| ... }
+      #   each_element(pattern, namespaces = {}) → Enumerator
+      #
+      # Move the cursor through the rest of the document, yielding each element that matches
+      # +pattern+ as a Nokogiri::XML::Element, with all of its children, that is the root of a new
+      # Document of its own. Elements inside a match are not matched again.
+      #
+      # Everything outside the matches is skipped without creating Ruby objects, and only one match
+      # is held in memory at a time, so this is the fast way to pick records out of a large file.
+      #
+      # If the block breaks out, the next call to #each_element carries on with the node after the
+      # last match. Calling #read in between moves on from there instead.
+      #
+      # [Parameters]
+      # - +pattern+ (String) The qualified name of the elements to yield, like +"record"+ or
+      #   +"atom:entry"+, or a path pattern like +"/feed/atom:entry"+ or +"//item"+.
+      # - +namespaces+ (Hash<String ⇒ String>) Prefixes and namespace URIs for the prefixes used
+      #   in a path pattern. A qualified name is compared with the element's name as written.
+      #
+      #   reader = Nokogiri::XML::Reader(File.open("feed.xml"))
+      #   reader.each_element("record") do |record|
+      #     puts record.at_xpath("title").text
+      #   end
+      def each_element(pattern, namespaces = {}, &block)
+        return to_enum(:each_element, pattern, namespaces) unless block
+
+        namespace_list = namespaces.flat_map { |prefix, href| [href.to_s, prefix.to_s.sub(/\Axmlns:/, "")] }
+        native_each_element(pattern.to_s, namespace_list, &block)
+      end
     end
   end
 end
@@ -222,7 +222,7 @@ module Nokogiri
       end
 
       def xpath_impl(node, path, handler, ns, binds)
-        ctx = XPathContext.new(node)
+        ctx = XPathContext.acquire(node)
         ctx.register_namespaces(ns)
         path = path.gsub(/xmlns:/, " :") unless Nokogiri.uses_libxml?
 
@@ -230,7 +230,9 @@ module Nokogiri
           ctx.register_variable(key.to_s, value)
         end
 
-        ctx.evaluate(path, handler)
+        result = ctx.evaluate(path, handler)
+        ctx.release
+        result
       end
 
       def css_rules_to_xpath(rules, ns)
@@ -11,6 +11,17 @@ module Nokogiri
           register_ns(k, v)
         end
       end
+
+      if Nokogiri.jruby?
+        # The JRuby implementation doesn't keep a context per document, so searches build their
+        # own.
+        def self.acquire(node) # :nodoc:
+          new(node)
+        end
+
+        def release # :nodoc:
+        end
+      end
     end
   end
 end